@@ -0,0 +1,211 @@
+/**
+ * Informe de reservas de heap por llamada del ThermalCameraController
+ *
+ * Este ejemplo llama varias veces a cada método público de
+ * CameraController y MenuSystem, contando las reservas de heap de cada
+ * llamada con el hook de CameraAlloc. El resultado se
+ * imprime en CSV para compararlo entre versiones.
+ *
+ * Sin cámara conectada los comandos de lectura terminan por timeout; las
+ * reservas se siguen midiendo (las rutas de error también cuentan).
+ *
+ * build_flags =
+ *     -D CAMERA_TRACK_ALLOCATIONS=1
+ *     -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc -Wl,--wrap=free
+ *
+ * Conexiones:
+ * - ESP32 GPIO16 -> Camera RX
+ * - ESP32 GPIO17 -> Camera TX
+ * - Camera Power: 5V-16V
+ * - Camera GND -> ESP32 GND
+ */
+
+#include <Arduino.h>
+#include <CameraController.h>
+#include <CameraAlloc.h>
+#include <MenuSystem.h>
+
+#if !CAMERA_TRACK_ALLOCATIONS
+#error "Compilar con -D CAMERA_TRACK_ALLOCATIONS=1 y los -Wl,--wrap de build_flags"
+#endif
+
+// Configuración de pines
+#define RX_PIN 16
+#define TX_PIN 17
+#define REPEAT 3
+
+// Mide una expresión; su texto es el nombre de la fila del informe
+#define MEASURE(...) report.measure(#__VA_ARGS__, [&]() { __VA_ARGS__; })
+
+// Crear instancias
+HardwareSerial cameraSerial(2);
+CameraController camera(&cameraSerial, RX_PIN, TX_PIN);
+MenuSystem menu(&camera);
+CameraAllocReport report;
+
+void handleText(const char* interpretation) {
+    (void)interpretation;
+}
+
+#if !CAMERA_STATIC_ALLOCATION
+void handleString(const String& interpretation) {
+    (void)interpretation;
+}
+#endif
+
+void measureController() {
+    CameraInfo info;
+    CameraInfoPacked packed;
+    char model[CAMERA_MODEL_SIZE];
+    uint8_t raw[] = {0xF0, 0x05, 0x36, 0x78, 0x02, 0x01, 0xB1, 0xFF};
+    uint8_t value[] = {50};
+
+    // Configuración
+    MEASURE(camera.enableDebug(false));
+    MEASURE(camera.setTimeouts(20, 5));
+    MEASURE(camera.update());
+    MEASURE(camera.flushLog(Serial, 4));
+    MEASURE(camera.getLogPending());
+    MEASURE(CameraController::setGlobalResponseTextHandler(handleText));
+#if !CAMERA_STATIC_ALLOCATION
+    MEASURE(CameraController::setGlobalResponseHandler(handleString));
+#endif
+
+    // Información
+    MEASURE(camera.getDeviceInfo(info));
+    MEASURE(camera.getDeviceInfo(packed));
+    MEASURE(camera.getModel(model, sizeof(model)));
+#if !CAMERA_STATIC_ALLOCATION
+    MEASURE(camera.getModel());
+    MEASURE(camera.getFPGAVersion());
+    MEASURE(camera.getFPGABuildDate());
+    MEASURE(camera.getSoftwareVersion());
+    MEASURE(camera.getSoftwareBuildDate());
+    MEASURE(camera.getCalibrationVersion());
+    MEASURE(camera.getISPVersion());
+#endif
+    MEASURE(camera.getStatus());
+    MEASURE(camera.readDeviceModel());
+    MEASURE(camera.readFPGA_Version());
+    MEASURE(camera.readInitializationStatus());
+    MEASURE(camera.isConnected());
+
+    // Imagen
+    MEASURE(camera.setBrightness(75));
+    MEASURE(camera.setBrightness(150));
+    MEASURE(camera.setContrast(60));
+    MEASURE(camera.setDigitalEnhancement(40));
+    MEASURE(camera.setStaticNoiseReduction(30));
+    MEASURE(camera.setDynamicNoiseReduction(30));
+    MEASURE(camera.setPalette(PALETTE_IRON));
+    MEASURE(camera.setMirror(MIRROR_HORIZONTAL));
+    MEASURE(camera.getBrightness());
+    MEASURE(camera.getContrast());
+    MEASURE(camera.getDigitalEnhancement());
+    MEASURE(camera.getStaticNoiseReduction());
+    MEASURE(camera.getDynamicNoiseReduction());
+    MEASURE(camera.getCurrentPalette());
+    MEASURE(camera.getCurrentMirror());
+
+    // Cámara
+    MEASURE(camera.setAutoShutter(SHUTTER_AUTO));
+    MEASURE(camera.setShutterInterval(5));
+    MEASURE(camera.getAutoShutterMode());
+    MEASURE(camera.getShutterInterval());
+    MEASURE(camera.performManualFFC());
+    MEASURE(camera.performBackgroundCorrection());
+    MEASURE(camera.performVignettingCorrection());
+
+    // Cursor
+    MEASURE(camera.showCursor());
+    MEASURE(camera.hideCursor());
+    MEASURE(camera.centerCursor());
+    MEASURE(camera.moveCursorUp(1));
+    MEASURE(camera.moveCursorDown(1));
+    MEASURE(camera.moveCursorLeft(1));
+    MEASURE(camera.moveCursorRight(1));
+    MEASURE(camera.addDeadPixel());
+    MEASURE(camera.removeDeadPixel());
+
+    // Comandos directos
+    MEASURE(camera.sendDynamicCommand(CLASS_IMAGE, 0x02, FLAG_WRITE, value, 1));
+    MEASURE(camera.sendRawCommand(raw, sizeof(raw)));
+    MEASURE(camera.testBuildAndSendCommand(CLASS_IMAGE, 0x02, FLAG_READ, nullptr, 0));
+
+    // Errores y diagnóstico
+    MEASURE(camera.getLastErrorCode());
+    MEASURE(camera.getLastErrorText());
+    MEASURE(camera.getLastCommandStatus());
+    MEASURE(camera.getErrorCount(CAMERA_ERR_TIMEOUT));
+    MEASURE(camera.resetErrorCounts());
+#if !CAMERA_STATIC_ALLOCATION
+    MEASURE(camera.getLastError());
+#endif
+    MEASURE(camera.getLinkScore());
+    MEASURE(camera.getLinkQuality());
+    MEASURE(camera.setLinkQualityCallback(nullptr, 80));
+    MEASURE(camera.resetLinkQuality());
+#if CAMERA_ENABLE_STATS
+    MEASURE(camera.getStats());
+    MEASURE(camera.resetStats());
+#endif
+#if CAMERA_ENABLE_CAPTURE
+    MEASURE(camera.enableCapture(true, true));
+    MEASURE(camera.getCapture());
+    MEASURE(camera.dumpCapture(Serial));
+    MEASURE(camera.resetCapture());
+#endif
+#if CAMERA_ENABLE_PROFILER
+    MEASURE(camera.getProfiler());
+    MEASURE(camera.setLoopBudget(20000, nullptr));
+#endif
+
+    // Sistema (sin restoreFactory/saveConfiguration: alteran la cámara)
+}
+
+#if CAMERA_ENABLE_MENU
+void measureMenu() {
+    MEASURE(menu.begin());
+    MEASURE(menu.update());
+    MEASURE(menu.getCurrentMenu());
+    MEASURE(menu.returnToMainMenu());
+    for (char choice = '1'; choice <= '7'; choice++) {
+        String input(choice);
+        MEASURE(menu.processInput(input));
+        MEASURE(menu.processInput("M"));
+    }
+    MEASURE(menu.processInput("2"));
+    MEASURE(menu.processInput("1"));
+    MEASURE(menu.processInput("80"));
+    MEASURE(menu.processInput("X"));
+}
+#endif
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    Serial.println("=== Thermal Camera Controller - Allocation Report ===");
+
+    CameraAllocSnapshot start = cameraAllocSnapshot();
+    MEASURE(camera.begin());
+
+    for (int i = 0; i < REPEAT; i++) {
+        measureController();
+#if CAMERA_ENABLE_MENU
+        measureMenu();
+#endif
+    }
+
+    CameraAllocSnapshot end = cameraAllocSnapshot();
+    Serial.println();
+    report.printCsv(Serial);
+    Serial.printf("# total allocs=%lu frees=%lu bytes=%lu, calls allocating=%u/%u\n",
+                  (unsigned long)(end.allocs - start.allocs), (unsigned long)(end.frees - start.frees),
+                  (unsigned long)(end.bytes - start.bytes), (unsigned)report.allocatingCalls(),
+                  (unsigned)report.size());
+}
+
+void loop() {
+    camera.update();
+}
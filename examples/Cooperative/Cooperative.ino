@@ -0,0 +1,127 @@
+/**
+ * Ejemplo del modo cooperativo para placas de un solo núcleo (ESP32-C3)
+ *
+ * En este ejemplo no hay tarea de E/S; el loop de
+ * Arduino llama a cameraIo.pollIo() en cada vuelta y este avanza el envío,
+ * la lectura de la respuesta, los timeouts y la entrega de resultados sin
+ * esperar nunca a la cámara. Se usa la misma carga que en el ejemplo de
+ * doble núcleo (lecturas de fondo cada READ_MS, cambio de paleta urgente
+ * cada WRITE_MS, FFC desde la interrupción del botón BOOT, GPIO9) para
+ * comparar la tasa de comandos. Cada REPORT_MS imprime las estadísticas,
+ * la vuelta más larga del loop y la llamada más larga a pollIo(), que debe
+ * quedarse cerca de CAMERA_POLL_BUDGET_US y lejos de la espera de
+ * respuesta de la cámara (hasta 150 ms).
+ *
+ * Para compilar y ejecutar: pio run -e coop_example -t upload -t monitor
+ *
+ * Conexiones:
+ * - ESP32-C3 GPIO4 -> Camera RX
+ * - ESP32-C3 GPIO5 -> Camera TX
+ * - Camera Power: 5V-16V
+ * - Camera GND -> ESP32-C3 GND
+ */
+
+#include <Arduino.h>
+#include <CameraController.h>
+#include <CameraTask.h>
+
+// Configuración de pines (UART1 del C3 en pines libres)
+#define RX_PIN 4
+#define TX_PIN 5
+#define BUTTON_PIN 9
+
+// Periodos de lectura, escritura e informe
+#define READ_MS 100
+#define WRITE_MS 2000
+#define REPORT_MS 5000
+
+// Crear instancias
+HardwareSerial cameraSerial(1);
+CameraController camera(&cameraSerial, RX_PIN, TX_PIN);
+CameraTask cameraIo(camera);
+
+uint32_t lastRead = 0;
+uint32_t lastWrite = 0;
+uint32_t lastReport = 0;
+uint32_t loopMaxUs = 0;
+uint32_t completed = 0;
+uint32_t errors = 0;
+uint8_t brightness = 0;
+uint8_t palette = PALETTE_WHITE_HOT;
+
+// FFC preparado en setup(): la ISR solo lo encola
+CameraRequest ffcRequest;
+volatile uint32_t lastButtonMs = 0;
+
+void IRAM_ATTR onButton() {
+    uint32_t now = millis();
+    if (now - lastButtonMs < 200) {
+        return; // rebote
+    }
+    lastButtonMs = now;
+    cameraIo.postFromISR(ffcRequest);
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println("=== Thermal Camera Controller - Modo cooperativo ===");
+
+    if (!camera.begin()) {
+        Serial.println("❌ Error al inicializar la cámara");
+        return;
+    }
+    cameraIo.beginCooperative();
+    Serial.printf("Sin tarea de E/S: pollIo() desde el loop, presupuesto %u us\n", CAMERA_POLL_BUDGET_US);
+    ffcRequest = CameraTask::prepare(CLASS_CAMERA, 0x02, FLAG_WRITE);
+    pinMode(BUTTON_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(BUTTON_PIN), onButton, FALLING);
+}
+
+void loop() {
+    uint32_t start = micros();
+    uint32_t now = millis();
+
+    if (now - lastRead >= READ_MS) {
+        lastRead = now;
+        cameraIo.postRead(CLASS_IMAGE, 0x02, CAMERA_PRIORITY_BACKGROUND);   // brillo
+    }
+    if (now - lastWrite >= WRITE_MS) {
+        lastWrite = now;
+        palette = (palette + 1) % (PALETTE_COLOR7 + 1);
+        cameraIo.postWrite(CLASS_IMAGE, 0x20, &palette, 1, CAMERA_PRIORITY_URGENT);
+    }
+
+    cameraIo.pollIo();
+
+    CameraEvent event;
+    while (cameraIo.poll(event)) {
+        if (event.code == CAMERA_ERR_ABORTED) {
+            continue; // lectura de fondo cedida a un comando urgente
+        }
+        completed++;
+        if (event.code != CAMERA_OK) {
+            errors++;
+        } else if (event.fromIsr) {
+            Serial.printf("FFC por botón: %lu us desde la interrupción hasta la TX\n",
+                          (unsigned long)(event.startUs - event.postedUs));
+        } else if (event.rw == FLAG_READ && event.length) {
+            brightness = event.data[0];
+        }
+    }
+
+    uint32_t elapsed = micros() - start;
+    if (elapsed > loopMaxUs) {
+        loopMaxUs = elapsed;
+    }
+
+    if (now - lastReport >= REPORT_MS) {
+        lastReport = now;
+        Serial.printf("\nBrillo %u, paleta %u, %lu comandos/s, %lu errores, vuelta máx del loop %lu us\n",
+                      brightness, palette, (unsigned long)(completed * 1000UL / REPORT_MS),
+                      (unsigned long)errors, (unsigned long)loopMaxUs);
+        cameraIo.printStats(Serial);
+        cameraIo.resetStats();
+        completed = 0;
+        loopMaxUs = 0;
+    }
+}
@@ -0,0 +1,145 @@
+/**
+ * Ejemplo de la tarea de E/S en doble núcleo (CameraTask)
+ *
+ * En este ejemplo el controlador corre en su propia tarea
+ * FreeRTOS fijada al núcleo 0 y el loop de Arduino (núcleo 1) solo envía
+ * comandos y recoge resultados a través de colas sin bloqueos. Cada
+ * REPORT_MS imprime profundidad de colas, latencias (espera en cola,
+ * servicio, entrega) y la vuelta más larga del loop, que no debe acercarse
+ * a la espera de respuesta de la cámara (hasta 150 ms). Una segunda tarea
+ * (telemetría) consulta la cámara a la vez con read(), que bloquea solo a
+ * esa tarea. El botón BOOT (GPIO0) lanza un FFC desde su interrupción sin
+ * pasar por el loop. Las lecturas periódicas van como fondo y los cambios
+ * de paleta y el FFC como urgentes: el planificador los adelanta y, si hace
+ * falta, abandona la espera de una lectura de fondo.
+ *
+ * Para compilar y ejecutar: pio run -e task_example -t upload -t monitor
+ *
+ * Conexiones:
+ * - ESP32 GPIO16 -> Camera RX
+ * - ESP32 GPIO17 -> Camera TX
+ * - Camera Power: 5V-16V
+ * - Camera GND -> ESP32 GND
+ */
+
+#include <Arduino.h>
+#include <CameraController.h>
+#include <CameraTask.h>
+
+// Configuración de pines
+#define RX_PIN 16
+#define TX_PIN 17
+#define BUTTON_PIN 0
+
+// Periodos de lectura, escritura e informe
+#define READ_MS 100
+#define WRITE_MS 2000
+#define REPORT_MS 5000
+
+// Crear instancias
+HardwareSerial cameraSerial(2);
+CameraController camera(&cameraSerial, RX_PIN, TX_PIN);
+CameraTask cameraIo(camera);
+
+uint32_t lastRead = 0;
+uint32_t lastWrite = 0;
+uint32_t lastReport = 0;
+uint32_t loopMaxUs = 0;
+uint32_t errors = 0;
+uint8_t brightness = 0;
+uint8_t palette = PALETTE_WHITE_HOT;
+
+// FFC preparado en setup(): la ISR solo lo encola
+CameraRequest ffcRequest;
+volatile uint32_t lastButtonMs = 0;
+
+void IRAM_ATTR onButton() {
+    uint32_t now = millis();
+    if (now - lastButtonMs < 200) {
+        return; // rebote
+    }
+    lastButtonMs = now;
+    cameraIo.postFromISR(ffcRequest);
+}
+
+/**
+ * Tarea de telemetría: lecturas bloqueantes con su propia ranura de resultado.
+ */
+void telemetryTask(void*) {
+    for (;;) {
+        CameraEvent result;
+        uint32_t start = micros();
+        CameraErrorCode code = cameraIo.read(CLASS_IMAGE, 0x03, result, CAMERA_PRIORITY_BACKGROUND);
+        uint32_t elapsed = micros() - start;
+        if (code == CAMERA_OK) {
+            Serial.printf("[telemetría] contraste %u en %lu us\n", result.data[0], (unsigned long)elapsed);
+        } else {
+            Serial.printf("[telemetría] error: %s\n", cameraErrorText(code));
+        }
+        delay(1000);
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println("=== Thermal Camera Controller - Tarea de E/S ===");
+
+    if (!camera.begin()) {
+        Serial.println("❌ Error al inicializar la cámara");
+        return;
+    }
+    if (!cameraIo.begin()) {
+        Serial.println("❌ No se pudo crear la tarea de E/S");
+        return;
+    }
+    Serial.printf("Tarea de E/S en el núcleo %d, loop en el núcleo %d\n", CAMERA_TASK_CORE, xPortGetCoreID());
+    ffcRequest = CameraTask::prepare(CLASS_CAMERA, 0x02, FLAG_WRITE);
+    pinMode(BUTTON_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(BUTTON_PIN), onButton, FALLING);
+
+    xTaskCreatePinnedToCore(telemetryTask, "telemetry", 4096, nullptr, 1, nullptr, 1);
+}
+
+void loop() {
+    uint32_t start = micros();
+    uint32_t now = millis();
+
+    if (now - lastRead >= READ_MS) {
+        lastRead = now;
+        cameraIo.postRead(CLASS_IMAGE, 0x02, CAMERA_PRIORITY_BACKGROUND);   // brillo
+    }
+    if (now - lastWrite >= WRITE_MS) {
+        lastWrite = now;
+        palette = (palette + 1) % (PALETTE_COLOR7 + 1);
+        cameraIo.postWrite(CLASS_IMAGE, 0x20, &palette, 1, CAMERA_PRIORITY_URGENT);
+    }
+
+    CameraEvent event;
+    while (cameraIo.poll(event)) {
+        if (event.code == CAMERA_ERR_ABORTED) {
+            continue; // lectura de fondo cedida a un comando urgente
+        }
+        if (event.code != CAMERA_OK) {
+            errors++;
+        } else if (event.fromIsr) {
+            Serial.printf("FFC por botón: %lu us desde la interrupción hasta la TX\n",
+                          (unsigned long)(event.startUs - event.postedUs));
+        } else if (event.rw == FLAG_READ && event.length) {
+            brightness = event.data[0];
+        }
+    }
+
+    uint32_t elapsed = micros() - start;
+    if (elapsed > loopMaxUs) {
+        loopMaxUs = elapsed;
+    }
+
+    if (now - lastReport >= REPORT_MS) {
+        lastReport = now;
+        Serial.printf("\nBrillo %u, paleta %u, %lu errores, vuelta máx del loop %lu us\n", brightness, palette,
+                      (unsigned long)errors, (unsigned long)loopMaxUs);
+        cameraIo.printStats(Serial);
+        cameraIo.resetStats();
+        loopMaxUs = 0;
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ * Prueba del modo de asignación estática del ThermalCameraController
+ *
+ * Este ejemplo comprueba que, con CAMERA_STATIC_ALLOCATION=1, el
+ * controlador no reserva heap después de begin(). Todas las llamadas a
+ * malloc/calloc/realloc se cuentan con el hook de CameraAlloc:
+ *
+ * build_flags =
+ *     -D CAMERA_STATIC_ALLOCATION=1 -D CAMERA_TRACK_ALLOCATIONS=1
+ *     -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc -Wl,--wrap=free
+ *
+ * Conexiones:
+ * - ESP32 GPIO16 -> Camera RX
+ * - ESP32 GPIO17 -> Camera TX
+ * - Camera Power: 5V-16V
+ * - Camera GND -> ESP32 GND
+ */
+
+#include <Arduino.h>
+#include <CameraController.h>
+#include <CameraAlloc.h>
+
+#if !CAMERA_STATIC_ALLOCATION || !CAMERA_TRACK_ALLOCATIONS
+#error "Compilar con -D CAMERA_STATIC_ALLOCATION=1 -D CAMERA_TRACK_ALLOCATIONS=1"
+#endif
+
+// Configuración de pines
+#define RX_PIN 16
+#define TX_PIN 17
+#define TEST_CYCLES 200
+
+// Crear instancias
+HardwareSerial cameraSerial(2);
+CameraController camera(&cameraSerial, RX_PIN, TX_PIN);
+
+static uint32_t responses = 0;
+
+// Callback sin heap: solo cuenta las respuestas
+void handleCameraResponse(const char* interpretation) {
+    (void)interpretation;
+    responses++;
+}
+
+void runCommandCycle() {
+    CameraInfo info;
+    char model[CAMERA_MODEL_SIZE];
+
+    camera.setBrightness(75);
+    camera.setContrast(60);
+    camera.setPalette(PALETTE_IRON);
+    camera.moveCursorUp(3);
+    camera.setBrightness(150); // Fuera de rango: ruta de error
+    camera.getBrightness();
+    camera.getCurrentPalette();
+    camera.getModel(model, sizeof(model));
+    camera.getDeviceInfo(info);
+    camera.getLastErrorText();
+    camera.update();
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    Serial.println("=== Thermal Camera Controller - Static Allocation Test ===");
+    Serial.printf("Response buffer: %u bytes, controller: %u bytes\n",
+                  (unsigned)Response::capacity, (unsigned)sizeof(CameraController));
+
+    CameraController::setGlobalResponseTextHandler(handleCameraResponse);
+
+    if (!camera.begin()) {
+        Serial.printf("❌ Error al inicializar la cámara: %s\n", camera.getLastErrorText());
+        while (true) delay(1000);
+    }
+
+    // A partir de aquí no se permite ninguna reserva de heap
+    uint32_t before = cameraAllocSnapshot().allocs;
+    uint32_t heapBefore = ESP.getFreeHeap();
+
+    for (int i = 0; i < TEST_CYCLES; i++) {
+        runCommandCycle();
+    }
+
+    uint32_t allocations = cameraAllocSnapshot().allocs - before;
+    uint32_t heapAfter = ESP.getFreeHeap();
+
+    Serial.printf("Ciclos: %d, respuestas: %lu\n", TEST_CYCLES, (unsigned long)responses);
+    Serial.printf("Reservas después de begin(): %lu\n", (unsigned long)allocations);
+    Serial.printf("Heap libre: %lu -> %lu\n", (unsigned long)heapBefore, (unsigned long)heapAfter);
+    Serial.println(allocations == 0 ? "✅ PASS: sin heap después de begin()" : "❌ FAIL: se reservó heap después de begin()");
+}
+
+void loop() {
+    camera.update();
+}
@@ -0,0 +1,313 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+Arduino.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Minimal Arduino shim for the native (Linux) build
+*/
+
+#include "Arduino.h"
+#include <algorithm>
+#include <chrono>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+HardwareSerial Serial(0);
+EspClass ESP;
+int hostArgc = 0;
+char** hostArgv = nullptr;
+
+// ============================================================================
+// TIEMPO
+// ============================================================================
+
+/**
+ * Instante de arranque. Estático local y no global: los constructores de
+ * objetos globales de otros archivos (simulador, controlador) pueden leer
+ * el reloj antes de que se inicialicen los globales de este.
+ */
+static std::chrono::steady_clock::time_point bootTime() {
+    static const std::chrono::steady_clock::time_point boot = std::chrono::steady_clock::now();
+    return boot;
+}
+
+unsigned long millis() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - bootTime()).count();
+}
+
+unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - bootTime()).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+}
+
+// ============================================================================
+// STRING
+// ============================================================================
+
+std::string String::formatUnsigned(unsigned long value, unsigned char base) {
+    if (base < 2 || base > 36) {
+        base = DEC;
+    }
+    std::string text;
+    do {
+        unsigned digit = value % base;
+        text += (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+        value /= base;
+    } while (value);
+    std::reverse(text.begin(), text.end());
+    return text;
+}
+
+std::string String::format(long value, unsigned char base) {
+    if (value < 0 && base == DEC) {
+        return "-" + formatUnsigned(0UL - (unsigned long)value, base);
+    }
+    return formatUnsigned((unsigned long)value, base);
+}
+
+String::String(double value, unsigned int decimals) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+    _s = buffer;
+}
+
+void String::trim() {
+    size_t first = _s.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        _s.clear();
+        return;
+    }
+    size_t last = _s.find_last_not_of(" \t\r\n");
+    _s = _s.substr(first, last - first + 1);
+}
+
+void String::toUpperCase() {
+    for (size_t i = 0; i < _s.size(); i++) {
+        _s[i] = (char)toupper((unsigned char)_s[i]);
+    }
+}
+
+void String::toLowerCase() {
+    for (size_t i = 0; i < _s.size(); i++) {
+        _s[i] = (char)tolower((unsigned char)_s[i]);
+    }
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t pos = _s.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from >= _s.size() || to <= from) {
+        return String();
+    }
+    return String(_s.substr(from, to - from));
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+    if (_s.size() != other._s.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < _s.size(); i++) {
+        if (tolower((unsigned char)_s[i]) != tolower((unsigned char)other._s[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// PRINT
+// ============================================================================
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        write(buffer[i]);
+    }
+    return size;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) {
+        return 0;
+    }
+    return write((const uint8_t*)buffer, strlen(buffer));
+}
+
+// ============================================================================
+// HARDWARESERIAL
+// ============================================================================
+
+HardwareSerial::HardwareSerial(int uart)
+    : _uart(uart), _baud(0), _rxOverflows(0), _txHandler(nullptr), _txContext(nullptr),
+      _rxHandler(nullptr), _rxContext(nullptr), _fd(uart == 0 ? STDIN_FILENO : -1) {
+}
+
+HardwareSerial::~HardwareSerial() {
+    end();
+}
+
+static speed_t baudToSpeed(unsigned long baud) {
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default: return B115200;
+    }
+}
+
+void HardwareSerial::begin(unsigned long baud, uint32_t config, int8_t rxPin, int8_t txPin) {
+    (void)config;
+    (void)rxPin;
+    (void)txPin;
+    _baud = baud;
+    if (_uart != 0 && _fd >= 0) {
+        struct termios tty;
+        if (tcgetattr(_fd, &tty) == 0) {
+            cfsetispeed(&tty, baudToSpeed(baud));
+            cfsetospeed(&tty, baudToSpeed(baud));
+            tcsetattr(_fd, TCSANOW, &tty);
+        }
+    }
+}
+
+void HardwareSerial::end() {
+    if (_uart != 0 && _fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+}
+
+bool HardwareSerial::openDevice(const char* path) {
+    end();
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        return false;
+    }
+    struct termios tty;
+    if (tcgetattr(fd, &tty) == 0) {
+        cfmakeraw(&tty);
+        tcsetattr(fd, TCSANOW, &tty);
+    }
+    _fd = fd;
+    return true;
+}
+
+/**
+ * Pasa a la cola lo que haya en stdin (UART 0) o en el dispositivo, sin bloquear.
+ */
+void HardwareSerial::pollInput() {
+    if (_rxHandler) {
+        _rxHandler(*this, _rxContext);
+    }
+    if (_fd < 0) {
+        return;
+    }
+    struct pollfd fd;
+    fd.fd = _fd;
+    fd.events = POLLIN;
+    fd.revents = 0;
+    if (poll(&fd, 1, 0) <= 0 || !(fd.revents & POLLIN)) {
+        return;
+    }
+    uint8_t buffer[256];
+    size_t space = HOST_SERIAL_RX_SIZE - _rx.size();
+    ssize_t count = ::read(_fd, buffer, space < sizeof(buffer) ? space : sizeof(buffer));
+    if (count > 0) {
+        inject(buffer, (size_t)count);
+    }
+}
+
+int HardwareSerial::available() {
+    pollInput();
+    return (int)_rx.size();
+}
+
+int HardwareSerial::read() {
+    if (_rx.empty()) {
+        pollInput();
+    }
+    uint8_t c;
+    return _rx.pop(c) ? c : -1;
+}
+
+int HardwareSerial::peek() {
+    if (_rx.empty()) {
+        pollInput();
+    }
+    return _rx.empty() ? -1 : _rx.at(0);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (_uart == 0) {
+        fwrite(buffer, 1, size, stdout);
+        fflush(stdout);
+    } else if (_fd >= 0) {
+        size_t sent = 0;
+        while (sent < size) {
+            ssize_t n = ::write(_fd, buffer + sent, size - sent);
+            if (n > 0) {
+                sent += (size_t)n;
+            } else if (n < 0 && errno != EAGAIN && errno != EINTR) {
+                break;
+            }
+        }
+        return sent;
+    } else if (_txHandler) {
+        _txHandler(*this, buffer, size, _txContext);
+    } else {
+        _tx.insert(_tx.end(), buffer, buffer + size);
+    }
+    return size;
+}
+
+void HardwareSerial::inject(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (!_rx.push(data[i])) {
+            _rxOverflows++;
+        }
+    }
+}
+
+void HardwareSerial::setTxHandler(HostTxHandler handler, void* context) {
+    _txHandler = handler;
+    _txContext = context;
+}
+
+void HardwareSerial::setRxHandler(HostRxHandler handler, void* context) {
+    _rxHandler = handler;
+    _rxContext = context;
+}
@@ -0,0 +1,138 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+Arduino.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Minimal Arduino shim for the native (Linux) build
+Docs:
+    Solo lo que usan CameraController, MenuSystem y los ejemplos: String,
+    Print/Stream, millis/micros/delay y HardwareSerial (transporte en
+    memoria, ver HardwareSerial.h). Se compila con pio run -e native.
+*/
+
+#ifndef ARDUINO_HOST_SHIM_H
+#define ARDUINO_HOST_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string>
+
+#define HEX 16
+#define DEC 10
+#define OCT 8
+#define BIN 2
+
+// Sin flash separada: las tablas PROGMEM son memoria normal
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_ptr(addr) (*(const void* const*)(addr))
+#define IRAM_ATTR
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+class String {
+public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    explicit String(char c) : _s(1, c) {}
+    String(int value, unsigned char base = DEC) : _s(format((long)value, base)) {}
+    String(unsigned int value, unsigned char base = DEC) : _s(formatUnsigned(value, base)) {}
+    String(long value, unsigned char base = DEC) : _s(format(value, base)) {}
+    String(unsigned long value, unsigned char base = DEC) : _s(formatUnsigned(value, base)) {}
+    String(unsigned char value, unsigned char base = DEC) : _s(formatUnsigned(value, base)) {}
+    String(double value, unsigned int decimals = 2);
+
+    unsigned int length() const { return (unsigned int)_s.size(); }
+    const char* c_str() const { return _s.c_str(); }
+    bool reserve(unsigned int size) { _s.reserve(size); return true; }
+    void trim();
+    void toUpperCase();
+    void toLowerCase();
+    long toInt() const { return atol(_s.c_str()); }
+    float toFloat() const { return (float)atof(_s.c_str()); }
+    int indexOf(char c, unsigned int from = 0) const;
+    String substring(unsigned int from, unsigned int to = 0xFFFFFFFF) const;
+    bool startsWith(const String& prefix) const { return _s.compare(0, prefix._s.size(), prefix._s) == 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+    char operator[](unsigned int index) const { return index < _s.size() ? _s[index] : 0; }
+
+    String& operator+=(const String& other) { _s += other._s; return *this; }
+    String& operator+=(const char* other) { _s += other; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    bool operator==(const String& other) const { return _s == other._s; }
+    bool operator==(const char* other) const { return _s == other; }
+    bool operator!=(const String& other) const { return _s != other._s; }
+    bool operator!=(const char* other) const { return _s != other; }
+    bool equalsIgnoreCase(const String& other) const;
+
+    friend String operator+(const String& a, const String& b) { return String(a._s + b._s); }
+    friend String operator+(const String& a, const char* b) { return String(a._s + b); }
+    friend String operator+(const char* a, const String& b) { return String(std::string(a) + b._s); }
+
+private:
+    static std::string format(long value, unsigned char base);
+    static std::string formatUnsigned(unsigned long value, unsigned char base);
+    std::string _s;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned char value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(double value, int digits = 2) { return print(String(value, (unsigned int)digits)); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template <typename T> size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+};
+
+#include "HardwareSerial.h"
+
+// Sin heap de ESP-IDF en el host
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 0; }
+    uint32_t getMinFreeHeap() { return 0; }
+    uint32_t getMaxAllocHeap() { return 0; }
+};
+extern EspClass ESP;
+
+// Argumentos de la línea de comandos (para herramientas del host)
+extern int hostArgc;
+extern char** hostArgv;
+
+#endif
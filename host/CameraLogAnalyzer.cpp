@@ -0,0 +1,485 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraLogAnalyzer.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Offline analyzer for UART capture files (native build)
+*/
+
+#include "CameraLogAnalyzer.h"
+#include "CameraText.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Trama RX mínima: F0 SIZE 36 CLS SUB FLAG LEN CHK FF (LEN = 0)
+#define ANALYZER_MIN_FRAME 9
+
+CameraLogAnalyzer::CameraLogAnalyzer(const AnalyzerOptions& options)
+    : _options(options), _slots(65536, 0), _frameLength(0), _frameExpected(0), _frameUs(0),
+      _lastRawUs(0), _wrapUs(0), _started(false) {
+    memset(&_totals, 0, sizeof(_totals));
+    memset(&_burst, 0, sizeof(_burst));
+    _latency.reset();
+}
+
+// ============================================================================
+// ENTRADA
+// ============================================================================
+
+bool CameraLogAnalyzer::analyzeFile(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)info.st_size;
+    if (size == 0) {
+        close(fd);
+        return true;
+    }
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    madvise(map, size, MADV_SEQUENTIAL); // lectura de principio a fin: readahead agresivo
+
+    // Mismo criterio que la reproducción: el texto no tiene bytes de control
+    const uint8_t* data = static_cast<const uint8_t*>(map);
+    bool text = true;
+    for (size_t i = 0; i < size && i < 256; i++) {
+        if (data[i] < 0x20 && data[i] != '\n' && data[i] != '\r' && data[i] != '\t') {
+            text = false;
+            break;
+        }
+    }
+    if (text) {
+        analyzeText(reinterpret_cast<const char*>(data), size);
+    } else {
+        analyzeBinary(data, size);
+    }
+    munmap(map, size);
+    return true;
+}
+
+void CameraLogAnalyzer::analyzeBinary(const uint8_t* data, size_t size) {
+    // Mismo formato que captureDecodeRecord(), leído en su sitio sin copiar el registro
+    size_t offset = 0;
+    while (offset + CAPTURE_HEADER_SIZE <= size) {
+        const uint8_t* header = data + offset;
+        size_t length = header[4] & CAPTURE_MAX_CHUNK;
+        if (offset + CAPTURE_HEADER_SIZE + length > size) {
+            break;
+        }
+        uint32_t timestamp = (uint32_t)header[0] | ((uint32_t)header[1] << 8) |
+                             ((uint32_t)header[2] << 16) | ((uint32_t)header[3] << 24);
+        onRecord(timestamp, (header[4] & CAPTURE_DIR_RX) != 0, header + CAPTURE_HEADER_SIZE, length);
+        offset += CAPTURE_HEADER_SIZE + length;
+    }
+    _totals.inputBytes += size;
+}
+
+static inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+void CameraLogAnalyzer::analyzeText(const char* text, size_t size) {
+    // "@<µs> TX|RX XX XX ..."; el mapa no termina en '\0', así que todo va acotado por end
+    uint8_t bytes[256];
+    const char* p = text;
+    const char* end = text + size;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!eol) {
+            eol = end;
+        }
+        while (p < eol && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+        if (p < eol && *p == '@') {
+            p++;
+            uint32_t timestamp = 0;
+            while (p < eol && *p >= '0' && *p <= '9') {
+                timestamp = timestamp * 10 + (uint32_t)(*p - '0');
+                p++;
+            }
+            while (p < eol && *p == ' ') {
+                p++;
+            }
+            if (eol - p >= 2 && (p[0] == 'T' || p[0] == 'R') && p[1] == 'X') {
+                bool rx = (p[0] == 'R');
+                p += 2;
+                size_t n = 0;
+                while (p < eol && n < sizeof(bytes)) {
+                    while (p < eol && *p == ' ') {
+                        p++;
+                    }
+                    if (eol - p < 2) {
+                        break;
+                    }
+                    int hi = hexValue(p[0]);
+                    int lo = hexValue(p[1]);
+                    if (hi < 0 || lo < 0) {
+                        break;
+                    }
+                    bytes[n++] = (uint8_t)(hi << 4 | lo);
+                    p += 2;
+                }
+                if (n > 0) {
+                    onRecord(timestamp, rx, bytes, n);
+                }
+            }
+        }
+        p = eol + 1;
+    }
+    _totals.inputBytes += size;
+}
+
+// ============================================================================
+// DECODIFICACIÓN
+// ============================================================================
+
+uint64_t CameraLogAnalyzer::unwrap(uint32_t rawUs) {
+    if (_started && rawUs < _lastRawUs && _lastRawUs - rawUs > 0x80000000UL) {
+        _wrapUs += 0x100000000ULL; // micros() dio la vuelta
+    }
+    _lastRawUs = rawUs;
+    return _wrapUs + rawUs;
+}
+
+void CameraLogAnalyzer::onRecord(uint32_t rawUs, bool rx, const uint8_t* data, size_t length) {
+    uint64_t us = unwrap(rawUs);
+    if (!_started) {
+        _totals.firstUs = us;
+        _started = true;
+    }
+    _totals.lastUs = us;
+    _totals.records++;
+
+    if (!rx) {
+        onTx(us, data, length);
+        return;
+    }
+    for (size_t i = 0; i < length; i++) {
+        onRxByte(us, data[i]);
+    }
+}
+
+AnalyzerCommandStats& CameraLogAnalyzer::command(uint8_t cls, uint8_t subcls) {
+    uint16_t& slot = _slots[(uint16_t)(cls << 8 | subcls)];
+    if (slot == 0) {
+        AnalyzerCommandStats stats;
+        memset(&stats, 0, sizeof(stats));
+        stats.cls = cls;
+        stats.subcls = subcls;
+        stats.latency.reset();
+        _commands.push_back(stats);
+        slot = (uint16_t)_commands.size();
+    }
+    return _commands[slot - 1];
+}
+
+void CameraLogAnalyzer::onTx(uint64_t us, const uint8_t* data, size_t length) {
+    _totals.txFrames++;
+    if (length < 7 || data[0] != HEADER_BYTE) {
+        return;
+    }
+    AnalyzerCommandStats& c = command(data[3], data[4]);
+    c.tx++;
+    c.bytesTx += length;
+    bool read = (data[5] == FLAG_READ);
+    if (read) {
+        c.reads++;
+    } else {
+        c.writes++;
+    }
+
+    if (c.pending && c.pendingRead) {
+        // La lectura anterior del mismo comando nunca tuvo respuesta
+        c.unanswered++;
+        _totals.unanswered++;
+        onError(us);
+    }
+    c.pending = true;
+    c.pendingRead = read;
+    c.pendingUs = us;
+}
+
+void CameraLogAnalyzer::onRxByte(uint64_t us, uint8_t value) {
+    if (_frameLength == 0) {
+        if (value != HEADER_BYTE) {
+            _totals.noiseBytes++;
+            return;
+        }
+        _frameUs = us;
+    }
+    _frame[_frameLength++] = value;
+
+    if (_frameLength == 2) {
+        _frameExpected = (size_t)value + 4;
+        if (_frameExpected < ANALYZER_MIN_FRAME || _frameExpected > ANALYZER_MAX_FRAME) {
+            _totals.shortFrames++;
+            onError(us);
+            resync(us);
+            return;
+        }
+    }
+    if (_frameLength >= 2 && _frameLength == _frameExpected) {
+        onFrame(us);
+    }
+}
+
+void CameraLogAnalyzer::resync(uint64_t us) {
+    // Vuelve a empezar en el siguiente 0xF0 de lo acumulado (como resyncResponse())
+    uint8_t tail[ANALYZER_MAX_FRAME];
+    size_t start = 1;
+    while (start < _frameLength && _frame[start] != HEADER_BYTE) {
+        start++;
+    }
+    size_t count = _frameLength - start;
+    memcpy(tail, _frame + start, count);
+    _totals.noiseBytes += start;
+    _frameLength = 0;
+    for (size_t i = 0; i < count; i++) {
+        onRxByte(us, tail[i]);
+    }
+}
+
+void CameraLogAnalyzer::onFrame(uint64_t us) {
+    _totals.rxFrames++;
+    CameraErrorCode code = CameraController::validateFrame(_frame, _frameLength);
+
+    if (code == CAMERA_ERR_SHORT_FRAME) {
+        // Sin 0xFF al final: el SIZE era basura o se perdieron bytes
+        _totals.shortFrames++;
+        onError(us);
+        resync(us);
+        return;
+    }
+
+    AnalyzerCommandStats& c = command(_frame[3], _frame[4]);
+    c.bytesRx += _frameLength;
+    if (code == CAMERA_ERR_BAD_CHECKSUM) {
+        _totals.badChecksum++;
+        c.badFrames++;
+        onError(us);
+    } else {
+        if (c.pending) {
+            uint64_t latency = _frameUs - c.pendingUs;
+            c.latency.add((uint32_t)std::min<uint64_t>(latency, 0xFFFFFFFFUL));
+            _latency.add((uint32_t)std::min<uint64_t>(latency, 0xFFFFFFFFUL));
+            c.pending = false;
+        } else {
+            _totals.unsolicited++;
+        }
+        if (code == CAMERA_OK) {
+            _totals.validFrames++;
+            c.replies++;
+        } else {
+            _totals.errorReplies++;
+            c.errorReplies++;
+            onError(us);
+        }
+    }
+
+    if (_options.decodeOut) {
+        char text[CAMERA_TEXT_SIZE];
+        cameraInterpretFrame(_frame, _frameLength, text, sizeof(text));
+        _options.decodeOut->printf("@%llu %s %s\n", (unsigned long long)_frameUs, cameraCommandName(_frame[3], _frame[4]),
+                                   code == CAMERA_ERR_BAD_CHECKSUM ? "(checksum incorrecto)" : text);
+    }
+    _frameLength = 0;
+}
+
+void CameraLogAnalyzer::onError(uint64_t us) {
+    if (_burst.errors > 0 && us - _burst.endUs <= (uint64_t)_options.burstWindowMs * 1000) {
+        _burst.endUs = us;
+        _burst.errors++;
+        return;
+    }
+    closeBurst();
+    _burst.startUs = us;
+    _burst.endUs = us;
+    _burst.errors = 1;
+}
+
+void CameraLogAnalyzer::closeBurst() {
+    if (_burst.errors >= _options.burstMinErrors && _burst.errors > 0) {
+        _bursts.push_back(_burst);
+    }
+    _burst.errors = 0;
+}
+
+void CameraLogAnalyzer::finish() {
+    if (_frameLength > 0) {
+        _totals.shortFrames++;      // trama cortada al final de la captura
+        _totals.noiseBytes += _frameLength;
+        _frameLength = 0;
+    }
+    for (size_t i = 0; i < _commands.size(); i++) {
+        AnalyzerCommandStats& c = _commands[i];
+        if (c.pending && c.pendingRead) {
+            c.unanswered++;
+            _totals.unanswered++;
+        }
+        c.pending = false;
+    }
+    closeBurst();
+}
+
+// ============================================================================
+// SALIDA
+// ============================================================================
+
+void CameraLogAnalyzer::printSummary(Print& out) const {
+    const AnalyzerTotals& t = _totals;
+    out.printf("%llu registros, %.3f s de captura\n", (unsigned long long)t.records,
+               (t.lastUs - t.firstUs) / 1e6);
+    out.printf("TX %llu tramas | RX %llu tramas: %llu válidas, %llu con error del módulo, %llu checksum, %llu cortas\n",
+               (unsigned long long)t.txFrames, (unsigned long long)t.rxFrames, (unsigned long long)t.validFrames,
+               (unsigned long long)t.errorReplies, (unsigned long long)t.badChecksum, (unsigned long long)t.shortFrames);
+    out.printf("%llu lecturas sin respuesta, %llu respuestas no solicitadas, %llu bytes fuera de trama\n",
+               (unsigned long long)t.unanswered, (unsigned long long)t.unsolicited, (unsigned long long)t.noiseBytes);
+    out.printf("Latencia TX->RX: n=%lu media=%lu p50=%lu p90=%lu p99=%lu max=%lu us\n\n",
+               (unsigned long)_latency.count, (unsigned long)_latency.meanUs(), (unsigned long)_latency.percentileUs(50),
+               (unsigned long)_latency.percentileUs(90), (unsigned long)_latency.percentileUs(99),
+               (unsigned long)(_latency.count ? _latency.maxUs : 0));
+
+    std::vector<const AnalyzerCommandStats*> sorted;
+    for (size_t i = 0; i < _commands.size(); i++) {
+        sorted.push_back(&_commands[i]);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const AnalyzerCommandStats* a, const AnalyzerCommandStats* b) { return a->tx > b->tx; });
+
+    out.println("CLS  SUB  comando                TX      resp    err  chk  sinresp  p50     p99     max (us)");
+    for (size_t i = 0; i < sorted.size(); i++) {
+        const AnalyzerCommandStats& c = *sorted[i];
+        out.printf("0x%02X 0x%02X %-20s %-7lu %-7lu %-4lu %-4lu %-8lu %-7lu %-7lu %lu\n", c.cls, c.subcls,
+                   cameraCommandName(c.cls, c.subcls), (unsigned long)c.tx, (unsigned long)c.replies,
+                   (unsigned long)c.errorReplies, (unsigned long)c.badFrames, (unsigned long)c.unanswered,
+                   (unsigned long)c.latency.percentileUs(50), (unsigned long)c.latency.percentileUs(99),
+                   (unsigned long)(c.latency.count ? c.latency.maxUs : 0));
+    }
+
+    out.printf("\n%u ráfagas de errores (>= %lu errores separados < %lu ms)\n", (unsigned)_bursts.size(),
+               (unsigned long)_options.burstMinErrors, (unsigned long)_options.burstWindowMs);
+    std::vector<AnalyzerBurst> worst(_bursts);
+    std::sort(worst.begin(), worst.end(),
+              [](const AnalyzerBurst& a, const AnalyzerBurst& b) { return a.errors > b.errors; });
+    for (size_t i = 0; i < worst.size() && i < 10; i++) {
+        out.printf("  t=%.3f s  %lu errores en %.3f s\n", (worst[i].startUs - t.firstUs) / 1e6,
+                   (unsigned long)worst[i].errors, (worst[i].endUs - worst[i].startUs) / 1e6);
+    }
+}
+
+/**
+ * Escribe un texto entre comillas escapando lo necesario para CSV o JSON.
+ */
+static void writeQuoted(FILE* file, const char* text, bool json) {
+    fputc('"', file);
+    for (const char* p = text; *p; p++) {
+        if (*p == '"') {
+            fputs(json ? "\\\"" : "\"\"", file);
+        } else if (json && *p == '\\') {
+            fputs("\\\\", file);
+        } else {
+            fputc(*p, file);
+        }
+    }
+    fputc('"', file);
+}
+
+bool CameraLogAnalyzer::writeCsv(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "cls,subcls,name,tx,reads,writes,replies,error_replies,bad_checksum,unanswered,"
+                  "bytes_tx,bytes_rx,latency_count,latency_mean_us,latency_p50_us,latency_p90_us,latency_p99_us,"
+                  "latency_max_us\n");
+    for (size_t i = 0; i < _commands.size(); i++) {
+        const AnalyzerCommandStats& c = _commands[i];
+        fprintf(file, "0x%02X,0x%02X,", c.cls, c.subcls);
+        writeQuoted(file, cameraCommandName(c.cls, c.subcls), false);
+        fprintf(file, ",%lu,%lu,%lu,%lu,%lu,%lu,%lu,%llu,%llu,%lu,%lu,%lu,%lu,%lu,%lu\n", (unsigned long)c.tx,
+                (unsigned long)c.reads, (unsigned long)c.writes, (unsigned long)c.replies,
+                (unsigned long)c.errorReplies, (unsigned long)c.badFrames, (unsigned long)c.unanswered,
+                (unsigned long long)c.bytesTx, (unsigned long long)c.bytesRx, (unsigned long)c.latency.count,
+                (unsigned long)c.latency.meanUs(), (unsigned long)c.latency.percentileUs(50),
+                (unsigned long)c.latency.percentileUs(90), (unsigned long)c.latency.percentileUs(99),
+                (unsigned long)(c.latency.count ? c.latency.maxUs : 0));
+    }
+    fclose(file);
+    return true;
+}
+
+bool CameraLogAnalyzer::writeJson(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    const AnalyzerTotals& t = _totals;
+    fprintf(file, "{\"totals\":{\"input_bytes\":%llu,\"records\":%llu,\"duration_us\":%llu,\"tx_frames\":%llu,"
+                  "\"rx_frames\":%llu,\"valid_frames\":%llu,\"error_replies\":%llu,\"bad_checksum\":%llu,"
+                  "\"short_frames\":%llu,\"unanswered\":%llu,\"unsolicited\":%llu,\"noise_bytes\":%llu},\n",
+            (unsigned long long)t.inputBytes, (unsigned long long)t.records,
+            (unsigned long long)(t.lastUs - t.firstUs), (unsigned long long)t.txFrames,
+            (unsigned long long)t.rxFrames, (unsigned long long)t.validFrames, (unsigned long long)t.errorReplies,
+            (unsigned long long)t.badChecksum, (unsigned long long)t.shortFrames, (unsigned long long)t.unanswered,
+            (unsigned long long)t.unsolicited, (unsigned long long)t.noiseBytes);
+
+    fprintf(file, "\"latency\":{\"count\":%lu,\"mean_us\":%lu,\"p50_us\":%lu,\"p90_us\":%lu,\"p99_us\":%lu,"
+                  "\"max_us\":%lu,\"histogram\":[",
+            (unsigned long)_latency.count, (unsigned long)_latency.meanUs(), (unsigned long)_latency.percentileUs(50),
+            (unsigned long)_latency.percentileUs(90), (unsigned long)_latency.percentileUs(99),
+            (unsigned long)(_latency.count ? _latency.maxUs : 0));
+    for (size_t i = 0; i < CAMERA_LATENCY_BUCKETS; i++) {
+        // El último bucket no tiene límite superior
+        if (i + 1 < CAMERA_LATENCY_BUCKETS) {
+            fprintf(file, "%s{\"le_us\":%lu,\"count\":%lu}", i ? "," : "", (unsigned long)CAMERA_LATENCY_BUCKET_US[i],
+                    (unsigned long)_latency.buckets[i]);
+        } else {
+            fprintf(file, ",{\"le_us\":null,\"count\":%lu}", (unsigned long)_latency.buckets[i]);
+        }
+    }
+    fprintf(file, "]},\n\"commands\":[");
+
+    for (size_t i = 0; i < _commands.size(); i++) {
+        const AnalyzerCommandStats& c = _commands[i];
+        fprintf(file, "%s\n{\"cls\":%u,\"subcls\":%u,\"name\":", i ? "," : "", c.cls, c.subcls);
+        writeQuoted(file, cameraCommandName(c.cls, c.subcls), true);
+        fprintf(file, ",\"tx\":%lu,\"reads\":%lu,\"writes\":%lu,\"replies\":%lu,\"error_replies\":%lu,"
+                      "\"bad_checksum\":%lu,\"unanswered\":%lu,\"bytes_tx\":%llu,\"bytes_rx\":%llu,"
+                      "\"latency\":{\"count\":%lu,\"mean_us\":%lu,\"p50_us\":%lu,\"p90_us\":%lu,\"p99_us\":%lu,"
+                      "\"max_us\":%lu}}",
+                (unsigned long)c.tx, (unsigned long)c.reads, (unsigned long)c.writes, (unsigned long)c.replies,
+                (unsigned long)c.errorReplies, (unsigned long)c.badFrames, (unsigned long)c.unanswered,
+                (unsigned long long)c.bytesTx, (unsigned long long)c.bytesRx, (unsigned long)c.latency.count,
+                (unsigned long)c.latency.meanUs(), (unsigned long)c.latency.percentileUs(50),
+                (unsigned long)c.latency.percentileUs(90), (unsigned long)c.latency.percentileUs(99),
+                (unsigned long)(c.latency.count ? c.latency.maxUs : 0));
+    }
+    fprintf(file, "],\n\"bursts\":[");
+    for (size_t i = 0; i < _bursts.size(); i++) {
+        fprintf(file, "%s{\"start_us\":%llu,\"end_us\":%llu,\"errors\":%lu}", i ? "," : "",
+                (unsigned long long)(_bursts[i].startUs - t.firstUs), (unsigned long long)(_bursts[i].endUs - t.firstUs),
+                (unsigned long)_bursts[i].errors);
+    }
+    fprintf(file, "]}\n");
+    fclose(file);
+    return true;
+}
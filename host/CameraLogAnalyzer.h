@@ -0,0 +1,145 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraLogAnalyzer.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Offline analyzer for UART capture files (native build)
+Docs:
+    Recorre capturas de tráfico (binario de exportTo() o texto de
+    dumpCapture()) mapeadas en memoria, de principio a fin y sin copiarlas.
+    Las TX son tramas completas; las RX se reensamblan byte a byte por el
+    campo SIZE (F0 SIZE 36 CLS SUB FLAG LEN DATA CHK FF, SIZE + 4 bytes) y se
+    validan con CameraController::validateFrame(). Los nombres salen de
+    CAMERA_COMMAND_NAMES y el texto opcional de cameraInterpretFrame(): las
+    mismas tablas que el firmware.
+
+    Por comando: TX, lecturas, respuestas, errores, lecturas sin respuesta y
+    latencia TX -> primera RX. Los errores que caen a menos de burstWindowMs
+    del anterior forman una ráfaga; se guardan las de burstMinErrors o más.
+*/
+
+#ifndef CAMERA_LOG_ANALYZER_H
+#define CAMERA_LOG_ANALYZER_H
+
+#include <Arduino.h>
+#include "CameraCapture.h"
+#include "CameraController.h"
+#include "CameraStats.h"
+#include <vector>
+
+// Trama RX más larga que se reensambla (el resto se trata como basura)
+#define ANALYZER_MAX_FRAME 64
+
+struct AnalyzerOptions {
+    uint32_t burstWindowMs;     // separación máxima entre errores de una ráfaga
+    uint32_t burstMinErrors;    // errores mínimos para registrar una ráfaga
+    Print* decodeOut;           // si no es nullptr: una línea decodificada por trama RX
+
+    AnalyzerOptions() : burstWindowMs(1000), burstMinErrors(3), decodeOut(nullptr) {}
+};
+
+struct AnalyzerCommandStats {
+    uint8_t cls;
+    uint8_t subcls;
+    uint32_t tx;
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t replies;           // respuestas válidas (lectura o confirmación)
+    uint32_t errorReplies;      // flag 0x04 (fuera de rango / no soportado)
+    uint32_t badFrames;         // checksum incorrecto
+    uint32_t unanswered;        // lecturas sin respuesta antes de la siguiente igual
+    uint64_t bytesTx;
+    uint64_t bytesRx;
+    CameraLatencyHistogram latency;
+    uint64_t pendingUs;         // última TX aún sin respuesta
+    bool pending;
+    bool pendingRead;
+};
+
+struct AnalyzerBurst {
+    uint64_t startUs;
+    uint64_t endUs;
+    uint32_t errors;
+};
+
+struct AnalyzerTotals {
+    uint64_t inputBytes;
+    uint64_t records;
+    uint64_t txFrames;
+    uint64_t rxFrames;          // tramas RX completas (válidas o no)
+    uint64_t validFrames;
+    uint64_t badChecksum;
+    uint64_t shortFrames;       // cortadas o con marcas incorrectas
+    uint64_t errorReplies;
+    uint64_t unanswered;
+    uint64_t unsolicited;       // respuestas sin TX pendiente
+    uint64_t noiseBytes;        // bytes RX fuera de trama
+    uint64_t firstUs;
+    uint64_t lastUs;
+};
+
+class CameraLogAnalyzer {
+public:
+    explicit CameraLogAnalyzer(const AnalyzerOptions& options = AnalyzerOptions());
+
+    /**
+     * Mapea el archivo y lo analiza (detecta binario o texto).
+     * @return false si no se pudo abrir o mapear.
+     */
+    bool analyzeFile(const char* path);
+    void analyzeBinary(const uint8_t* data, size_t size);
+    void analyzeText(const char* text, size_t size);
+
+    /**
+     * Cierra la trama y la ráfaga en curso y cuenta las lecturas pendientes.
+     * Llamar una vez tras el último archivo.
+     */
+    void finish();
+
+    const AnalyzerTotals& totals() const { return _totals; }
+    const std::vector<AnalyzerCommandStats>& commands() const { return _commands; }
+    const std::vector<AnalyzerBurst>& bursts() const { return _bursts; }
+    const CameraLatencyHistogram& latency() const { return _latency; }
+
+    void printSummary(Print& out) const;
+
+    /**
+     * CSV con una fila por comando.
+     */
+    bool writeCsv(const char* path) const;
+
+    /**
+     * JSON con totales, comandos y ráfagas.
+     */
+    bool writeJson(const char* path) const;
+
+private:
+    void onRecord(uint32_t rawUs, bool rx, const uint8_t* data, size_t length);
+    uint64_t unwrap(uint32_t rawUs);
+    void onTx(uint64_t us, const uint8_t* data, size_t length);
+    void onRxByte(uint64_t us, uint8_t value);
+    void onFrame(uint64_t us);
+    void resync(uint64_t us);
+    void onError(uint64_t us);
+    void closeBurst();
+    AnalyzerCommandStats& command(uint8_t cls, uint8_t subcls);
+
+    AnalyzerOptions _options;
+    AnalyzerTotals _totals;
+    std::vector<AnalyzerCommandStats> _commands;
+    std::vector<uint16_t> _slots;        // (cls << 8 | subcls) -> índice + 1 en _commands
+    std::vector<AnalyzerBurst> _bursts;
+    AnalyzerBurst _burst;
+    CameraLatencyHistogram _latency;
+    uint8_t _frame[ANALYZER_MAX_FRAME];
+    size_t _frameLength;
+    size_t _frameExpected;
+    uint64_t _frameUs;
+    uint32_t _lastRawUs;
+    uint64_t _wrapUs;
+    bool _started;
+};
+
+#endif
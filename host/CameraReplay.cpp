@@ -0,0 +1,351 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraReplay.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Record/replay of captured UART sessions for the native build
+*/
+
+#include "CameraReplay.h"
+#include "CameraClock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+CameraReplay::CameraReplay() : _port(nullptr), _timing(REPLAY_ORIGINAL), _lastRawUs(0), _wrapUs(0) {
+    rewind();
+}
+
+CameraReplay::~CameraReplay() {
+    detach();
+}
+
+// ============================================================================
+// CARGA
+// ============================================================================
+
+bool CameraReplay::load(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> content;
+    uint8_t buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        content.insert(content.end(), buffer, buffer + n);
+    }
+    fclose(file);
+
+    // El texto del monitor solo lleva caracteres imprimibles (o UTF-8);
+    // el binario tiene cabeceras y tramas con bytes de control
+    bool text = !content.empty();
+    for (size_t i = 0; i < content.size() && i < 256; i++) {
+        uint8_t c = content[i];
+        if (c < 0x20 && c != '\n' && c != '\r' && c != '\t') {
+            text = false;
+            break;
+        }
+    }
+    return text ? loadText((const char*)content.data(), content.size())
+                : loadBinary(content.data(), content.size());
+}
+
+bool CameraReplay::loadBinary(const uint8_t* data, size_t size) {
+    _chunks.clear();
+    _lastRawUs = 0;
+    _wrapUs = 0;
+    CaptureRecord record;
+    size_t offset = 0;
+    size_t used;
+    while ((used = captureDecodeRecord(data + offset, size - offset, record)) > 0) {
+        addChunk(record.timestamp, record.direction, record.data, record.length);
+        offset += used;
+    }
+    buildExchanges();
+    return !_exchanges.empty();
+}
+
+bool CameraReplay::loadText(const char* text, size_t size) {
+    _chunks.clear();
+    _lastRawUs = 0;
+    _wrapUs = 0;
+    std::vector<uint8_t> bytes;
+    const char* end = text + size;
+    const char* line = text;
+    while (line < end) {
+        const char* eol = line;
+        while (eol < end && *eol != '\n') {
+            eol++;
+        }
+        std::string copy(line, eol);
+        line = eol + 1;
+
+        // "@<µs> TX|RX XX XX ..." (con o sin espacios delante)
+        const char* p = copy.c_str();
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p != '@') {
+            continue;
+        }
+        char* next;
+        uint32_t timestamp = (uint32_t)strtoul(p + 1, &next, 10);
+        while (*next == ' ') {
+            next++;
+        }
+        CaptureDirection direction;
+        if (strncmp(next, "TX", 2) == 0) {
+            direction = CAPTURE_TX;
+        } else if (strncmp(next, "RX", 2) == 0) {
+            direction = CAPTURE_RX;
+        } else {
+            continue;
+        }
+        p = next + 2;
+        bytes.clear();
+        for (;;) {
+            unsigned long value = strtoul(p, &next, 16);
+            if (next == p || value > 0xFF) {
+                break;
+            }
+            bytes.push_back((uint8_t)value);
+            p = next;
+        }
+        if (!bytes.empty()) {
+            addChunk(timestamp, direction, bytes.data(), bytes.size());
+        }
+    }
+    buildExchanges();
+    return !_exchanges.empty();
+}
+
+void CameraReplay::addChunk(uint64_t timestampUs, CaptureDirection direction, const uint8_t* data, size_t length) {
+    uint32_t raw = (uint32_t)timestampUs;
+    if (!_chunks.empty() && raw < _lastRawUs && _lastRawUs - raw > 0x80000000UL) {
+        _wrapUs += 0x100000000ULL; // micros() dio la vuelta
+    }
+    _lastRawUs = raw;
+    uint64_t timestamp = _wrapUs + raw;
+
+    // Una TX de más de CAPTURE_MAX_CHUNK bytes se graba en varios registros seguidos
+    if (!_chunks.empty() && _chunks.back().direction == direction && _chunks.back().timestampUs == timestamp &&
+        direction == CAPTURE_TX) {
+        _chunks.back().data.insert(_chunks.back().data.end(), data, data + length);
+        return;
+    }
+    ReplayChunk chunk;
+    chunk.timestampUs = timestamp;
+    chunk.direction = direction;
+    chunk.data.assign(data, data + length);
+    _chunks.push_back(chunk);
+}
+
+void CameraReplay::buildExchanges() {
+    _exchanges.clear();
+    for (size_t i = 0; i < _chunks.size(); i++) {
+        if (_chunks[i].direction == CAPTURE_TX) {
+            ReplayExchange exchange;
+            exchange.tx = i;
+            exchange.rxBegin = i + 1;
+            exchange.rxEnd = i + 1;
+            _exchanges.push_back(exchange);
+        } else if (!_exchanges.empty()) {
+            _exchanges.back().rxEnd = i + 1; // RX antes de la primera TX: se ignora
+        }
+    }
+    rewind();
+}
+
+uint64_t CameraReplay::exchangeOffsetUs(size_t index) const {
+    if (index >= _exchanges.size()) {
+        return 0;
+    }
+    return _chunks[_exchanges[index].tx].timestampUs - _chunks[_exchanges[0].tx].timestampUs;
+}
+
+// ============================================================================
+// TRANSPORTE
+// ============================================================================
+
+void CameraReplay::onTx(HardwareSerial& port, const uint8_t* data, size_t length, void* context) {
+    (void)port;
+    static_cast<CameraReplay*>(context)->receive(data, length);
+}
+
+void CameraReplay::onRx(HardwareSerial& port, void* context) {
+    static_cast<CameraReplay*>(context)->deliver(cameraMicros(), port);
+}
+
+void CameraReplay::attach(HardwareSerial& port) {
+    detach();
+    _port = &port;
+    port.setTxHandler(onTx, this);
+    port.setRxHandler(onRx, this);
+}
+
+void CameraReplay::detach() {
+    if (_port) {
+        _port->setTxHandler(nullptr);
+        _port->setRxHandler(nullptr);
+        _port = nullptr;
+    }
+}
+
+void CameraReplay::rewind() {
+    _next = 0;
+    _pending.clear();
+    memset(&_counters, 0, sizeof(_counters));
+    _mismatchIndex = -1;
+    _mismatchActual.clear();
+}
+
+void CameraReplay::receive(const uint8_t* data, size_t length) {
+    _counters.exchanges++;
+    if (_next >= _exchanges.size()) {
+        _counters.txUnexpected++;
+        return;
+    }
+    size_t index = _next++;
+    const ReplayExchange& exchange = _exchanges[index];
+    const ReplayChunk& tx = _chunks[exchange.tx];
+
+    if (tx.data.size() == length && memcmp(tx.data.data(), data, length) == 0) {
+        _counters.txMatched++;
+    } else {
+        _counters.txMismatched++;
+        if (_mismatchIndex < 0) {
+            _mismatchIndex = (long)index;
+            _mismatchActual.assign(data, data + length);
+        }
+    }
+
+    // Se contesta con lo grabado aunque la TX no coincida: lo que se prueba es el lado RX
+    uint32_t nowUs = cameraMicros();
+    for (size_t i = exchange.rxBegin; i < exchange.rxEnd; i++) {
+        const ReplayChunk& rx = _chunks[i];
+        uint32_t dueUs = nowUs;
+        if (_timing == REPLAY_ORIGINAL) {
+            dueUs += (uint32_t)(rx.timestampUs - tx.timestampUs);
+        }
+        for (size_t b = 0; b < rx.data.size(); b++) {
+            Pending byte = {dueUs, rx.data[b]};
+            if (!_pending.push(byte)) {
+                _counters.droppedBytes++;
+            }
+        }
+    }
+}
+
+void CameraReplay::deliver(uint32_t nowUs, HardwareSerial& port) {
+    uint8_t buffer[64];
+    while (!_pending.empty() && (int32_t)(nowUs - _pending.at(0).dueUs) >= 0) {
+        size_t n = 0;
+        Pending byte;
+        while (n < sizeof(buffer) && !_pending.empty() && (int32_t)(nowUs - _pending.at(0).dueUs) >= 0) {
+            _pending.pop(byte);
+            buffer[n++] = byte.value;
+        }
+        port.inject(buffer, n);
+        _counters.rxBytes += n;
+    }
+}
+
+// ============================================================================
+// REPRODUCCIÓN
+// ============================================================================
+
+size_t CameraReplay::run(CameraController& camera, ReplayTiming timing, std::vector<ReplayResult>* results) {
+    if (!_port) {
+        return 0;
+    }
+    setTiming(timing);
+    rewind();
+
+#if CAMERA_INJECTABLE_CLOCK
+    // Lo más rápido posible: los timeouts entre bytes no deben costar tiempo real
+    CameraVirtualClock virtualClock;
+    CameraClock* previousClock = cameraGetClock();
+    if (timing == REPLAY_FAST && !previousClock) {
+        cameraSetClock(&virtualClock);
+    }
+#endif
+
+    uint32_t lastUs = cameraMicros();
+    uint64_t elapsedUs = 0;
+    size_t played = 0;
+    for (size_t i = 0; i < _exchanges.size(); i++) {
+        if (timing == REPLAY_ORIGINAL) {
+            // Mantener los intervalos grabados entre comandos, atendiendo respuestas asíncronas
+            for (;;) {
+                uint32_t now = cameraMicros();
+                elapsedUs += now - lastUs;
+                lastUs = now;
+                if (elapsedUs >= exchangeOffsetUs(i)) {
+                    break;
+                }
+                camera.update();
+                cameraDelay(1);
+            }
+        }
+
+        const std::vector<uint8_t>& frame = _chunks[_exchanges[i].tx].data;
+        uint32_t matchedBefore = _counters.txMatched;
+        uint32_t start = cameraMicros();
+        camera.sendRawCommand(frame.data(), frame.size());
+        uint32_t latency = cameraMicros() - start;
+        played++;
+
+        if (results) {
+            ReplayResult result;
+            result.cls = frame.size() > 3 ? frame[3] : 0;
+            result.subcls = frame.size() > 4 ? frame[4] : 0;
+            result.rw = frame.size() > 5 ? frame[5] : 0;
+            result.txMatched = _counters.txMatched != matchedBefore;
+            result.code = camera.getLastCommandStatus().code;
+            result.latencyUs = latency;
+            results->push_back(result);
+        }
+
+        if (timing == REPLAY_FAST && (_port->available() || !_pending.empty())) {
+            // Respuesta a una escritura: que update() la cierre antes de la siguiente TX
+            while (_port->available() || !_pending.empty()) {
+                camera.update();
+                cameraDelay(1);
+            }
+            cameraDelay(BYTE_TIMEOUT + 1);
+            camera.update();
+        }
+    }
+
+    // Últimas respuestas asíncronas
+    while (!_pending.empty()) {
+        camera.update();
+        cameraDelay(1);
+    }
+    cameraDelay(BYTE_TIMEOUT + 1);
+    camera.update();
+
+#if CAMERA_INJECTABLE_CLOCK
+    cameraSetClock(previousClock);
+#endif
+    return played;
+}
+
+void CameraReplay::printFirstMismatch(Print& out) const {
+    if (_mismatchIndex < 0) {
+        return;
+    }
+    const std::vector<uint8_t>& expected = _chunks[_exchanges[_mismatchIndex].tx].data;
+    out.printf("TX #%ld esperada:", _mismatchIndex);
+    for (size_t i = 0; i < expected.size(); i++) {
+        out.printf(" %02X", expected[i]);
+    }
+    out.printf("\nTX #%ld recibida:", _mismatchIndex);
+    for (size_t i = 0; i < _mismatchActual.size(); i++) {
+        out.printf(" %02X", _mismatchActual[i]);
+    }
+    out.println();
+}
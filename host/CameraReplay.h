@@ -0,0 +1,157 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraReplay.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Record/replay of captured UART sessions for the native build
+Docs:
+    Carga una sesión grabada con la captura de tráfico (binario de
+    exportTo() o texto de dumpCapture(): "@<µs> TX|RX <hex>") y la agrupa
+    en intercambios: una trama TX y los bloques RX que la siguen.
+
+    Conectada a un puerto en memoria hace de cámara: cada write() del
+    controlador se compara con la TX esperada del siguiente intercambio y
+    se contesta con sus bloques RX grabados, tal cual (con sus rarezas):
+        REPLAY_ORIGINAL  con los retardos grabados respecto a la TX
+        REPLAY_FAST      todo de golpe (pensado para el reloj virtual)
+
+        CameraReplay replay;
+        replay.load("session.txt");
+        replay.attach(cameraSerial);
+        replay.run(camera, REPLAY_FAST);  // reenvía las TX con sendRawCommand()
+*/
+
+#ifndef CAMERA_REPLAY_H
+#define CAMERA_REPLAY_H
+
+#include <Arduino.h>
+#include "CameraCapture.h"
+#include "CameraController.h"
+#include "StaticRing.h"
+#include <vector>
+
+// Bytes de respuesta en vuelo (potencia de dos)
+#ifndef CAMERA_REPLAY_PENDING_SIZE
+#define CAMERA_REPLAY_PENDING_SIZE 4096
+#endif
+
+enum ReplayTiming : uint8_t {
+    REPLAY_ORIGINAL = 0,
+    REPLAY_FAST
+};
+
+struct ReplayChunk {
+    uint64_t timestampUs;       // desenrollado: sin el salto de micros() a 32 bits
+    CaptureDirection direction;
+    std::vector<uint8_t> data;
+};
+
+struct ReplayExchange {
+    size_t tx;                  // índice del bloque TX
+    size_t rxBegin;             // bloques RX [rxBegin, rxEnd)
+    size_t rxEnd;
+};
+
+struct ReplayResult {
+    uint8_t cls;
+    uint8_t subcls;
+    uint8_t rw;
+    bool txMatched;
+    CameraErrorCode code;       // estado del comando en el controlador
+    uint32_t latencyUs;         // según el reloj de la librería
+};
+
+struct ReplayCounters {
+    uint32_t exchanges;         // TX recibidas del controlador
+    uint32_t txMatched;
+    uint32_t txMismatched;
+    uint32_t txUnexpected;      // TX después del final de la sesión
+    uint32_t rxBytes;
+    uint32_t droppedBytes;      // cola de respuesta llena
+};
+
+class CameraReplay {
+public:
+    CameraReplay();
+    ~CameraReplay();
+
+    /**
+     * Carga una sesión: binario de exportTo() o texto de dumpCapture()
+     * (se detecta por el primer carácter; en texto se ignoran las líneas
+     * que no empiezan por '@', así vale el log completo del monitor serie).
+     * @return false si no se pudo leer o no contiene ninguna TX.
+     */
+    bool load(const char* path);
+    bool loadBinary(const uint8_t* data, size_t size);
+    bool loadText(const char* text, size_t size);
+
+    size_t chunkCount() const { return _chunks.size(); }
+    size_t exchangeCount() const { return _exchanges.size(); }
+    const ReplayExchange& exchange(size_t index) const { return _exchanges[index]; }
+    const ReplayChunk& chunk(size_t index) const { return _chunks[index]; }
+
+    /**
+     * @return Microsegundos desde la primera TX hasta la TX del intercambio.
+     */
+    uint64_t exchangeOffsetUs(size_t index) const;
+
+    void attach(HardwareSerial& port);
+    void detach();
+
+    /**
+     * Vuelve al primer intercambio y vacía la cola (contadores incluidos).
+     */
+    void rewind();
+    void setTiming(ReplayTiming timing) { _timing = timing; }
+
+    /**
+     * Bytes escritos por el controlador: una llamada por trama.
+     */
+    void receive(const uint8_t* data, size_t length);
+
+    /**
+     * Reproduce la sesión reenviando cada TX grabada con sendRawCommand().
+     * REPLAY_ORIGINAL respeta también los intervalos entre TX (llamando a
+     * update() mientras espera); REPLAY_FAST encadena los intercambios.
+     * @param results Opcional: un resultado por intercambio.
+     * @return Intercambios reproducidos.
+     */
+    size_t run(CameraController& camera, ReplayTiming timing, std::vector<ReplayResult>* results = nullptr);
+
+    bool finished() const { return _next >= _exchanges.size(); }
+    size_t pendingBytes() const { return _pending.size(); }
+    const ReplayCounters& counters() const { return _counters; }
+
+    /**
+     * Imprime la primera TX que no coincidió (esperada y recibida).
+     */
+    void printFirstMismatch(Print& out) const;
+
+private:
+    struct Pending {
+        uint32_t dueUs;
+        uint8_t value;
+    };
+
+    static void onTx(HardwareSerial& port, const uint8_t* data, size_t length, void* context);
+    static void onRx(HardwareSerial& port, void* context);
+    void addChunk(uint64_t timestampUs, CaptureDirection direction, const uint8_t* data, size_t length);
+    void buildExchanges();
+    void deliver(uint32_t nowUs, HardwareSerial& port);
+
+    std::vector<ReplayChunk> _chunks;
+    std::vector<ReplayExchange> _exchanges;
+    HardwareSerial* _port;
+    ReplayTiming _timing;
+    size_t _next;
+    uint32_t _lastRawUs;
+    uint64_t _wrapUs;
+    StaticRing<Pending, CAMERA_REPLAY_PENDING_SIZE> _pending;
+    ReplayCounters _counters;
+    long _mismatchIndex;
+    std::vector<uint8_t> _mismatchActual;
+};
+
+#endif
@@ -0,0 +1,438 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraSimulator.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Software JS-MINI256-9 for the native build
+*/
+
+#include "CameraSimulator.h"
+#include "CameraClock.h"
+#include "CameraController.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+// Códigos de error del módulo (flag 0x04)
+#define SIM_ERR_NO_COMMAND 0x00
+#define SIM_ERR_OUT_OF_RANGE 0x01
+#define FLAG_ERROR 0x04
+
+enum SimAccess : uint8_t {
+    SIM_READ = 0x01,
+    SIM_WRITE = 0x02,
+    SIM_ACTION = 0x04      // escritura sin estado (FFC, cursor, guardar...)
+};
+
+struct SimRegisterDef {
+    uint8_t cls;
+    uint8_t subcls;
+    uint8_t access;
+    uint8_t length;
+    uint8_t minValue;      // rango solo para registros de 1 byte
+    uint8_t maxValue;
+    uint8_t factory[CAMERA_SIM_MAX_VALUE];
+};
+
+#define SIM_DATE(v) {(uint8_t)((v) >> 24), (uint8_t)((v) >> 16), (uint8_t)((v) >> 8), (uint8_t)(v)}
+
+static const SimRegisterDef REGISTERS[] = {
+    // Información (0x74)
+    {CLASS_INFO, 0x02, SIM_READ, 12, 0, 0xFF, {'J', 'S', '-', 'M', 'I', 'N', 'I', '2', '5', '6', '-', '9'}},
+    {CLASS_INFO, 0x03, SIM_READ, 3, 0, 0xFF, {2, 1, 0}},
+    {CLASS_INFO, 0x04, SIM_READ, 4, 0, 0xFF, SIM_DATE(20240315UL)},
+    {CLASS_INFO, 0x05, SIM_READ, 3, 0, 0xFF, {1, 0, 7}},
+    {CLASS_INFO, 0x06, SIM_READ, 4, 0, 0xFF, SIM_DATE(20250110UL)},
+    {CLASS_INFO, 0x07, SIM_READ, 3, 0, 0xFF, {1, 1, 0}},
+    {CLASS_INFO, 0x08, SIM_READ, 3, 0, 0xFF, {3, 2, 1}},
+    {CLASS_INFO, 0x0C, SIM_READ, 4, 0, 0xFF, {0x0A, 0x0B, 0x0C, 0x0D}},
+    {CLASS_INFO, 0x0F, SIM_ACTION, 0, 0, 0xFF, {0}},    // restaurar fábrica
+    {CLASS_INFO, 0x10, SIM_ACTION, 0, 0, 0xFF, {0}},    // guardar configuración
+    // Imagen (0x78)
+    {CLASS_IMAGE, 0x02, SIM_READ | SIM_WRITE, 1, 0, 100, {50}},
+    {CLASS_IMAGE, 0x03, SIM_READ | SIM_WRITE, 1, 0, 100, {50}},
+    {CLASS_IMAGE, 0x10, SIM_READ | SIM_WRITE, 1, 0, 100, {50}},
+    {CLASS_IMAGE, 0x15, SIM_READ | SIM_WRITE, 1, 0, 100, {50}},
+    {CLASS_IMAGE, 0x16, SIM_READ | SIM_WRITE, 1, 0, 100, {50}},
+    {CLASS_IMAGE, 0x1A, SIM_ACTION, 1, 0, 0xFF, {0}},   // cursor
+    {CLASS_IMAGE, 0x20, SIM_READ | SIM_WRITE, 1, 0, PALETTE_COLOR7, {PALETTE_WHITE_HOT}},
+    // Cámara (0x7C)
+    {CLASS_CAMERA, 0x02, SIM_ACTION, 0, 0, 0xFF, {0}},  // FFC manual
+    {CLASS_CAMERA, 0x03, SIM_ACTION, 0, 0, 0xFF, {0}},  // corrección de fondo
+    {CLASS_CAMERA, 0x04, SIM_READ | SIM_WRITE, 1, 0, SHUTTER_FULL_AUTO, {SHUTTER_AUTO}},
+    {CLASS_CAMERA, 0x05, SIM_READ | SIM_WRITE, 2, 0, 0xFF, {0x00, 0x05}},
+    {CLASS_CAMERA, 0x0C, SIM_ACTION, 1, 0, 0xFF, {0}},  // viñeteado
+    {CLASS_CAMERA, 0x14, SIM_READ, 1, 0, 0xFF, {CAMERA_ACTIVE}},
+    // Espejo (0x70)
+    {CLASS_MIRROR, 0x11, SIM_READ | SIM_WRITE, 1, 0, MIRROR_VERTICAL, {MIRROR_DISABLED}},
+};
+
+static const int REGISTER_COUNT = sizeof(REGISTERS) / sizeof(REGISTERS[0]);
+
+CameraSimulator::CameraSimulator(const CameraSimConfig& config)
+    : _config(config), _random(config.seed), _port(nullptr), _ptyMaster(-1), _ptySlave(-1),
+      _values(REGISTER_COUNT * CAMERA_SIM_MAX_VALUE), _saved(REGISTER_COUNT * CAMERA_SIM_MAX_VALUE) {
+    resetCounters();
+    loadFactory(_saved);
+    // Sin powerOn() aquí: un simulador global se construye antes que el
+    // reloj del host. El encendido se hace en attach() / openPty().
+    _values = _saved;
+    _frameLength = 0;
+    _lastReplyEndUs = 0;
+    _anyAccepted = false;
+    _powerOnMs = 0;
+}
+
+CameraSimulator::~CameraSimulator() {
+    detach();
+    closePty();
+}
+
+void CameraSimulator::setConfig(const CameraSimConfig& config) {
+    _config = config;
+    _random.seed(config.seed);
+}
+
+void CameraSimulator::resetCounters() {
+    memset(&_counters, 0, sizeof(_counters));
+}
+
+void CameraSimulator::loadFactory(std::vector<uint8_t>& values) {
+    for (int i = 0; i < REGISTER_COUNT; i++) {
+        memcpy(value(values, i), REGISTERS[i].factory, CAMERA_SIM_MAX_VALUE);
+    }
+}
+
+void CameraSimulator::powerOn() {
+    _values = _saved;
+    _pending.clear();
+    _frameLength = 0;
+    _lastReplyEndUs = cameraMicros();
+    _anyAccepted = false;
+    _powerOnMs = cameraMillis();
+}
+
+bool CameraSimulator::initializing() const {
+    return _config.initTimeMs > 0 && cameraMillis() - _powerOnMs < _config.initTimeMs;
+}
+
+int CameraSimulator::findRegister(uint8_t cls, uint8_t subcls) const {
+    for (int i = 0; i < REGISTER_COUNT; i++) {
+        if (REGISTERS[i].cls == cls && REGISTERS[i].subcls == subcls) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool CameraSimulator::getRegister(uint8_t cls, uint8_t subcls, uint8_t* data, uint8_t& length) const {
+    int index = findRegister(cls, subcls);
+    if (index < 0) {
+        return false;
+    }
+    length = REGISTERS[index].length;
+    memcpy(data, &_values[index * CAMERA_SIM_MAX_VALUE], length);
+    return true;
+}
+
+bool CameraSimulator::setRegister(uint8_t cls, uint8_t subcls, const uint8_t* data, uint8_t length) {
+    int index = findRegister(cls, subcls);
+    if (index < 0 || length > CAMERA_SIM_MAX_VALUE) {
+        return false;
+    }
+    memcpy(value(_values, index), data, length);
+    return true;
+}
+
+// ============================================================================
+// TRANSPORTE
+// ============================================================================
+
+void CameraSimulator::onTx(HardwareSerial& port, const uint8_t* data, size_t length, void* context) {
+    (void)port;
+    static_cast<CameraSimulator*>(context)->receive(data, length);
+}
+
+void CameraSimulator::onRx(HardwareSerial& port, void* context) {
+    static_cast<CameraSimulator*>(context)->deliver(cameraMicros(), &port);
+}
+
+void CameraSimulator::attach(HardwareSerial& port) {
+    detach();
+    _port = &port;
+    port.setTxHandler(onTx, this);
+    port.setRxHandler(onRx, this);    powerOn();
+}
+
+void CameraSimulator::detach() {
+    if (_port) {
+        _port->setTxHandler(nullptr);
+        _port->setRxHandler(nullptr);
+        _port = nullptr;
+    }
+}
+
+bool CameraSimulator::openPty(char* name, size_t size) {
+    closePty();
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        if (master >= 0) {
+            close(master);
+        }
+        return false;
+    }
+    const char* slaveName = ptsname(master);
+    // Mantener abierto el esclavo: sin él, leer del maestro da EIO al desconectar el cliente
+    int slave = slaveName ? open(slaveName, O_RDWR | O_NOCTTY) : -1;
+    if (slave < 0) {
+        close(master);
+        return false;
+    }
+    struct termios tty;
+    if (tcgetattr(slave, &tty) == 0) {
+        cfmakeraw(&tty);
+        tcsetattr(slave, TCSANOW, &tty);
+    }
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    snprintf(name, size, "%s", slaveName);
+    _ptyMaster = master;
+    _ptySlave = slave;
+    powerOn();
+    return true;
+}
+
+void CameraSimulator::closePty() {
+    if (_ptyMaster >= 0) {
+        close(_ptyMaster);
+        close(_ptySlave);
+        _ptyMaster = -1;
+        _ptySlave = -1;
+    }
+}
+
+void CameraSimulator::poll() {
+    if (_ptyMaster < 0) {
+        return;
+    }
+    uint8_t buffer[256];
+    ssize_t count;
+    while ((count = read(_ptyMaster, buffer, sizeof(buffer))) > 0) {
+        receive(buffer, (size_t)count);
+    }
+    deliver(cameraMicros(), nullptr);
+}
+
+/**
+ * Entrega los bytes cuyo instante ya pasó: al puerto en memoria o al pty.
+ * @return Bytes entregados.
+ */
+size_t CameraSimulator::deliver(uint32_t nowUs, HardwareSerial* port) {
+    uint8_t buffer[64];
+    size_t total = 0;
+    while (!_pending.empty() && (int32_t)(nowUs - _pending.at(0).dueUs) >= 0) {
+        size_t n = 0;
+        Pending byte;
+        while (n < sizeof(buffer) && !_pending.empty() && (int32_t)(nowUs - _pending.at(0).dueUs) >= 0) {
+            _pending.pop(byte);
+            buffer[n++] = byte.value;
+        }
+        if (port) {
+            port->inject(buffer, n);
+        } else if (_ptyMaster >= 0 && write(_ptyMaster, buffer, n) < 0 && errno != EAGAIN) {
+            break;
+        }
+        total += n;
+    }
+    return total;
+}
+
+// ============================================================================
+// PROTOCOLO
+// ============================================================================
+
+void CameraSimulator::receive(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+        if (_frameLength == 0 && byte != HEADER_BYTE) {
+            continue; // basura entre tramas
+        }
+        if (_frameLength >= sizeof(_frame)) {
+            // Demasiado larga sin checksum válido: resincronizar en el siguiente 0xF0
+            _counters.badFrames++;
+            size_t next = 1;
+            while (next < _frameLength && _frame[next] != HEADER_BYTE) {
+                next++;
+            }
+            _frameLength -= next;
+            memmove(_frame, _frame + next, _frameLength);
+        }
+        _frame[_frameLength++] = byte;
+
+        // Fin de trama: 0xFF con checksum correcto (los datos pueden contener 0xFF)
+        if (byte == FOOTER_BYTE && _frameLength >= 8) {
+            uint8_t sum = 0;
+            for (size_t j = 2; j < _frameLength - 2; j++) {
+                sum += _frame[j];
+            }
+            if (sum == _frame[_frameLength - 2]) {
+                handleFrame(_frame, _frameLength);
+                _frameLength = 0;
+            }
+        }
+    }
+}
+
+bool CameraSimulator::acceptRate(uint32_t nowUs) {
+    if (_config.maxCommandsPerSec == 0) {
+        return true;
+    }
+    uint32_t interval = 1000000UL / _config.maxCommandsPerSec;
+    if (_anyAccepted && nowUs - _lastAcceptedUs < interval) {
+        return false;
+    }
+    _anyAccepted = true;
+    _lastAcceptedUs = nowUs;
+    return true;
+}
+
+void CameraSimulator::handleFrame(const uint8_t* frame, size_t length) {
+    uint8_t cls = frame[3];
+    uint8_t subcls = frame[4];
+    uint8_t flag = frame[5];
+    const uint8_t* data = &frame[6];
+    uint8_t dataLength = (uint8_t)(length - 8);
+
+    if (frame[2] != DEVICE_ADDR) {
+        _counters.badFrames++;
+        return;
+    }
+    _counters.frames++;
+
+    if (initializing()) {
+        // Durante el arranque solo contesta el estado: inicializando
+        if (cls == CLASS_CAMERA && subcls == 0x14 && flag == FLAG_READ) {
+            uint8_t status = CAMERA_INITIALIZING;
+            reply(cls, subcls, FLAG_READ, &status, 1);
+        } else {
+            _counters.initIgnored++;
+        }
+        return;
+    }
+    if (!acceptRate(cameraMicros())) {
+        _counters.rateLimited++;
+        return;
+    }
+
+    int index = findRegister(cls, subcls);
+    const SimRegisterDef* reg = (index >= 0) ? &REGISTERS[index] : nullptr;
+
+    if (flag == FLAG_READ) {
+        _counters.reads++;
+        if (!reg || !(reg->access & SIM_READ)) {
+            replyError(cls, subcls, SIM_ERR_NO_COMMAND);
+            return;
+        }
+        reply(cls, subcls, FLAG_READ, value(_values, index), reg->length);
+        return;
+    }
+
+    _counters.writes++;
+    if (flag != FLAG_WRITE || !reg || !(reg->access & (SIM_WRITE | SIM_ACTION))) {
+        if (_config.ackWrites) {
+            replyError(cls, subcls, SIM_ERR_NO_COMMAND);
+        }
+        return;
+    }
+
+    if (reg->access & SIM_ACTION) {
+        if (cls == CLASS_INFO && subcls == 0x0F) {
+            loadFactory(_values);   // la restauración también queda guardada
+            _saved = _values;
+        } else if (cls == CLASS_INFO && subcls == 0x10) {
+            _saved = _values;
+        }
+    } else {
+        if (dataLength != reg->length ||
+            (reg->length == 1 && (data[0] < reg->minValue || data[0] > reg->maxValue))) {
+            if (_config.ackWrites) {
+                replyError(cls, subcls, SIM_ERR_OUT_OF_RANGE);
+            }
+            return;
+        }
+        memcpy(value(_values, index), data, dataLength);
+    }
+
+    if (_config.ackWrites) {
+        reply(cls, subcls, FLAG_WRITE, data, dataLength);
+    }
+}
+
+void CameraSimulator::replyError(uint8_t cls, uint8_t subcls, uint8_t code) {
+    _counters.errors++;
+    reply(cls, subcls, FLAG_ERROR, &code, 1);
+}
+
+bool CameraSimulator::chance(float rate) {
+    if (rate <= 0.0f) {
+        return false;
+    }
+    return std::uniform_real_distribution<float>(0.0f, 1.0f)(_random) < rate;
+}
+
+/**
+ * Encola una respuesta F0 SIZE 36 CLS SUB FLAG LEN DATA CHK FF con su horario de entrega.
+ * Con flag 0x04 el byte de longitud es el código de error (resp[6]).
+ */
+void CameraSimulator::reply(uint8_t cls, uint8_t subcls, uint8_t flag, const uint8_t* data, uint8_t length) {
+    uint8_t frame[CAMERA_SIM_MAX_VALUE + 9];
+    size_t n = 0;
+    frame[n++] = HEADER_BYTE;
+    frame[n++] = (uint8_t)(5 + length);
+    frame[n++] = DEVICE_ADDR;
+    frame[n++] = cls;
+    frame[n++] = subcls;
+    frame[n++] = flag;
+    if (flag == FLAG_ERROR) {
+        frame[n++] = data[0];
+    } else {
+        frame[n++] = length;
+        memcpy(&frame[n], data, length);
+        n += length;
+    }
+    uint8_t sum = 0;
+    for (size_t i = 2; i < n; i++) {
+        sum += frame[i];
+    }
+    if (chance(_config.corruptChecksumRate)) {
+        sum ^= 0x5A;
+        _counters.corrupted++;
+    }
+    frame[n++] = sum;
+    frame[n++] = FOOTER_BYTE;
+    _counters.replies++;
+
+    // Las respuestas salen en orden: una no empieza antes de que termine la anterior
+    uint32_t start = cameraMicros() + _config.latencyUs;
+    if (_config.jitterUs > 0) {
+        start += std::uniform_int_distribution<uint32_t>(0, _config.jitterUs)(_random);
+    }
+    if ((int32_t)(_lastReplyEndUs - start) > 0) {
+        start = _lastReplyEndUs;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (chance(_config.dropByteRate)) {
+            _counters.droppedBytes++;
+            continue;
+        }
+        Pending byte;
+        byte.dueUs = start + (uint32_t)i * _config.byteTimeUs;
+        byte.value = frame[i];
+        if (!_pending.push(byte)) {
+            _counters.droppedBytes++;
+        }
+    }
+    _lastReplyEndUs = start + (uint32_t)n * _config.byteTimeUs;
+}
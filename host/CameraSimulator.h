@@ -0,0 +1,158 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraSimulator.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Software JS-MINI256-9 for the native build
+Docs:
+    Recibe las tramas F0 ... FF de buildCommand(), guarda el estado de los
+    registros de las clases 0x74/0x78/0x7C/0x70 y contesta las lecturas con
+    el formato que espera el controlador:
+        F0 SIZE 36 CLS SUB FLAG LEN DATA[LEN] CHK FF
+    Fallos configurables: latencia y jitter, límite de comandos por segundo,
+    bytes perdidos, checksums corruptos y fase de inicialización.
+
+    En memoria:  simulator.attach(cameraSerial);
+    Por pty:     simulator.openPty(name, sizeof(name)); ... simulator.poll();
+                 y en el otro extremo cameraSerial.openDevice(name).
+*/
+
+#ifndef CAMERA_SIMULATOR_H
+#define CAMERA_SIMULATOR_H
+
+#include <Arduino.h>
+#include "StaticRing.h"
+#include <random>
+#include <vector>
+
+// Registros simulados
+#define CAMERA_SIM_MAX_VALUE 16
+
+// Bytes de respuesta en vuelo (potencia de dos)
+#ifndef CAMERA_SIM_PENDING_SIZE
+#define CAMERA_SIM_PENDING_SIZE 4096
+#endif
+
+struct CameraSimConfig {
+    uint32_t latencyUs;         // desde la trama completa hasta el primer byte
+    uint32_t jitterUs;          // retardo extra aleatorio en [0, jitterUs]
+    uint32_t byteTimeUs;        // tiempo por byte (87 µs a 115200 8N1)
+    uint16_t maxCommandsPerSec; // 0 = sin límite; el exceso se ignora
+    float dropByteRate;         // probabilidad de perder cada byte de respuesta
+    float corruptChecksumRate;  // probabilidad de corromper el checksum
+    uint32_t initTimeMs;        // fase de init: solo contesta el estado (0x00)
+    bool ackWrites;             // contestar también escrituras y acciones
+    uint32_t seed;
+
+    CameraSimConfig()
+        : latencyUs(2000), jitterUs(0), byteTimeUs(87), maxCommandsPerSec(0),
+          dropByteRate(0.0f), corruptChecksumRate(0.0f), initTimeMs(0),
+          ackWrites(false), seed(1) {}
+};
+
+struct CameraSimCounters {
+    uint32_t frames;        // tramas válidas recibidas
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t replies;
+    uint32_t errors;        // respuestas con flag 0x04
+    uint32_t badFrames;     // checksum o formato incorrecto
+    uint32_t rateLimited;   // ignoradas por el límite de comandos
+    uint32_t initIgnored;   // ignoradas durante la inicialización
+    uint32_t droppedBytes;  // perdidos a propósito o por cola llena
+    uint32_t corrupted;
+};
+
+class CameraSimulator {
+public:
+    explicit CameraSimulator(const CameraSimConfig& config = CameraSimConfig());
+    ~CameraSimulator();
+
+    /**
+     * Conecta el simulador a un puerto en memoria (handlers TX y RX) y lo
+     * enciende (powerOn()).
+     */
+    void attach(HardwareSerial& port);
+    void detach();
+
+    /**
+     * Crea un pty y enciende el simulador; el controlador se conecta con
+     * HardwareSerial::openDevice().
+     * @param name Buffer para la ruta del extremo esclavo (/dev/pts/N).
+     * @return false si no se pudo crear.
+     */
+    bool openPty(char* name, size_t size);
+    void closePty();
+
+    /**
+     * Modo pty: lee lo recibido y escribe los bytes ya vencidos.
+     * Llamar periódicamente (bucle propio o hilo).
+     */
+    void poll();
+
+    /**
+     * Bytes enviados por el controlador (puede ser cualquier trozo de trama).
+     */
+    void receive(const uint8_t* data, size_t length);
+
+    /**
+     * Reinicia: registros guardados, cola vacía y nueva fase de inicialización.
+     */
+    void powerOn();
+
+    bool initializing() const;
+    size_t pendingBytes() const { return _pending.size(); }
+
+    /**
+     * Lee o escribe un registro directamente (sin pasar por el protocolo).
+     * @return false si cls/subcls no es un registro simulado.
+     */
+    bool getRegister(uint8_t cls, uint8_t subcls, uint8_t* data, uint8_t& length) const;
+    bool setRegister(uint8_t cls, uint8_t subcls, const uint8_t* data, uint8_t length);
+
+    void setConfig(const CameraSimConfig& config);
+    const CameraSimConfig& config() const { return _config; }
+    const CameraSimCounters& counters() const { return _counters; }
+    void resetCounters();
+
+private:
+    struct Pending {
+        uint32_t dueUs;
+        uint8_t value;
+    };
+
+    static void onTx(HardwareSerial& port, const uint8_t* data, size_t length, void* context);
+    static void onRx(HardwareSerial& port, void* context);
+
+    void handleFrame(const uint8_t* frame, size_t length);
+    void reply(uint8_t cls, uint8_t subcls, uint8_t flag, const uint8_t* data, uint8_t length);
+    void replyError(uint8_t cls, uint8_t subcls, uint8_t code);
+    bool acceptRate(uint32_t nowUs);
+    int findRegister(uint8_t cls, uint8_t subcls) const;
+    uint8_t* value(std::vector<uint8_t>& values, int index) { return &values[index * CAMERA_SIM_MAX_VALUE]; }
+    void loadFactory(std::vector<uint8_t>& values);
+    size_t deliver(uint32_t nowUs, HardwareSerial* port);
+    bool chance(float rate);
+
+    CameraSimConfig _config;
+    CameraSimCounters _counters;
+    std::mt19937 _random;
+    HardwareSerial* _port;
+    int _ptyMaster;
+    int _ptySlave;
+
+    uint8_t _frame[32];
+    size_t _frameLength;
+    StaticRing<Pending, CAMERA_SIM_PENDING_SIZE> _pending;
+    uint32_t _lastReplyEndUs;
+    uint32_t _lastAcceptedUs;
+    bool _anyAccepted;
+    unsigned long _powerOnMs;
+
+    std::vector<uint8_t> _values;   // estado actual, CAMERA_SIM_MAX_VALUE bytes por registro
+    std::vector<uint8_t> _saved;    // configuración guardada (0x74/0x10), se carga en powerOn()
+};
+
+#endif
@@ -0,0 +1,111 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+HardwareSerial.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: In-memory HardwareSerial for the native build
+Docs:
+    Serial (UART 0) escribe en stdout y lee de stdin sin bloquear.
+    Cualquier otra UART es un transporte en memoria: lo que escribe el
+    controlador queda en tx() (o va al handler de setTxHandler) y lo que
+    se inyecta con inject() es lo que el controlador lee. El handler de
+    setRxHandler se llama antes de cada lectura, para entregar bytes con
+    retardo. Con openDevice() el puerto usa un tty real (o un pty).
+
+        HardwareSerial cameraSerial(2);
+        cameraSerial.setTxHandler(onFrame, &simulator);
+        cameraSerial.inject(reply, sizeof(reply));
+*/
+
+#ifndef HARDWARE_SERIAL_HOST_SHIM_H
+#define HARDWARE_SERIAL_HOST_SHIM_H
+
+#include "Arduino.h"
+#include "StaticRing.h"
+#include <vector>
+
+#define SERIAL_8N1 0x800001c
+
+// Cola de recepción fija, como el buffer del driver UART (lo que no cabe se pierde)
+#ifndef HOST_SERIAL_RX_SIZE
+#define HOST_SERIAL_RX_SIZE 4096
+#endif
+
+class HardwareSerial;
+
+/**
+ * Recibe cada bloque escrito en el puerto (una llamada por write()).
+ * @param port Puerto que escribe; se puede responder con port.inject().
+ */
+typedef void (*HostTxHandler)(HardwareSerial& port, const uint8_t* data, size_t length, void* context);
+
+/**
+ * Se llama antes de cada available()/read()/peek(): momento para inyectar
+ * los bytes que ya "han llegado".
+ */
+typedef void (*HostRxHandler)(HardwareSerial& port, void* context);
+
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(int uart = 0);
+    ~HardwareSerial();
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1);
+    void end();
+    operator bool() const { return true; }
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    // --- Lado del dispositivo (transporte en memoria) ---
+
+    /**
+     * Añade bytes a la cola de recepción, como si llegaran por el cable.
+     * Si la cola está llena el resto se descarta (rxOverflows()).
+     */
+    void inject(const uint8_t* data, size_t length);
+
+    /**
+     * Envía lo escrito a un handler en lugar de acumularlo en tx().
+     * @param handler Función llamada en cada write(); nullptr para acumular.
+     * @param context Puntero pasado al handler.
+     */
+    void setTxHandler(HostTxHandler handler, void* context = nullptr);
+    void setRxHandler(HostRxHandler handler, void* context = nullptr);
+
+    /**
+     * Usa un dispositivo serie (p. ej. /dev/ttyUSB0 o el pty de un simulador)
+     * en modo raw y no bloqueante. begin() aplica el baudrate.
+     * @return false si no se pudo abrir.
+     */
+    bool openDevice(const char* path);
+
+    std::vector<uint8_t>& tx() { return _tx; }
+    void clear() { _rx.clear(); _tx.clear(); }
+    uint32_t rxOverflows() const { return _rxOverflows; }
+    unsigned long baudRate() const { return _baud; }
+
+private:
+    void pollInput();
+
+    int _uart;
+    unsigned long _baud;
+    StaticRing<uint8_t, HOST_SERIAL_RX_SIZE> _rx;
+    uint32_t _rxOverflows;
+    std::vector<uint8_t> _tx;
+    HostTxHandler _txHandler;
+    void* _txContext;
+    HostRxHandler _rxHandler;
+    void* _rxContext;
+    int _fd;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,24 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+main.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Native entry point: runs the sketch's setup() and loop()
+*/
+
+#include "Arduino.h"
+
+void setup();
+void loop();
+
+int main(int argc, char** argv) {
+    hostArgc = argc;
+    hostArgv = argv;
+    setup();
+    for (;;) {
+        loop();
+    }
+    return 0;
+}
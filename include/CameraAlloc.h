@@ -0,0 +1,91 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraAlloc.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Heap allocation tracking hook and per-call report
+Docs:
+    Con -D CAMERA_TRACK_ALLOCATIONS=1 y los wraps del enlazador
+        -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc -Wl,--wrap=free
+    cada reserva se cuenta (número y bytes). En el host también se reemplaza
+    operator new para contar las reservas de std::string.
+    CameraAllocReport mide una llamada cualquiera:
+        report.measure("getModel()", [&]() { camera.getModel(); });
+*/
+
+#ifndef CAMERA_ALLOC_H
+#define CAMERA_ALLOC_H
+
+#include <Arduino.h>
+
+// Contadores de heap (requiere los flags -Wl,--wrap)
+#ifndef CAMERA_TRACK_ALLOCATIONS
+#define CAMERA_TRACK_ALLOCATIONS 0
+#endif
+
+// Entradas del informe por llamada
+#ifndef CAMERA_ALLOC_REPORT_SIZE
+#define CAMERA_ALLOC_REPORT_SIZE 96
+#endif
+
+struct CameraAllocSnapshot {
+    uint32_t allocs;    // malloc + calloc + realloc
+    uint32_t frees;
+    uint32_t bytes;     // bytes pedidos
+};
+
+/**
+ * @return Contadores acumulados desde el arranque (todo a 0 sin CAMERA_TRACK_ALLOCATIONS).
+ */
+CameraAllocSnapshot cameraAllocSnapshot();
+
+struct CameraAllocEntry {
+    const char* name;
+    uint32_t calls;
+    uint32_t allocs;
+    uint32_t bytes;
+    uint32_t maxAllocs;     // peor llamada
+};
+
+class CameraAllocReport {
+public:
+    CameraAllocReport();
+
+    /**
+     * Ejecuta fn y acumula sus reservas bajo name.
+     * @param name Nombre de la llamada (literal: no se copia).
+     * @param fn Función o lambda a medir.
+     */
+    template <typename F>
+    void measure(const char* name, F fn) {
+        CameraAllocSnapshot before = cameraAllocSnapshot();
+        fn();
+        CameraAllocSnapshot after = cameraAllocSnapshot();
+        add(name, after.allocs - before.allocs, after.bytes - before.bytes);
+    }
+
+    void add(const char* name, uint32_t allocs, uint32_t bytes);
+
+    size_t size() const { return _count; }
+    const CameraAllocEntry& at(size_t index) const { return _entries[index]; }
+
+    /**
+     * @return Llamadas que reservaron heap al menos una vez.
+     */
+    size_t allocatingCalls() const;
+
+    /**
+     * Imprime el informe en CSV: method,calls,allocs,bytes,allocs_per_call,max_allocs
+     */
+    void printCsv(Print& out) const;
+
+    void reset() { _count = 0; }
+
+private:
+    CameraAllocEntry _entries[CAMERA_ALLOC_REPORT_SIZE];
+    size_t _count;
+};
+
+#endif
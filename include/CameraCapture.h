@@ -0,0 +1,120 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraCapture.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Binary UART traffic capture ring for ThermalCameraController
+Docs:
+    Cada registro ocupa 5 bytes de cabecera más los datos:
+        [timestamp µs, uint32 little-endian][dir:1 bit | longitud:7 bits][bytes...]
+    dir = 0 TX (ESP32 -> cámara), 1 RX (cámara -> ESP32). Los bloques de más de
+    127 bytes se dividen en varios registros. Al llenarse se descartan los
+    registros más antiguos; con "freeze on error" la captura se detiene en el
+    primer error para conservar la conversación que lo precede.
+*/
+
+#ifndef CAMERA_CAPTURE_H
+#define CAMERA_CAPTURE_H
+
+#include <Arduino.h>
+#include "CameraConfig.h"
+
+// Captura de tráfico (0 la elimina del binario)
+#ifndef CAMERA_ENABLE_CAPTURE
+#define CAMERA_ENABLE_CAPTURE 1
+#endif
+
+// Bytes del anillo de captura
+#ifndef CAMERA_CAPTURE_SIZE
+#define CAMERA_CAPTURE_SIZE 1024
+#endif
+
+#define CAPTURE_HEADER_SIZE 5
+#define CAPTURE_MAX_CHUNK 127
+#define CAPTURE_DIR_RX 0x80
+
+static_assert(CAMERA_CAPTURE_SIZE >= 256 && (CAMERA_CAPTURE_SIZE & (CAMERA_CAPTURE_SIZE - 1)) == 0,
+              "CAMERA_CAPTURE_SIZE must be a power of two >= 256");
+
+enum CaptureDirection : uint8_t {
+    CAPTURE_TX = 0,
+    CAPTURE_RX = 1
+};
+
+struct CaptureRecord {
+    uint32_t timestamp;
+    CaptureDirection direction;
+    uint8_t length;
+    uint8_t data[CAPTURE_MAX_CHUNK];
+};
+
+/**
+ * Decodifica un registro del formato binario de captura.
+ * @param buffer Datos exportados con CameraCapture::exportTo().
+ * @param size Bytes disponibles en buffer.
+ * @param record Registro decodificado.
+ * @return Bytes consumidos, 0 si el buffer no contiene un registro completo.
+ */
+size_t captureDecodeRecord(const uint8_t* buffer, size_t size, CaptureRecord& record);
+
+#if CAMERA_ENABLE_CAPTURE
+
+class CameraCapture {
+public:
+    CameraCapture();
+
+    /**
+     * Añade un bloque de tráfico. Coste: cabecera de 5 bytes + memcpy del bloque.
+     */
+    void record(CaptureDirection direction, const uint8_t* data, size_t length);
+
+    void setEnabled(bool enable) { _enabled = enable; }
+    bool enabled() const { return _enabled; }
+
+    /**
+     * Con freezeOnError la captura se congela en el siguiente trigger().
+     */
+    void setFreezeOnError(bool freeze) { _freezeOnError = freeze; }
+    void trigger();
+    void freeze() { _frozen = true; }
+    void resume() { _frozen = false; }
+    bool frozen() const { return _frozen; }
+
+    size_t used() const { return _used; }
+    uint32_t records() const { return _records; }
+    uint32_t dropped() const { return _dropped; }
+
+    /**
+     * Copia los registros, del más antiguo al más reciente, en formato binario.
+     * @return Bytes copiados (solo registros completos).
+     */
+    size_t exportTo(uint8_t* out, size_t size) const;
+
+    /**
+     * Imprime todos los registros como texto: "@<µs> TX|RX <hex>".
+     * @return Número de registros impresos.
+     */
+    size_t dump(Print& out) const;
+
+    void clear();
+
+private:
+    uint8_t byteAt(size_t offset) const { return _buffer[(_start + offset) & (CAMERA_CAPTURE_SIZE - 1)]; }
+    void dropOldest();
+    void put(uint8_t value);
+
+    uint8_t _buffer[CAMERA_CAPTURE_SIZE];
+    size_t _start;
+    size_t _used;
+    uint32_t _records;
+    uint32_t _dropped;
+    bool _enabled;
+    bool _freezeOnError;
+    bool _frozen;
+};
+
+#endif
+
+#endif
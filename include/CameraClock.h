@@ -0,0 +1,98 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraClock.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Injectable clock for timeouts, delays and timestamps
+Docs:
+    Todo el código de la librería mide el tiempo con cameraMillis(),
+    cameraMicros() y cameraDelay(). Por defecto son millis()/micros()/delay();
+    con cameraSetClock() se sustituyen, p. ej. por un reloj virtual que
+    avanza al instante en cada espera:
+
+        CameraVirtualClock clock;
+        cameraSetClock(&clock);
+        camera.getBrightness();   // un timeout de 150 ms no tarda 150 ms
+        cameraSetClock(nullptr);  // volver al reloj real
+
+    El reloj activo y el tiempo del reloj virtual son atómicos: CameraTask
+    los lee desde su hilo mientras la aplicación avanza el reloj o lo cambia.
+*/
+
+#ifndef CAMERA_CLOCK_H
+#define CAMERA_CLOCK_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Reloj sustituible (0: llamadas directas a millis()/micros()/delay())
+#ifndef CAMERA_INJECTABLE_CLOCK
+#define CAMERA_INJECTABLE_CLOCK 1
+#endif
+
+class CameraClock {
+public:
+    virtual ~CameraClock() {}
+    virtual uint32_t millis() = 0;
+    virtual uint32_t micros() = 0;
+    virtual void delay(uint32_t ms) = 0;
+};
+
+/**
+ * Reloj virtual: el tiempo solo avanza con delay() o advance(), sin esperar.
+ */
+class CameraVirtualClock : public CameraClock {
+public:
+    explicit CameraVirtualClock(uint64_t startUs = 0) : _nowUs(startUs) {}
+
+    uint32_t millis() override { return (uint32_t)(nowUs() / 1000); }
+    uint32_t micros() override { return (uint32_t)nowUs(); }
+    void delay(uint32_t ms) override { _nowUs.fetch_add((uint64_t)ms * 1000, std::memory_order_relaxed); }
+
+    void advance(uint32_t us) { _nowUs.fetch_add(us, std::memory_order_relaxed); }
+    uint64_t nowUs() const { return _nowUs.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> _nowUs;
+};
+
+#if CAMERA_INJECTABLE_CLOCK
+
+extern std::atomic<CameraClock*> cameraActiveClock;
+
+/**
+ * Sustituye el reloj de la librería.
+ * @param clock Reloj a usar; nullptr vuelve a millis()/micros()/delay().
+ *        Debe seguir vivo mientras otra tarea pueda estar usándolo.
+ */
+inline void cameraSetClock(CameraClock* clock) { cameraActiveClock.store(clock, std::memory_order_release); }
+inline CameraClock* cameraGetClock() { return cameraActiveClock.load(std::memory_order_acquire); }
+
+inline uint32_t cameraMillis() {
+    CameraClock* clock = cameraGetClock();
+    return clock ? clock->millis() : (uint32_t)millis();
+}
+inline uint32_t cameraMicros() {
+    CameraClock* clock = cameraGetClock();
+    return clock ? clock->micros() : (uint32_t)micros();
+}
+inline void cameraDelay(uint32_t ms) {
+    CameraClock* clock = cameraGetClock();
+    if (clock) {
+        clock->delay(ms);
+    } else {
+        delay(ms);
+    }
+}
+
+#else
+
+inline uint32_t cameraMillis() { return millis(); }
+inline uint32_t cameraMicros() { return micros(); }
+inline void cameraDelay(uint32_t ms) { delay(ms); }
+
+#endif
+
+#endif
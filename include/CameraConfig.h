@@ -0,0 +1,78 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraConfig.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Compile-time configuration for ThermalCameraController buffers
+Docs:
+    Todos los tamaños se pueden sobrescribir desde build_flags, por ejemplo:
+        -D CAMERA_STATIC_ALLOCATION=1
+        -D CAMERA_RESPONSE_SIZE=24
+*/
+
+#ifndef CAMERA_CONFIG_H
+#define CAMERA_CONFIG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Modo de asignación estática: ninguna reserva de heap después de begin()
+#ifndef CAMERA_STATIC_ALLOCATION
+#define CAMERA_STATIC_ALLOCATION 0
+#endif
+
+// Tamaño del buffer de respuesta (las respuestas reales ocupan ~12 bytes)
+#ifndef CAMERA_RESPONSE_SIZE
+#if CAMERA_STATIC_ALLOCATION
+#define CAMERA_RESPONSE_SIZE 32
+#else
+#define CAMERA_RESPONSE_SIZE 256
+#endif
+#endif
+
+// Profundidad de la cola de comandos
+#ifndef CAMERA_QUEUE_DEPTH
+#define CAMERA_QUEUE_DEPTH 8
+#endif
+
+// Número de registros del anillo de log
+#ifndef CAMERA_LOG_RING_SIZE
+#define CAMERA_LOG_RING_SIZE 32
+#endif
+
+// Buffer de texto para la interpretación de respuestas
+#ifndef CAMERA_TEXT_SIZE
+#define CAMERA_TEXT_SIZE 96
+#endif
+
+// Campos de texto de CameraInfo en modo estático (el modelo: los 24 bytes de CameraInfoPacked y '\0')
+#ifndef CAMERA_MODEL_SIZE
+#define CAMERA_MODEL_SIZE 25
+#endif
+
+#ifndef CAMERA_VERSION_TEXT_SIZE
+#define CAMERA_VERSION_TEXT_SIZE 16
+#endif
+
+// Capas opcionales: 0 las elimina por completo del binario (build headless)
+#ifndef CAMERA_ENABLE_INTERPRETATION
+#define CAMERA_ENABLE_INTERPRETATION 1
+#endif
+
+#ifndef CAMERA_ENABLE_MENU
+#define CAMERA_ENABLE_MENU 1
+#endif
+
+#ifndef CAMERA_ENABLE_DEBUG_DUMPS
+#define CAMERA_ENABLE_DEBUG_DUMPS 1
+#endif
+
+static_assert(CAMERA_RESPONSE_SIZE >= 16, "CAMERA_RESPONSE_SIZE must hold a full frame");
+static_assert(CAMERA_QUEUE_DEPTH > 0 && (CAMERA_QUEUE_DEPTH & (CAMERA_QUEUE_DEPTH - 1)) == 0,
+              "CAMERA_QUEUE_DEPTH must be a power of two");
+static_assert(CAMERA_LOG_RING_SIZE > 0 && (CAMERA_LOG_RING_SIZE & (CAMERA_LOG_RING_SIZE - 1)) == 0,
+              "CAMERA_LOG_RING_SIZE must be a power of two");
+
+#endif
@@ -13,10 +13,19 @@ Desc: JS-MINI256-9 Thermal Camera Controller Class
 
 #include <Arduino.h>
 #include <HardwareSerial.h>
+#include <atomic>
+#include <type_traits>
+#include "CameraConfig.h"
+#include "CameraLog.h"
+#include "CameraStats.h"
+#include "CameraLink.h"
+#include "CameraCapture.h"
+#include "CameraTrace.h"
+#include "CameraProfiler.h"
 
 // Configuración de comunicación
 #define UART_BAUDRATE 115200
-#define MAX_RESPONSE_SIZE 256
+#define MAX_RESPONSE_SIZE CAMERA_RESPONSE_SIZE
 #define RESPONSE_TIMEOUT 150  // 150ms según especificaciones del fabricante
 #define BYTE_TIMEOUT 75       // 75ms entre bytes según especificaciones
 
@@ -73,6 +82,56 @@ enum MirrorMode {
     MIRROR_VERTICAL = 0x03
 };
 
+// Códigos de error compactos (sin heap en las rutas de error)
+enum CameraErrorCode : uint8_t {
+    CAMERA_OK = 0,
+    CAMERA_ERR_TIMEOUT,
+    CAMERA_ERR_BAD_CHECKSUM,
+    CAMERA_ERR_SHORT_FRAME,
+    CAMERA_ERR_OUT_OF_RANGE,
+    CAMERA_ERR_NOT_SUPPORTED,
+    CAMERA_ERR_BREAKER_OPEN,
+    CAMERA_ERR_NOT_INITIALIZED,
+    CAMERA_ERR_ABORTED,
+    CAMERA_ERR_COUNT
+};
+
+// Tabla código -> texto, indexada por CameraErrorCode
+constexpr const char* CAMERA_ERROR_TEXT[CAMERA_ERR_COUNT] = {
+    "OK",
+    "Response timeout",
+    "Bad checksum",
+    "Short frame",
+    "Value out of range",
+    "Command not supported",
+    "Link breaker open",
+    "Serial port not initialized",
+    "Response wait abandoned"
+};
+
+constexpr const char* cameraErrorText(CameraErrorCode code) {
+    return code < CAMERA_ERR_COUNT ? CAMERA_ERROR_TEXT[code] : "Unknown error";
+}
+
+// Resultado del último comando enviado
+struct CommandStatus {
+    uint8_t cls;
+    uint8_t subcls;
+    CameraErrorCode code;
+};
+
+#if CAMERA_STATIC_ALLOCATION
+struct CameraInfo {
+    char model[CAMERA_MODEL_SIZE];
+    char fpgaVersion[CAMERA_VERSION_TEXT_SIZE];
+    char fpgaBuildDate[CAMERA_VERSION_TEXT_SIZE];
+    char softwareVersion[CAMERA_VERSION_TEXT_SIZE];
+    char softwareBuildDate[CAMERA_VERSION_TEXT_SIZE];
+    char calibrationVersion[CAMERA_VERSION_TEXT_SIZE];
+    char ispVersion[CAMERA_VERSION_TEXT_SIZE];
+    CameraStatus status;
+};
+#else
 struct CameraInfo {
     String model;
     String fpgaVersion;
@@ -83,15 +142,72 @@ struct CameraInfo {
     String ispVersion;
     CameraStatus status;
 };
+#endif
+
+// Versión compacta de CameraInfo: POD de 48 bytes sin padding implícito.
+// Se puede copiar, guardar o enviar tal cual (little-endian) y comparar con memcmp;
+// el texto se genera solo bajo demanda con cameraFormatVersion/cameraFormatDate.
+struct CameraInfoPacked {
+    uint32_t fpgaBuildDate;         // AAAAMMDD
+    uint32_t softwareBuildDate;     // AAAAMMDD
+    uint8_t fpgaVersion[3];         // mayor, menor, parche
+    uint8_t softwareVersion[3];
+    uint8_t calibrationVersion[3];
+    uint8_t ispVersion[3];
+    char model[24];                 // rellenado con '\0'
+    uint8_t status;                 // CameraStatus
+    uint8_t reserved[3];            // siempre 0
+};
 
-struct Response {
-    uint8_t data[MAX_RESPONSE_SIZE];
+static_assert(sizeof(CameraInfoPacked) == 48, "CameraInfoPacked layout must not contain padding");
+static_assert(std::is_trivially_copyable<CameraInfoPacked>::value, "CameraInfoPacked must be POD");
+static_assert(CAMERA_MODEL_SIZE >= sizeof(CameraInfoPacked::model) + 1, "CAMERA_MODEL_SIZE must hold a packed model and its '\\0'");
+// "255.255.255" y "429496-72-95" (fecha AAAAMMDD de 32 bits) con su '\0'
+static_assert(CAMERA_VERSION_TEXT_SIZE >= 13, "CAMERA_VERSION_TEXT_SIZE must hold any formatted version or date");
+
+/**
+ * Compara dos CameraInfoPacked byte a byte.
+ * @return true si son idénticos.
+ */
+inline bool cameraInfoEquals(const CameraInfoPacked& a, const CameraInfoPacked& b) {
+    return memcmp(&a, &b, sizeof(CameraInfoPacked)) == 0;
+}
+
+/**
+ * Formatea una versión empaquetada como "mayor.menor.parche".
+ * @return Número de caracteres escritos.
+ */
+size_t cameraFormatVersion(char* out, size_t size, const uint8_t* version);
+
+/**
+ * Formatea una fecha AAAAMMDD como "AAAA-M-D" (mismo formato que CameraInfo).
+ * @return Número de caracteres escritos.
+ */
+size_t cameraFormatDate(char* out, size_t size, uint32_t date);
+
+/**
+ * Convierte la versión compacta a CameraInfo formateando todos los campos.
+ */
+void cameraUnpackInfo(const CameraInfoPacked& packed, CameraInfo& info);
+
+template <size_t Capacity>
+struct ResponseBuffer {
+    static constexpr size_t capacity = Capacity;
+    uint8_t data[Capacity];
     size_t length;
     unsigned long timestamp;
     bool complete;
     bool valid;
 };
 
+typedef ResponseBuffer<CAMERA_RESPONSE_SIZE> Response;
+
+#if CAMERA_STATIC_ALLOCATION
+// En modo estático el estado del controlador debe poder copiarse sin heap
+static_assert(std::is_trivially_copyable<Response>::value, "Response must not own heap memory");
+static_assert(std::is_trivially_copyable<CameraInfo>::value, "CameraInfo must not own heap memory");
+#endif
+
 class CameraController {
 private:
     HardwareSerial* _serial;
@@ -99,28 +215,87 @@ private:
     uint8_t _txPin;
     Response _currentResponse;
     bool _debugEnabled;
-    String _lastError;
+    std::atomic<bool> _logFlushedElsewhere;   // flushLog() es el consumidor del log
+    CameraErrorCode _lastError;
+    CommandStatus _lastStatus;
+    uint32_t _errorCounts[CAMERA_ERR_COUNT];
     unsigned long _responseTimeout;
     unsigned long _byteTimeout;
     unsigned long _lastByteTime;
+#if CAMERA_LOG_LEVEL > CAMERA_LOG_NONE
+    CameraLog _log;
+#endif
+#if CAMERA_ENABLE_STATS
+    CameraStats _stats;
+#endif
+    CameraLinkQuality _link;
+#if CAMERA_ENABLE_CAPTURE
+    CameraCapture _capture;
+#endif
+#if CAMERA_ENABLE_PROFILER
+    CameraProfiler _profiler;
+#endif
+    bool _awaitingAsync;
+    bool _abandoned;                // respuesta abandonada que aún puede llegar
+    unsigned long _abandonedUntil;
+    bool _pending;                  // lectura enviada esperando respuesta
+    bool _noWait;                   // transmit() no espera (startCommand)
+    unsigned long _waitStart;
+    unsigned long _waitTimeout;
+    bool (*_waitInterrupt)(void* context);
+    void* _waitInterruptContext;
+    uint32_t _txStartUs;
+    uint32_t _firstByteUs;
+    uint32_t _lastByteUs;
+    uint32_t _traceId;              // id de la petición para el próximo comando (0: propio)
+    uint32_t _traceSeq;
+    uint32_t _traceSpan;            // span "command" abierto
     
     // Funciones privadas de protocolo
-    uint8_t calculateChecksum(uint8_t device, uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t *data, uint8_t dataLen);
-    void buildCommand(uint8_t *cmdBuffer, uint8_t device, uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t *data, uint8_t dataLen);
     bool sendCommand(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t *data = nullptr, uint8_t dataLen = 0);
     bool commandExpectsResponse(uint8_t rw);
+    bool transmit(const uint8_t* frame, size_t len, bool expectResponse);
     void initializeResponse();
+    void drainAbandoned();
+    void startWait(unsigned long timeout);
     bool waitForResponse(unsigned long timeout = RESPONSE_TIMEOUT);
+    size_t interpretResponse(char* out, size_t size);
+#if !CAMERA_STATIC_ALLOCATION
     String interpretResponse();
+#endif
     void processResponseBytes();
-    
-    // Interpretación detallada de respuestas
-    String interpretInfoResponse(uint8_t subclass, const uint8_t* data, uint8_t dataLen, uint8_t rwFlag);
-    String interpretImageResponse(uint8_t subclass, const uint8_t* data, uint8_t dataLen, uint8_t rwFlag);
-    String interpretCameraResponse(uint8_t subclass, const uint8_t* data, uint8_t dataLen, uint8_t rwFlag);
-    String interpretMirrorResponse(uint8_t subclass, const uint8_t* data, uint8_t dataLen, uint8_t rwFlag);
+    size_t readAvailable();
+    void resyncResponse();
+    void splitResponse();
+    CameraErrorCode closeFrame();
+    CameraErrorCode finishResponse();
+    void dispatchResponse();
+    bool fail(CameraErrorCode code, uint8_t cls = 0, uint8_t subcls = 0);
+    bool failResponse(CameraErrorCode code);
+    void wireError(CameraErrorCode code, uint8_t cls, uint8_t subcls);
+    void asyncError(CameraErrorCode code);
+    void countError(CameraErrorCode code, uint8_t cls, uint8_t subcls);
+    bool readVersionText(uint8_t subcls, char* out, size_t size);
+    bool readDateText(uint8_t subcls, char* out, size_t size);
+    bool readVersionBytes(uint8_t subcls, uint8_t* version);
+    bool readDateValue(uint8_t subcls, uint32_t& date);
     
 public:
+    // Protocolo sin estado (también para benchmarks y herramientas del host)
+    static uint8_t calculateChecksum(uint8_t device, uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t *data, uint8_t dataLen);
+
+    /**
+     * Construye una trama F0 05 DEV CLS SUB RW DATA CHK FF.
+     * @param cmdBuffer Destino de al menos 8 + dataLen bytes.
+     */
+    static void buildCommand(uint8_t *cmdBuffer, uint8_t device, uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t *data, uint8_t dataLen);
+
+    /**
+     * Valida una trama de respuesta completa (marcas, checksum y flag de error).
+     * @return CAMERA_OK si la trama es válida, el código de error en caso contrario.
+     */
+    static CameraErrorCode validateFrame(const uint8_t* frame, size_t len);
+
     /**
      * Constructor de la clase CameraController.
      * @param serial Puerto serie para comunicación.
@@ -148,18 +323,182 @@ public:
      */
     void setTimeouts(unsigned long responseTimeout, unsigned long byteTimeout);
 
+    /**
+     * Permite abandonar la espera de una lectura cuando llega trabajo más
+     * urgente. Se consulta en cada vuelta de la espera mientras no haya
+     * llegado ningún byte; si devuelve true el comando termina con
+     * CAMERA_ERR_ABORTED y la respuesta tardía se descarta en update() o
+     * antes de la siguiente lectura.
+     * @param check Función a consultar (nullptr para desactivar).
+     * @param context Puntero que se pasa a check.
+     */
+    void setWaitInterrupt(bool (*check)(void* context), void* context);
+
+    /**
+     * Modo cooperativo: envía un comando sin esperar su respuesta. Las
+     * escrituras terminan aquí; las lecturas se completan con pollResponse().
+     * @return false si hay una lectura en curso, queda una respuesta
+     *         abandonada en vuelo o el comando falló al enviarse.
+     */
+    bool startCommand(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t* data = nullptr, uint8_t dataLen = 0);
+
+    /**
+     * Avanza sin bloquear la lectura iniciada con startCommand(): lee lo
+     * disponible y comprueba fin de trama, abandono y timeout.
+     * @param code Resultado cuando termina.
+     * @return true si terminó (o no había ninguna en curso).
+     */
+    bool pollResponse(CameraErrorCode& code);
+    bool responsePending() const { return _pending; }
+
+    /**
+     * Deja de esperar la lectura en curso (CAMERA_ERR_ABORTED); su respuesta
+     * tardía se descarta como la de una espera interrumpida.
+     */
+    void abandonResponse();
+
+    /**
+     * Id con el que se trazará el próximo comando (el de la petición de
+     * CameraTask), para que su span "command" se anide con su "queue".
+     * Sin llamarla cada comando usa un id propio.
+     */
+    void setTraceId(uint32_t id) { _traceId = id; }
+
+    /**
+     * @return true si se puede enviar una lectura sin esperar a la respuesta
+     *         tardía de una lectura abandonada.
+     */
+    bool readyForRead();
+
     /**
      * Procesa las respuestas asíncronas de la cámara.
      */
     void update(); // Procesar respuestas asíncronas
+
+    /**
+     * Formatea registros pendientes del log de depuración diferido.
+     * update() ya vacía CAMERA_LOG_FLUSH_PER_UPDATE registros por llamada cuando
+     * la depuración está activa; esta función permite vaciarlo desde otra tarea
+     * (la de baja prioridad que escribe en Serial). La cola admite un solo
+     * consumidor: desde la primera llamada update() deja de vaciarla.
+     * @param out Destino del texto.
+     * @param maxRecords Máximo de registros a formatear.
+     * @return Número de registros formateados (0 con CAMERA_LOG_LEVEL=0).
+     */
+    size_t flushLog(Print& out, size_t maxRecords = CAMERA_LOG_RING_SIZE);
+
+    /**
+     * @return Registros pendientes de formatear en el log.
+     */
+    size_t getLogPending() const;
+
+#if CAMERA_ENABLE_CAPTURE
+    /**
+     * Activa la captura binaria de tráfico UART (TX y RX con timestamps en µs).
+     * @param enable true para capturar.
+     * @param freezeOnError true para congelar la captura en el primer error del
+     *        enlace (trama inválida o timeout, también en respuestas asíncronas);
+     *        los argumentos fuera de rango no la congelan.
+     */
+    void enableCapture(bool enable = true, bool freezeOnError = true);
+
+    /**
+     * Imprime la captura como texto, una línea por bloque: "@<µs> TX|RX <hex>".
+     * @param out Destino (por ejemplo Serial).
+     * @return Número de registros impresos.
+     */
+    size_t dumpCapture(Print& out) const;
+
+    /**
+     * Reanuda una captura congelada y descarta su contenido.
+     */
+    void resetCapture();
+
+    /**
+     * @return Captura para exportar en binario (exportTo) o consultar su estado.
+     */
+    const CameraCapture& getCapture() const;
+#endif
+
+#if CAMERA_ENABLE_PROFILER
+    /**
+     * Perfilador del loop: tiempos de update(), comandos bloqueantes y entrada del menú,
+     * y stalls que superan el presupuesto con el comando responsable.
+     * @return Referencia al perfilador.
+     */
+    CameraProfiler& getProfiler();
+
+    /**
+     * Configura el presupuesto por llamada y el aviso de stalls.
+     * @param budgetUs Duración máxima aceptable en microsegundos (20000 por defecto).
+     * @param callback Función llamada en cada stall (nullptr para ninguna).
+     */
+    void setLoopBudget(uint32_t budgetUs, StallCallback callback = nullptr);
+#endif
+
+    /**
+     * Monitor de calidad del enlace: errores de trama, checksums, resincronizaciones,
+     * desbordes, tramas no solicitadas y timeouts.
+     * @return Referencia al monitor.
+     */
+    const CameraLinkQuality& getLinkQuality() const;
+
+    /**
+     * @return Puntuación del enlace (0-100) sobre las últimas 32 tramas.
+     */
+    uint8_t getLinkScore() const;
+
+    /**
+     * Suscribe un callback a los cruces del umbral de calidad.
+     * @param callback Función llamada al degradarse o recuperarse el enlace (nullptr para quitarla).
+     * @param threshold Puntuación mínima aceptable (0-100).
+     */
+    void setLinkQualityCallback(LinkQualityCallback callback, uint8_t threshold = 80);
+
+    /**
+     * Reinicia contadores y puntuación del enlace.
+     */
+    void resetLinkQuality();
+
+#if CAMERA_ENABLE_STATS
+    /**
+     * Estadísticas por comando: envíos, respuestas, timeouts, bytes y
+     * histogramas de latencia (envío -> primer byte, primer byte -> completo).
+     * @return Referencia a las estadísticas acumuladas.
+     */
+    const CameraStats& getStats() const;
+
+    /**
+     * Reinicia todas las estadísticas por comando.
+     */
+    void resetStats();
+#endif
     
     /**
      * Obtiene información completa del dispositivo.
      * @param info Estructura CameraInfo donde se almacenará la información.
-     * @return true si la operación fue exitosa, false en caso contrario.
+     * @return true si la operación fue exitosa, false si falló o el modelo no cabía
+     *         en info.model (CAMERA_MODEL_SIZE) y se ha cortado.
      */
     bool getDeviceInfo(CameraInfo& info);
 
+    /**
+     * Obtiene la información del dispositivo en formato compacto, sin formatear texto.
+     * Los campos que no se pudieron leer quedan a cero.
+     * @param info Estructura CameraInfoPacked (se pone a cero antes de leer).
+     * @return true si la operación fue exitosa, false en caso contrario.
+     */
+    bool getDeviceInfo(CameraInfoPacked& info);
+
+    /**
+     * Lee el modelo del dispositivo en un buffer del llamador (sin heap).
+     * @param buffer Destino terminado en '\0'.
+     * @param size Tamaño del buffer.
+     * @return true si la lectura fue exitosa, false en caso contrario.
+     */
+    bool getModel(char* buffer, size_t size);
+
+#if !CAMERA_STATIC_ALLOCATION
     /**
      * Obtiene el modelo del dispositivo.
      * @return Modelo del dispositivo como una cadena.
@@ -201,6 +540,7 @@ public:
      * @return Versión del ISP como una cadena.
      */
     String getISPVersion();
+#endif
 
     /**
      * Obtiene el estado actual de la cámara.
@@ -291,21 +631,65 @@ public:
     bool restoreFactory();
     
     // Comandos dinámicos
-    bool sendDynamicCommand(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t *data, uint8_t dataLen, String name = "");
-    bool sendRawCommand(const uint8_t *cmd, size_t len, String name = "");
+    bool sendDynamicCommand(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t *data, uint8_t dataLen, const char* name = nullptr);
+    bool sendRawCommand(const uint8_t *cmd, size_t len, const char* name = nullptr);
     
     // Funciones de utilidad
     bool isConnected();
+
+    /**
+     * Obtiene el código del último error (persistente hasta el siguiente error).
+     * @return Código de error, CAMERA_OK si nunca hubo errores.
+     */
+    CameraErrorCode getLastErrorCode() const;
+
+    /**
+     * Obtiene el texto del último error desde la tabla de códigos (sin heap).
+     * @return Texto constante del último error.
+     */
+    const char* getLastErrorText() const;
+
+    /**
+     * Obtiene el resultado del último comando (clase, subclase y código).
+     * @return Estado del último comando, CAMERA_OK si tuvo éxito.
+     */
+    CommandStatus getLastCommandStatus() const;
+
+    /**
+     * Copia los datos (DATA[LEN]) de la última respuesta válida.
+     * @param out Destino de los datos.
+     * @param size Tamaño del destino.
+     * @return Bytes copiados, 0 si el último comando no tuvo respuesta válida.
+     */
+    size_t getResponseData(uint8_t* out, size_t size) const;
+
+    /**
+     * Obtiene el número de veces que se produjo un código de error.
+     * @param code Código de error a consultar.
+     * @return Número de ocurrencias desde el último reset.
+     */
+    uint32_t getErrorCount(CameraErrorCode code) const;
+
+    /**
+     * Reinicia los contadores de errores.
+     */
+    void resetErrorCounts();
+#if !CAMERA_STATIC_ALLOCATION
     String getLastError();
+#endif
     
     // Callbacks - USAR FUNCIÓN GLOBAL ESTÁTICA
+    typedef void (*ResponseTextCallback)(const char* interpretation);
+    static void setGlobalResponseTextHandler(ResponseTextCallback callback);
+#if !CAMERA_STATIC_ALLOCATION
     typedef void (*ResponseCallback)(const String& interpretation);
     static void setGlobalResponseHandler(ResponseCallback callback);
+#endif
     
     // Constantes públicas
-    static const char* PALETTE_NAMES[];
-    static const char* SHUTTER_MODE_NAMES[];
-    static const char* MIRROR_MODE_NAMES[];
+    static const char* const PALETTE_NAMES[];
+    static const char* const SHUTTER_MODE_NAMES[];
+    static const char* const MIRROR_MODE_NAMES[];
     
     // Métodos para comandos de lectura
     bool readDeviceModel();
@@ -316,7 +700,10 @@ public:
     void testBuildAndSendCommand(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t* data, uint8_t dataLen);
 
 private:
+    static ResponseTextCallback _globalTextCallback;
+#if !CAMERA_STATIC_ALLOCATION
     static ResponseCallback _globalCallback;
+#endif
 };
 
 #endif
\ No newline at end of file
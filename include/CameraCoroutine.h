@@ -0,0 +1,212 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraCoroutine.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: C++20 coroutine API to sequence multi-step camera procedures
+Docs:
+    Con un compilador con corrutinas (C++20: host, toolchains ESP32 con
+    GCC >= 10 y -std=gnu++20) un procedimiento de varios pasos se escribe
+    de corrido y cada co_await cede el control en vez de bloquear:
+
+        CameraProcedure snapshot(CameraSequencer& seq) {
+            CameraEvent brightness = co_await seq.read(CLASS_IMAGE, 0x02);
+            if (brightness.code != CAMERA_OK) co_return brightness.code;
+            co_await seq.write(CLASS_IMAGE, 0x02, &value, 1);
+            co_await seq.delay(500);
+            co_return (co_await seq.write(CLASS_IMAGE, 0x02, brightness.data, 1)).code;
+        }
+
+        sequencer.start(snapshot(sequencer));
+        void loop() { sequencer.update(); ... }
+
+    Los comandos van por CameraTask (post/poll), así que varios
+    procedimientos se intercalan en un mismo núcleo y el loop nunca espera a
+    la cámara. Un procedimiento puede esperar a otro con co_await. El
+    secuenciador recoge todos los eventos de la tarea: los que no son de un
+    procedimiento se entregan al manejador de setEventHandler().
+
+    Los marcos de las corrutinas se reservan en el heap (uno por
+    procedimiento en curso); el resto es estático. Sin soporte de
+    corrutinas este archivo no declara nada.
+*/
+
+#ifndef CAMERA_COROUTINE_H
+#define CAMERA_COROUTINE_H
+
+#include <Arduino.h>
+#include "CameraTask.h"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#define CAMERA_HAS_COROUTINES 1
+#else
+#define CAMERA_HAS_COROUTINES 0
+#endif
+
+#if CAMERA_HAS_COROUTINES
+
+#include <coroutine>
+#include <exception>
+
+// Procedimientos raíz y esperas (comandos o retardos) simultáneos
+#ifndef CAMERA_CORO_PROCEDURES
+#define CAMERA_CORO_PROCEDURES 8
+#endif
+#ifndef CAMERA_CORO_WAITERS
+#define CAMERA_CORO_WAITERS 16
+#endif
+
+class CameraSequencer;
+
+/**
+ * Tipo de retorno de un procedimiento: co_return de un CameraErrorCode.
+ * Arranca suspendido; lo pone en marcha CameraSequencer::start() o un
+ * co_await desde otro procedimiento.
+ */
+class CameraProcedure {
+public:
+    struct promise_type {
+        CameraErrorCode result = CAMERA_OK;
+        std::coroutine_handle<> continuation;
+
+        CameraProcedure get_return_object() {
+            return CameraProcedure(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // Al terminar, continuar con quien lo esperaba (si lo hay)
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                std::coroutine_handle<> next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_value(CameraErrorCode code) { result = code; }
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    CameraProcedure() = default;
+    explicit CameraProcedure(Handle handle) : _handle(handle) {}
+    CameraProcedure(CameraProcedure&& other) noexcept : _handle(other._handle) { other._handle = nullptr; }
+    CameraProcedure& operator=(CameraProcedure&& other) noexcept;
+    CameraProcedure(const CameraProcedure&) = delete;
+    CameraProcedure& operator=(const CameraProcedure&) = delete;
+    ~CameraProcedure();
+
+    bool valid() const { return (bool)_handle; }
+    bool done() const { return !_handle || _handle.done(); }
+    CameraErrorCode result() const { return _handle ? _handle.promise().result : CAMERA_OK; }
+
+    // co_await de un procedimiento dentro de otro: lo ejecuta y devuelve su código
+    bool await_ready() const noexcept { return done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+        _handle.promise().continuation = caller;
+        return _handle;
+    }
+    CameraErrorCode await_resume() const noexcept { return result(); }
+
+private:
+    friend class CameraSequencer;
+    Handle release() {
+        Handle handle = _handle;
+        _handle = nullptr;
+        return handle;
+    }
+
+    Handle _handle;
+};
+
+/**
+ * Espera de un comando o de un retardo. Vive en el marco de la corrutina
+ * mientras está suspendida; el secuenciador solo guarda un puntero.
+ */
+class CameraAwaiter {
+public:
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle);
+    CameraEvent await_resume() const noexcept { return _event; }
+
+private:
+    friend class CameraSequencer;
+    CameraAwaiter(CameraSequencer& sequencer) : _sequencer(sequencer), _id(0), _wakeMs(0), _isDelay(false) {}
+
+    CameraSequencer& _sequencer;
+    CameraRequest _request;
+    CameraEvent _event;
+    std::coroutine_handle<> _handle;
+    uint32_t _id;           // 0: aún sin encolar (cola llena)
+    uint32_t _wakeMs;
+    bool _isDelay;
+};
+
+class CameraSequencer {
+public:
+    explicit CameraSequencer(CameraTask& io);
+    ~CameraSequencer();
+
+    /**
+     * Pone en marcha un procedimiento; corre hasta su primer co_await.
+     * @return false si ya hay CAMERA_CORO_PROCEDURES en curso.
+     */
+    bool start(CameraProcedure procedure);
+
+    /**
+     * Recoge los eventos de la tarea de E/S, reanuda los procedimientos que
+     * esperaban y vence los retardos. Llamar en cada vuelta del loop.
+     * @return Procedimientos raíz aún en curso.
+     */
+    size_t update();
+
+    /**
+     * Awaitables: co_await devuelve el CameraEvent del comando. Si la cola de
+     * comandos está llena el comando se reintenta en update().
+     */
+    CameraAwaiter read(uint8_t cls, uint8_t subcls, CameraPriority priority = CAMERA_PRIORITY_INTERACTIVE);
+    CameraAwaiter write(uint8_t cls, uint8_t subcls, const uint8_t* data = nullptr, uint8_t length = 0,
+                        CameraPriority priority = CAMERA_PRIORITY_INTERACTIVE);
+    CameraAwaiter command(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t* data, uint8_t length,
+                          CameraPriority priority);
+
+    /**
+     * Awaitable: suspende el procedimiento ms milisegundos sin bloquear.
+     */
+    CameraAwaiter delay(uint32_t ms);
+
+    size_t running() const { return _procedureCount; }
+
+    /**
+     * Eventos de la tarea que no pertenecen a ningún procedimiento (post()
+     * directos de la aplicación, postFromISR()).
+     */
+    void setEventHandler(void (*handler)(const CameraEvent& event)) { _eventHandler = handler; }
+
+    /**
+     * Se llama al terminar cada procedimiento raíz con su código.
+     */
+    void setFinishedHandler(void (*handler)(CameraErrorCode code)) { _finishedHandler = handler; }
+
+private:
+    friend class CameraAwaiter;
+    bool suspend(CameraAwaiter* awaiter);
+    void submit(CameraAwaiter* awaiter);
+    void reap();
+
+    CameraTask& _io;
+    CameraProcedure::Handle _procedures[CAMERA_CORO_PROCEDURES];
+    size_t _procedureCount;
+    CameraAwaiter* _waiters[CAMERA_CORO_WAITERS];
+    void (*_eventHandler)(const CameraEvent& event);
+    void (*_finishedHandler)(CameraErrorCode code);
+};
+
+#endif // CAMERA_HAS_COROUTINES
+
+#endif
@@ -0,0 +1,210 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraGroup.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Several cameras on their own UARTs, scheduled concurrently
+Docs:
+    Cada cámara tiene su controlador, su UART y su CameraTask. El grupo pone
+    las tareas en modo cooperativo y en update() avanza todas a la vez:
+    mientras una espera su respuesta las demás siguen enviando, así que
+    configurar N cámaras tarda lo mismo que configurar una.
+
+        CameraTask ioA(cameraA), ioB(cameraB);
+        group.add(ioA);
+        group.add(ioB);
+        group.begin();
+        group.setPaletteAll(PALETTE_IRON);        // a todas, sin bloquear
+        void loop() { group.update(); ... }
+
+    Las difusiones (setPaletteAll, applyAll, broadcast) forman un lote que
+    update() reparte a cada cámara según le cabe en su cola; waitBroadcast()
+    espera a que todas terminen. Un comando del lote que cede su turno a
+    otro urgente (CAMERA_ERR_ABORTED, p. ej. por un FFC) se repite. Los FFC (ffc, ffcAll, setFfcInterval) salen
+    de uno en uno separados por CAMERA_FFC_STAGGER_MS para que nunca se
+    congelen dos imágenes a la vez; conviene dejar el obturador automático
+    de las cámaras en SHUTTER_MANUAL. Todos los resultados llegan al
+    manejador de setEventHandler() con el índice de su cámara.
+
+    Una tarea ya en marcha en su propio núcleo (begin()) también vale: el
+    grupo solo recoge sus eventos.
+*/
+
+#ifndef CAMERA_GROUP_H
+#define CAMERA_GROUP_H
+
+#include <Arduino.h>
+#include "CameraTask.h"
+
+// Cámaras por grupo
+#ifndef CAMERA_GROUP_MAX
+#define CAMERA_GROUP_MAX 4
+#endif
+
+// Comandos por lote de difusión (como mucho 32: un bit por comando)
+#ifndef CAMERA_GROUP_BATCH
+#define CAMERA_GROUP_BATCH 16
+#endif
+static_assert(CAMERA_GROUP_BATCH > 0 && CAMERA_GROUP_BATCH <= 32, "CAMERA_GROUP_BATCH must be 1..32");
+
+// Separación mínima entre los FFC de dos cámaras
+#ifndef CAMERA_FFC_STAGGER_MS
+#define CAMERA_FFC_STAGGER_MS 1500
+#endif
+
+/**
+ * Un ajuste de un byte para applyAll() (brillo, contraste, paleta...).
+ */
+struct CameraSetting {
+    uint8_t cls;
+    uint8_t subcls;
+    uint8_t value;
+};
+
+struct CameraMemberStats {
+    uint32_t commands;          // resultados recogidos
+    uint32_t errors;            // distintos de OK y de CAMERA_ERR_ABORTED
+    uint32_t timeouts;
+    uint32_t ffcs;
+    uint32_t maxServiceUs;      // inicio -> resultado, el más lento
+    uint8_t linkScore;          // puntuación del enlace (0-100)
+};
+
+struct CameraGroupStats {
+    CameraMemberStats cameras[CAMERA_GROUP_MAX];
+    uint32_t commands;
+    uint32_t errors;
+    uint32_t ffcs;
+    uint32_t batches;           // lotes de difusión completados
+    uint32_t lastBatchUs;       // primer envío -> último resultado
+    uint32_t maxBatchUs;
+    uint32_t batchRetries;      // comandos del lote repetidos tras CAMERA_ERR_ABORTED
+    uint32_t minFfcGapUs;       // menor separación observada entre FFC de cámaras distintas
+    uint8_t minLinkScore;
+};
+
+class CameraGroup {
+public:
+    CameraGroup();
+
+    /**
+     * Añade una cámara (su CameraTask) al grupo.
+     * @return Índice de la cámara, -1 si el grupo está lleno.
+     */
+    int add(CameraTask& io);
+    size_t size() const { return _count; }
+    CameraTask& at(uint8_t index) { return *_members[index]; }
+
+    /**
+     * Pone en modo cooperativo las tareas que no estén ya en marcha.
+     * Llamar después de begin() de cada controlador.
+     * @return false si el grupo está vacío.
+     */
+    bool begin();
+
+    /**
+     * Detiene el modo cooperativo de las tareas y descarta lote y FFC pendientes.
+     */
+    void end();
+
+    /**
+     * Una vuelta: reparte el lote y los FFC, avanza cada tarea cooperativa
+     * sin esperar y recoge todos sus eventos. Llamar en cada vuelta del loop.
+     * @param budgetUs Presupuesto total, repartido entre las cámaras.
+     * @return Eventos recogidos.
+     */
+    size_t update(uint32_t budgetUs = CAMERA_POLL_BUDGET_US);
+
+    /**
+     * Añade un comando al lote de difusión (el mismo para todas las cámaras).
+     * @return false si el lote está lleno o length es excesivo.
+     */
+    bool broadcast(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t* data = nullptr, uint8_t length = 0,
+                   CameraPriority priority = CAMERA_PRIORITY_INTERACTIVE);
+    bool setPaletteAll(ColorPalette palette);
+
+    /**
+     * Difunde un preset: una escritura de un byte por ajuste.
+     * @return false si no cabe entero en el lote (no se añade nada).
+     */
+    bool applyAll(const CameraSetting* settings, size_t count);
+
+    /**
+     * @return true mientras alguna cámara tenga comandos del lote sin terminar.
+     */
+    bool broadcastBusy() const { return _batchCount > 0; }
+
+    /**
+     * Llama a update() hasta que termina el lote (bloquea a quien llama).
+     * @return CAMERA_OK, el primer error de alguna cámara o CAMERA_ERR_TIMEOUT.
+     */
+    CameraErrorCode waitBroadcast(uint32_t timeoutMs = 1000);
+
+    /**
+     * Resultado del último lote en una cámara: el primer error o CAMERA_OK.
+     */
+    CameraErrorCode broadcastResult(uint8_t index) const { return _batchCode[index]; }
+
+    /**
+     * Pide un FFC; sale cuando pasen CAMERA_FFC_STAGGER_MS desde el anterior.
+     * @return false si el índice no existe.
+     */
+    bool ffc(uint8_t index);
+
+    /**
+     * FFC de todas las cámaras, escalonados.
+     */
+    void ffcAll();
+
+    /**
+     * FFC periódico escalonado de todo el grupo (0 para desactivarlo).
+     */
+    void setFfcInterval(uint32_t intervalMs);
+    void setFfcStagger(uint32_t staggerMs) { _ffcStaggerMs = staggerMs; }
+
+    /**
+     * Recibe cada resultado de cualquier cámara con su índice.
+     */
+    void setEventHandler(void (*handler)(uint8_t index, const CameraEvent& event)) { _eventHandler = handler; }
+
+    const CameraGroupStats& stats();
+    void resetStats();
+    void printStats(Print& out);
+
+private:
+    void feed(uint8_t index);
+    void releaseFfc();
+    void handle(uint8_t index, const CameraEvent& event);
+    void finishBatch();
+
+    CameraTask* _members[CAMERA_GROUP_MAX];
+    size_t _count;
+
+    // Lote de difusión: cada cámara avanza por su cuenta
+    CameraRequest _batch[CAMERA_GROUP_BATCH];
+    size_t _batchCount;
+    uint8_t _batchNext[CAMERA_GROUP_MAX];
+    uint32_t _batchIds[CAMERA_GROUP_MAX][CAMERA_GROUP_BATCH];  // 0: sin enviar o terminado
+    uint32_t _batchRetry[CAMERA_GROUP_MAX];     // bit por comando abandonado que hay que repetir
+    CameraErrorCode _batchCode[CAMERA_GROUP_MAX];
+    uint32_t _batchStartUs;
+
+    uint32_t _ffcPending;       // bit por cámara
+    uint32_t _ffcIds[CAMERA_GROUP_MAX];
+    uint8_t _ffcNext;
+    bool _ffcIssued;
+    uint32_t _lastFfcUs;
+    uint32_t _ffcStaggerMs;
+    uint32_t _ffcIntervalMs;
+    uint32_t _lastPeriodicMs;
+    bool _ffcSeen;
+    uint8_t _lastFfcCamera;
+    uint32_t _lastFfcStartUs;
+
+    void (*_eventHandler)(uint8_t index, const CameraEvent& event);
+    CameraGroupStats _stats;
+};
+
+#endif
@@ -0,0 +1,86 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraLink.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: UART link quality monitor for ThermalCameraController
+Docs:
+    Cuenta errores de trama, checksums, resincronizaciones, desbordes y
+    tramas no solicitadas, y calcula una puntuación (0-100) sobre las últimas
+    32 tramas. Un callback avisa cuando la puntuación cruza el umbral.
+*/
+
+#ifndef CAMERA_LINK_H
+#define CAMERA_LINK_H
+
+#include <Arduino.h>
+
+// Muestras mínimas antes de evaluar el umbral
+#ifndef CAMERA_LINK_MIN_SAMPLES
+#define CAMERA_LINK_MIN_SAMPLES 8
+#endif
+
+enum LinkEvent : uint8_t {
+    LINK_FRAME_OK = 0,      // trama completa con checksum correcto
+    LINK_FRAMING_ERROR,     // sin cabecera/pie o trama truncada
+    LINK_CHECKSUM_ERROR,    // checksum incorrecto
+    LINK_RESYNC,            // bytes descartados antes de la cabecera
+    LINK_OVERFLOW,          // buffer de respuesta lleno
+    LINK_UNSOLICITED,       // bytes o tramas sin comando pendiente
+    LINK_TIMEOUT,           // sin respuesta
+    LINK_EVENT_COUNT
+};
+
+/**
+ * Callback de cruce de umbral.
+ * @param score Puntuación actual (0-100).
+ * @param degraded true si ha caído por debajo del umbral, false si se ha recuperado.
+ */
+typedef void (*LinkQualityCallback)(uint8_t score, bool degraded);
+
+class CameraLinkQuality {
+public:
+    CameraLinkQuality();
+
+    /**
+     * Registra un evento. Todos excepto LINK_FRAME_OK cuentan como muestra mala.
+     */
+    void record(LinkEvent event);
+
+    uint32_t count(LinkEvent event) const { return event < LINK_EVENT_COUNT ? _counts[event] : 0; }
+
+    /**
+     * @return Bytes descartados en resincronizaciones.
+     */
+    uint32_t discardedBytes() const { return _discarded; }
+    void addDiscarded(size_t bytes) { _discarded += bytes; }
+
+    /**
+     * @return Puntuación 0-100 sobre las últimas 32 muestras (100 sin muestras).
+     */
+    uint8_t score() const;
+    uint8_t samples() const { return _samples; }
+    bool degraded() const { return _degraded; }
+
+    /**
+     * Configura el aviso de cruce de umbral.
+     * @param callback Función llamada al degradarse o recuperarse el enlace.
+     * @param threshold Puntuación por debajo de la cual el enlace se considera degradado.
+     */
+    void setCallback(LinkQualityCallback callback, uint8_t threshold);
+
+    void reset();
+
+private:
+    uint32_t _counts[LINK_EVENT_COUNT];
+    uint32_t _discarded;
+    uint32_t _history;      // bit a 1 = muestra buena, el bit 0 es la más reciente
+    uint8_t _samples;
+    uint8_t _threshold;
+    bool _degraded;
+    LinkQualityCallback _callback;
+};
+
+#endif
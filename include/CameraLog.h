@@ -0,0 +1,112 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraLog.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Compile-time log levels and deferred binary debug log
+Docs:
+    Los eventos se guardan en binario (timestamp, id, bytes) en una cola fija
+    y se formatean más tarde con flush(), fuera de la ruta de respuesta.
+    record() y flush() pueden ir en tareas distintas (un productor y un
+    consumidor, SpscQueue). Con CAMERA_LOG_LEVEL=0 todo el código de log
+    desaparece del binario.
+*/
+
+#ifndef CAMERA_LOG_H
+#define CAMERA_LOG_H
+
+#include <Arduino.h>
+#include "CameraConfig.h"
+#include "SpscQueue.h"
+#include <atomic>
+
+// Niveles de log
+#define CAMERA_LOG_NONE 0
+#define CAMERA_LOG_ERROR 1
+#define CAMERA_LOG_INFO 2
+#define CAMERA_LOG_DEBUG 3
+#define CAMERA_LOG_TRACE 4
+
+#ifndef CAMERA_LOG_LEVEL
+#define CAMERA_LOG_LEVEL CAMERA_LOG_DEBUG
+#endif
+
+// Bytes de carga útil por registro (una trama completa cabe en 24 bytes)
+#ifndef CAMERA_LOG_DATA_SIZE
+#define CAMERA_LOG_DATA_SIZE 24
+#endif
+
+// Registros formateados por cada llamada a update()
+#ifndef CAMERA_LOG_FLUSH_PER_UPDATE
+#define CAMERA_LOG_FLUSH_PER_UPDATE 4
+#endif
+
+enum CameraLogEvent : uint8_t {
+    LOG_EVENT_INIT = 0,     // begin() completado
+    LOG_EVENT_TX,           // trama enviada
+    LOG_EVENT_NAME,         // nombre del comando (texto)
+    LOG_EVENT_RX,           // bloque de bytes recibido
+    LOG_EVENT_RESPONSE,     // respuesta completa y válida
+    LOG_EVENT_ERROR,        // [código, clase, subclase]
+    LOG_EVENT_CONFIG,       // timeouts [respuesta ms (4), byte ms (4)]
+    LOG_EVENT_COUNT
+};
+
+struct CameraLogRecord {
+    uint32_t timestamp;     // micros()
+    uint8_t event;
+    uint8_t length;
+    uint8_t data[CAMERA_LOG_DATA_SIZE];
+};
+
+#if CAMERA_LOG_LEVEL > CAMERA_LOG_NONE
+
+class CameraLog {
+public:
+    CameraLog();
+
+    /**
+     * Productor: guarda un evento en la cola. Si está llena descarta este
+     * evento y lo cuenta (el productor nunca toca lo que lee el consumidor).
+     * Coste: una copia de hasta CAMERA_LOG_DATA_SIZE bytes, sin formateo.
+     */
+    void record(CameraLogEvent event, const uint8_t* data = nullptr, size_t length = 0);
+
+    /**
+     * Consumidor: formatea y envía registros pendientes.
+     * @param out Destino (Serial u otro Print).
+     * @param maxRecords Máximo de registros a formatear en esta llamada.
+     * @return Número de registros formateados.
+     */
+    size_t flush(Print& out, size_t maxRecords);
+
+    size_t pending() const { return _ring.size(); }
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * Consumidor: descarta lo pendiente sin formatearlo.
+     */
+    void clear();
+
+    bool enabled() const { return _enabled; }
+    void setEnabled(bool enable) { _enabled = enable; }
+
+private:
+    SpscQueue<CameraLogRecord, CAMERA_LOG_RING_SIZE> _ring;
+    std::atomic<uint32_t> _dropped;
+    bool _enabled;
+};
+
+// Registra solo si el nivel está compilado y el log activo; con nivel inferior no genera código
+#define CAMERA_LOG_AT(level, log, event, data, length) \
+    do { if (CAMERA_LOG_LEVEL >= (level) && (log).enabled()) (log).record((event), (data), (length)); } while (0)
+
+#else
+
+#define CAMERA_LOG_AT(level, log, event, data, length) do { (void)(data); (void)(length); } while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraProfiler.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Loop latency profiler and stall watchdog
+Docs:
+    Mide update(), cada llamada bloqueante al controlador y cada
+    MenuSystem::processInput. Las llamadas que superan el presupuesto
+    (20 ms por defecto) se guardan como "stalls" con el comando responsable:
+    el propio comando, o el más lento enviado dentro de la sección.
+*/
+
+#ifndef CAMERA_PROFILER_H
+#define CAMERA_PROFILER_H
+
+#include <Arduino.h>
+#include "CameraConfig.h"
+#include "CameraStats.h"
+#include "StaticRing.h"
+
+// Perfilado del loop (0 lo elimina del binario)
+#ifndef CAMERA_ENABLE_PROFILER
+#define CAMERA_ENABLE_PROFILER 1
+#endif
+
+// Presupuesto por llamada en microsegundos
+#ifndef CAMERA_LOOP_BUDGET_US
+#define CAMERA_LOOP_BUDGET_US 20000
+#endif
+
+// Últimos stalls conservados
+#ifndef CAMERA_STALL_HISTORY
+#define CAMERA_STALL_HISTORY 8
+#endif
+
+enum ProfileSection : uint8_t {
+    PROFILE_UPDATE = 0,     // CameraController::update()
+    PROFILE_COMMAND,        // comando bloqueante (TX + espera)
+    PROFILE_MENU_INPUT,     // MenuSystem::processInput()
+    PROFILE_SECTION_COUNT
+};
+
+constexpr const char* PROFILE_SECTION_NAMES[PROFILE_SECTION_COUNT] = {
+    "update", "command", "menu input"
+};
+
+struct CameraStall {
+    uint32_t timestamp;     // micros() al terminar la llamada
+    uint32_t durationUs;
+    uint8_t section;        // ProfileSection
+    uint8_t cls;            // comando responsable (0/0 si ninguno)
+    uint8_t subcls;
+};
+
+typedef void (*StallCallback)(const CameraStall& stall);
+
+#if CAMERA_ENABLE_PROFILER
+
+class CameraProfiler {
+public:
+    CameraProfiler();
+
+    /**
+     * Marca el inicio de una sección. Las secciones pueden anidarse.
+     * @return micros() de inicio, para pasar a end().
+     */
+    uint32_t begin();
+
+    /**
+     * Cierra una sección y comprueba el presupuesto.
+     * @param section Sección medida.
+     * @param startUs Valor devuelto por begin().
+     * @param cls Clase del comando (solo PROFILE_COMMAND).
+     * @param subcls Subclase del comando (solo PROFILE_COMMAND).
+     */
+    void end(ProfileSection section, uint32_t startUs, uint8_t cls = 0, uint8_t subcls = 0);
+
+    const CameraLatencyHistogram& section(ProfileSection section) const { return _sections[section]; }
+    uint32_t stallCount() const { return _stallCount; }
+    const StaticRing<CameraStall, CAMERA_STALL_HISTORY>& stalls() const { return _stalls; }
+
+    void setBudgetUs(uint32_t budgetUs) { _budgetUs = budgetUs; }
+    uint32_t budgetUs() const { return _budgetUs; }
+    void setStallCallback(StallCallback callback) { _callback = callback; }
+
+    void reset();
+
+private:
+    CameraLatencyHistogram _sections[PROFILE_SECTION_COUNT];
+    StaticRing<CameraStall, CAMERA_STALL_HISTORY> _stalls;
+    uint32_t _stallCount;
+    uint32_t _budgetUs;
+    StallCallback _callback;
+    uint8_t _depth;
+    // Comando más lento dentro de la sección exterior actual
+    uint32_t _worstUs;
+    uint8_t _worstCls;
+    uint8_t _worstSubcls;
+};
+
+// Mide el ámbito actual
+class CameraProfileScope {
+public:
+    CameraProfileScope(CameraProfiler& profiler, ProfileSection section, uint8_t cls = 0, uint8_t subcls = 0)
+        : _profiler(profiler), _section(section), _cls(cls), _subcls(subcls), _start(profiler.begin()) {}
+    ~CameraProfileScope() { _profiler.end(_section, _start, _cls, _subcls); }
+
+private:
+    CameraProfiler& _profiler;
+    ProfileSection _section;
+    uint8_t _cls;
+    uint8_t _subcls;
+    uint32_t _start;
+};
+
+#define CAMERA_PROFILE_CAT2(a, b) a##b
+#define CAMERA_PROFILE_CAT(a, b) CAMERA_PROFILE_CAT2(a, b)
+#define CAMERA_PROFILE_SCOPE(profiler, section, cls, subcls) \
+    CameraProfileScope CAMERA_PROFILE_CAT(_profileScope, __LINE__)((profiler), (section), (cls), (subcls))
+
+#else
+
+#define CAMERA_PROFILE_SCOPE(profiler, section, cls, subcls) do { } while (0)
+
+#endif
+
+#endif
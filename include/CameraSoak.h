@@ -0,0 +1,126 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraSoak.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Long-running soak/stress driver with a weighted random command mix
+Docs:
+    Lanza sobre un CameraController una mezcla aleatoria ponderada de
+    lecturas, escrituras, movimientos de cursor y FFC a un ritmo fijo,
+    durante horas. Mide la latencia de cada operación con cameraMicros(),
+    cuenta errores por tipo y por código y vigila el heap (mínimo libre y
+    fragmentación). Cada summaryIntervalMs imprime un resumen de la ventana
+    y del acumulado:
+
+        CameraSoakConfig config;
+        config.ratePerSec = 5;
+        CameraSoak soak(camera, config);
+        soak.begin();
+        // en loop():
+        soak.update(Serial);
+*/
+
+#ifndef CAMERA_SOAK_H
+#define CAMERA_SOAK_H
+
+#include <Arduino.h>
+#include "CameraController.h"
+#include "CameraStats.h"
+
+enum SoakOp : uint8_t {
+    SOAK_READ = 0,
+    SOAK_WRITE,
+    SOAK_CURSOR,
+    SOAK_FFC,
+    SOAK_OP_COUNT
+};
+
+constexpr const char* SOAK_OP_NAME[SOAK_OP_COUNT] = {"read", "write", "cursor", "ffc"};
+
+struct CameraSoakConfig {
+    // Peso relativo de cada operación (0 la desactiva). El FFC mueve el
+    // obturador: con el peso por defecto y 5 ops/s sale uno cada ~20 s.
+    uint8_t weights[SOAK_OP_COUNT] = {60, 25, 14, 1};
+    float ratePerSec = 5.0f;            // operaciones por segundo
+    uint32_t summaryIntervalMs = 60000; // 0 sin resúmenes periódicos
+    uint32_t durationMs = 0;            // 0 sin límite
+    uint32_t seed = 1;
+};
+
+struct CameraSoakOpStats {
+    uint32_t ops;
+    uint32_t errors;
+    CameraLatencyHistogram latency;
+
+    void reset();
+};
+
+struct CameraSoakHeap {
+    uint32_t freeBytes;     // libre en el último muestreo
+    uint32_t minFreeBytes;  // mínimo histórico del sistema
+    uint32_t maxBlockBytes; // mayor bloque reservable
+    uint8_t fragmentation;  // 100 - maxBlock * 100 / free
+    uint32_t liveAllocs;    // reservas sin liberar (CAMERA_TRACK_ALLOCATIONS)
+};
+
+class CameraSoak {
+public:
+    CameraSoak(CameraController& camera, const CameraSoakConfig& config = CameraSoakConfig());
+
+    /**
+     * Reinicia contadores y semilla y fija el origen de tiempos.
+     */
+    void begin();
+
+    /**
+     * Ejecuta la siguiente operación si le toca e imprime el resumen si vence
+     * el intervalo. No espera: llamar desde loop().
+     * @param out Destino de los resúmenes.
+     * @return false cuando se ha cumplido durationMs (tras el resumen final).
+     */
+    bool update(Print& out);
+
+    /**
+     * @return Milisegundos hasta la siguiente operación (0 si ya toca).
+     */
+    uint32_t msUntilNext() const;
+
+    /**
+     * Imprime el resumen de la ventana actual y del acumulado y abre una ventana nueva.
+     */
+    void printSummary(Print& out);
+
+    uint32_t elapsedMs() const;
+    uint32_t totalOps() const;
+    uint32_t totalErrors() const;
+    uint32_t errorCount(CameraErrorCode code) const;
+    const CameraSoakOpStats& stats(SoakOp op) const;
+    const CameraSoakHeap& heap() const;
+
+private:
+    CameraController& _camera;
+    CameraSoakConfig _config;
+    uint32_t _rng;
+    uint32_t _startMs;
+    uint32_t _nextUs;           // vencimiento de la siguiente operación (cameraMicros)
+    uint32_t _intervalUs;
+    uint32_t _lastSummaryMs;
+    uint32_t _weightTotal;
+    bool _done;
+    CameraSoakOpStats _total[SOAK_OP_COUNT];
+    CameraSoakOpStats _window[SOAK_OP_COUNT];
+    uint32_t _errorCounts[CAMERA_ERR_COUNT];
+    CameraSoakHeap _heap;
+    uint8_t _worstFragmentation;
+    uint32_t _baseAllocs;
+
+    uint32_t random(uint32_t bound);
+    SoakOp pickOp();
+    bool runOp(SoakOp op);
+    void sampleHeap();
+    void printOpLine(Print& out, const char* label, const CameraSoakOpStats& s);
+};
+
+#endif
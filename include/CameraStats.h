@@ -0,0 +1,135 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraStats.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Per-command counters and latency histograms for ThermalCameraController
+Docs:
+    Por cada par (clase, subclase) se cuentan envíos, respuestas, timeouts,
+    fallos y bytes, y se guardan dos histogramas de buckets fijos medidos con
+    micros(): envío -> primer byte y primer byte -> último byte.
+
+    Esos dos instantes se toman al leer la UART, y la espera la consulta
+    cada milisegundo (cameraDelay(1)), así que sus histogramas usan
+    CAMERA_REPLY_BUCKET_US, que empieza en 1 ms: el primer bucket es "en la
+    primera consulta". El resto de histogramas (tarea, perfilador) miden
+    instantes exactos y conservan los buckets de menos de 1 ms.
+*/
+
+#ifndef CAMERA_STATS_H
+#define CAMERA_STATS_H
+
+#include <Arduino.h>
+#include "CameraConfig.h"
+
+// Estadísticas por comando (0 elimina contadores e histogramas)
+#ifndef CAMERA_ENABLE_STATS
+#define CAMERA_ENABLE_STATS 1
+#endif
+
+// Número de comandos distintos con estadísticas propias
+#ifndef CAMERA_STATS_SLOTS
+#define CAMERA_STATS_SLOTS 32
+#endif
+
+// Límites superiores de los buckets en microsegundos (el último recoge el resto)
+constexpr uint32_t CAMERA_LATENCY_BUCKET_US[] = {
+    250, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 0xFFFFFFFFUL
+};
+
+#define CAMERA_LATENCY_BUCKETS (sizeof(CAMERA_LATENCY_BUCKET_US) / sizeof(CAMERA_LATENCY_BUCKET_US[0]))
+
+// Buckets de envío -> primer byte y primer byte -> último byte: la UART se consulta cada 1 ms
+constexpr uint32_t CAMERA_REPLY_BUCKET_US[] = {
+    1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000, 0xFFFFFFFFUL
+};
+
+static_assert(sizeof(CAMERA_REPLY_BUCKET_US) == sizeof(CAMERA_LATENCY_BUCKET_US),
+              "CAMERA_REPLY_BUCKET_US must have CAMERA_LATENCY_BUCKETS entries");
+
+struct CameraLatencyHistogram {
+    uint32_t buckets[CAMERA_LATENCY_BUCKETS];
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t totalUs;
+    const uint32_t* limits;             // límites de los buckets, CAMERA_LATENCY_BUCKETS entradas
+
+    /**
+     * Vacía el histograma.
+     * @param bucketLimits Límites de los buckets (CAMERA_LATENCY_BUCKET_US o CAMERA_REPLY_BUCKET_US).
+     */
+    void reset(const uint32_t* bucketLimits = CAMERA_LATENCY_BUCKET_US);
+    void add(uint32_t us);
+
+    /**
+     * @return Media en microsegundos (0 sin muestras).
+     */
+    uint32_t meanUs() const;
+
+    /**
+     * Percentil aproximado por buckets.
+     * @param pct Percentil (1-100).
+     * @return Límite superior del bucket que contiene el percentil, acotado por maxUs.
+     */
+    uint32_t percentileUs(uint8_t pct) const;
+
+    /**
+     * @return Límite superior del bucket en microsegundos.
+     */
+    uint32_t limitUs(size_t bucket) const { return limits[bucket]; }
+};
+
+struct CameraCommandStats {
+    uint8_t cls;
+    uint8_t subcls;
+    uint32_t sent;
+    uint32_t replied;
+    uint32_t timedOut;
+    uint32_t failed;                    // trama inválida o código de error del módulo
+    uint32_t bytesOut;
+    uint32_t bytesIn;
+    CameraLatencyHistogram firstByte;   // envío -> primer byte
+    CameraLatencyHistogram transfer;    // primer byte -> último byte
+};
+
+#if CAMERA_ENABLE_STATS
+
+class CameraStats {
+public:
+    CameraStats();
+
+    void recordSent(uint8_t cls, uint8_t subcls, size_t bytesOut);
+    void recordReply(uint8_t cls, uint8_t subcls, size_t bytesIn, uint32_t firstByteUs, uint32_t transferUs);
+    void recordTimeout(uint8_t cls, uint8_t subcls, size_t bytesIn);
+    void recordFailure(uint8_t cls, uint8_t subcls, size_t bytesIn);
+
+    /**
+     * Busca las estadísticas de un comando.
+     * @return Puntero a las estadísticas o nullptr si el comando no se ha enviado.
+     */
+    const CameraCommandStats* find(uint8_t cls, uint8_t subcls) const;
+
+    size_t size() const { return _count; }
+    const CameraCommandStats& at(size_t index) const { return _slots[index]; }
+
+    /**
+     * @return Eventos descartados porque no quedaban slots libres.
+     */
+    uint32_t untracked() const { return _untracked; }
+
+    void reset();
+
+private:
+    CameraCommandStats* slot(uint8_t cls, uint8_t subcls);
+
+    CameraCommandStats _slots[CAMERA_STATS_SLOTS];
+    size_t _count;
+    uint32_t _untracked;
+};
+
+#endif
+
+#endif
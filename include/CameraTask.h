@@ -0,0 +1,372 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraTask.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Camera I/O task pinned to its own core, fed through lock-free queues
+Docs:
+    El controlador pasa a vivir en una tarea FreeRTOS propia, fijada al
+    núcleo 0 (el loop de Arduino corre en el 1). La aplicación solo habla con
+    ella a través de dos colas SPSC sin bloqueos:
+        post*()  -> cola de comandos -> tarea de E/S (espera de respuesta incluida)
+        poll()   <- cola de eventos  <- resultado de cada comando
+    Ningún lado espera al otro: si la cola de comandos está llena post()
+    devuelve 0 y si la de eventos está llena el evento se descarta y se cuenta.
+    Con la tarea en marcha no se debe llamar al controlador directamente.
+
+        CameraTask io(camera);
+        camera.begin();
+        io.begin();
+        uint32_t id = io.postRead(CLASS_IMAGE, 0x02);   // brillo
+        ...
+        CameraEvent ev;
+        while (io.poll(ev)) { ... ev.id, ev.code, ev.data[0] ... }
+
+    Otras tareas (RC, telemetría, web...) usan call()/read()/write(): cada
+    llamada lleva su propia ranura de resultado en la pila del que llama,
+    entra por una cola MPSC y el llamante duerme hasta que la tarea de E/S la
+    completa. No hay ningún mutex retenido durante la espera de 150 ms.
+
+        CameraEvent result;
+        if (cameraIo.read(CLASS_IMAGE, 0x02, result) == CAMERA_OK) { ... result.data[0] ... }
+
+    Una ISR (botón de FFC, disparador externo) usa postFromISR() con una
+    petición preparada en setup(): sin reservas ni bloqueos, entra en una
+    cola propia que la tarea de E/S atiende antes que las demás y la
+    despierta al momento.
+
+        static CameraRequest ffc = CameraTask::prepare(CLASS_CAMERA, 0x02, FLAG_WRITE);
+        void IRAM_ATTR onButton() { cameraIo.postFromISR(ffc); }
+
+    Cada petición lleva una clase de prioridad (urgente, interactiva, de
+    fondo). La tarea de E/S reparte lo que llega en una cola por clase y
+    siempre ejecuta la más prioritaria; una petición sube una clase por cada
+    CAMERA_AGING_MS de espera para que el fondo no se quede sin turno. Si
+    llega trabajo urgente mientras una lectura no urgente espera respuesta
+    (sin bytes aún), la espera se abandona con CAMERA_ERR_ABORTED.
+
+    En placas de un solo núcleo (ESP32-C3) una tarea aparte solo añade
+    cambios de contexto. beginCooperative() no crea ninguna: la misma API
+    (post/poll, call desde otras tareas, postFromISR) se atiende llamando a
+    pollIo() en cada vuelta del loop. pollIo() nunca espera a la cámara:
+    envía, recoge los bytes que haya, vence timeouts y entrega resultados, y
+    vuelve en cuanto tendría que esperar o se agota su presupuesto.
+
+        io.beginCooperative();
+        void loop() { io.pollIo(); while (io.poll(ev)) { ... } ... }
+
+    En el host la tarea es un std::thread, para probarlo contra el simulador.
+*/
+
+#ifndef CAMERA_TASK_H
+#define CAMERA_TASK_H
+
+#include <Arduino.h>
+#include "CameraController.h"
+#include "CameraStats.h"
+#include "MpscQueue.h"
+#include "SpscQueue.h"
+#include "StaticRing.h"
+
+#include <atomic>
+
+#ifndef ARDUINO
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// Cola de eventos (resultados) hacia la aplicación; potencia de dos
+#ifndef CAMERA_EVENT_DEPTH
+#define CAMERA_EVENT_DEPTH 16
+#endif
+
+// Cola de peticiones desde interrupciones; potencia de dos
+#ifndef CAMERA_ISR_DEPTH
+#define CAMERA_ISR_DEPTH 4
+#endif
+
+// Cola de la tarea de E/S por clase de prioridad; potencia de dos
+#ifndef CAMERA_READY_DEPTH
+#define CAMERA_READY_DEPTH 16
+#endif
+
+// Espera tras la que una petición sube una clase de prioridad
+#ifndef CAMERA_AGING_MS
+#define CAMERA_AGING_MS 500
+#endif
+
+// Presupuesto por llamada a pollIo() en modo cooperativo
+#ifndef CAMERA_POLL_BUDGET_US
+#define CAMERA_POLL_BUDGET_US 1000
+#endif
+
+// Núcleo, prioridad y pila de la tarea de E/S
+#ifndef CAMERA_TASK_CORE
+#define CAMERA_TASK_CORE 0
+#endif
+#ifndef CAMERA_TASK_PRIORITY
+#define CAMERA_TASK_PRIORITY 3
+#endif
+#ifndef CAMERA_TASK_STACK
+#define CAMERA_TASK_STACK 4096
+#endif
+
+// Bytes de datos por petición y por evento (el modelo, 12 bytes, es el más largo)
+#define CAMERA_REQUEST_DATA 16
+
+// Clases de prioridad del planificador, de más a menos urgente
+enum CameraPriority : uint8_t {
+    CAMERA_PRIORITY_URGENT = 0,     // control del piloto: FFC, paleta, botones
+    CAMERA_PRIORITY_INTERACTIVE,    // menús y consultas puntuales
+    CAMERA_PRIORITY_BACKGROUND,     // telemetría, barridos de getDeviceInfo
+    CAMERA_PRIORITY_COUNT
+};
+
+constexpr const char* CAMERA_PRIORITY_NAMES[CAMERA_PRIORITY_COUNT] = {"urgente", "interactiva", "fondo"};
+
+struct CameraRequest {
+    uint32_t id;
+    uint8_t cls;
+    uint8_t subcls;
+    uint8_t rw;
+    uint8_t length;
+    uint8_t data[CAMERA_REQUEST_DATA];
+    uint8_t priority;           // CameraPriority
+    uint32_t postedUs;
+};
+
+struct CameraEvent {
+    uint32_t id;                // el devuelto por post*()
+    uint8_t cls;
+    uint8_t subcls;
+    uint8_t rw;
+    bool fromIsr;               // enviado con postFromISR()
+    uint8_t priority;           // CameraPriority
+    CameraErrorCode code;
+    uint8_t length;             // datos de la respuesta (solo lecturas)
+    uint8_t data[CAMERA_REQUEST_DATA];
+    uint32_t postedUs;          // post() en la aplicación
+    uint32_t startUs;           // la tarea de E/S empieza el comando
+    uint32_t doneUs;            // resultado listo
+};
+
+/**
+ * Llamada bloqueante de otra tarea: vive en la pila del llamante hasta que
+ * la tarea de E/S escribe el resultado y la despierta.
+ */
+struct CameraCall {
+    CameraRequest request;
+    CameraEvent* result;
+    std::atomic<bool> done;
+#ifdef ARDUINO
+    TaskHandle_t waiter;
+#else
+    std::mutex lock;
+    std::condition_variable wake;
+#endif
+};
+
+/**
+ * Petición en la cola de su clase dentro de la tarea de E/S.
+ */
+struct CameraScheduled {
+    CameraRequest request;
+    CameraCall* call;           // nullptr: el resultado va a la cola de eventos
+    bool fromIsr;
+};
+
+struct CameraClassStats {
+    uint32_t executed;
+    uint32_t abandoned;         // lecturas abandonadas por trabajo urgente
+    uint32_t maxWaitUs;         // máxima espera en cola (todas las fuentes)
+    CameraLatencyHistogram wait;    // espera en cola de los eventos recogidos con poll()
+};
+
+struct CameraTaskStats {
+    uint32_t posted;
+    uint32_t rejected;          // cola de comandos llena
+    uint32_t completed;         // eventos recogidos con poll()
+    uint32_t eventsDropped;     // cola de eventos llena
+    size_t commandHighWater;
+    size_t eventHighWater;
+    uint32_t calls;             // call() completadas (todas las tareas)
+    size_t callHighWater;
+    uint32_t pollCalls;         // modo cooperativo: llamadas a pollIo()
+    uint32_t pollMaxUs;         // la más larga
+    uint32_t isrPosted;
+    uint32_t isrRejected;       // cola de ISR llena
+    size_t isrHighWater;
+    CameraLatencyHistogram isrWait;     // postFromISR -> inicio de TX
+    CameraLatencyHistogram queueWait;   // post -> inicio en la tarea
+    CameraLatencyHistogram service;     // inicio -> resultado
+    CameraLatencyHistogram delivery;    // resultado -> poll()
+    CameraClassStats classes[CAMERA_PRIORITY_COUNT];
+};
+
+class CameraTask {
+public:
+    explicit CameraTask(CameraController& camera);
+    ~CameraTask();
+
+    /**
+     * Crea la tarea de E/S. Llamar después de camera.begin().
+     * @param core Núcleo al que se fija (ignorado en el host).
+     * @return false si ya estaba en marcha o no se pudo crear.
+     */
+    bool begin(int core = CAMERA_TASK_CORE, uint8_t priority = CAMERA_TASK_PRIORITY,
+               uint32_t stackSize = CAMERA_TASK_STACK);
+
+    /**
+     * Modo cooperativo (un solo núcleo, p. ej. ESP32-C3): sin tarea propia;
+     * pollIo() desde el loop avanza TX, RX, timeouts y callbacks. call() solo
+     * desde otras tareas: en el loop que llama a pollIo() no volvería nunca.
+     * @return false si ya estaba en marcha (en cualquier modo).
+     */
+    bool beginCooperative();
+    bool cooperative() const { return _cooperative.load(); }
+
+    /**
+     * Modo cooperativo: envía, recoge respuestas y entrega resultados sin
+     * esperar nunca a la cámara. Vuelve en cuanto la lectura en curso no
+     * tiene respuesta completa, no queda trabajo o se agota el presupuesto.
+     * @param budgetUs Tiempo máximo para empezar comandos nuevos.
+     * @return Comandos terminados en esta llamada.
+     */
+    size_t pollIo(uint32_t budgetUs = CAMERA_POLL_BUDGET_US);
+
+    /**
+     * Detiene la tarea al terminar el comando en curso (en modo cooperativo,
+     * al momento: la lectura en vuelo termina con CAMERA_ERR_ABORTED). Lo
+     * que sigue en cola no se ejecuta: las llamadas terminan con
+     * CAMERA_ERR_NOT_INITIALIZED y cada post() pendiente recibe su evento con
+     * ese código, así que todo id devuelto por post() tiene su evento en
+     * poll(). No llamar con otras tareas todavía entrando en call().
+     */
+    void end();
+    bool running() const { return _running.load(); }
+    CameraController& controller() { return _camera; }
+
+    /**
+     * Encola un comando sin esperar. Solo desde una tarea (la "aplicación").
+     * @return Id del comando para casar el evento, 0 si la cola está llena o length es excesivo.
+     */
+    uint32_t post(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t* data = nullptr, uint8_t length = 0,
+                  CameraPriority priority = CAMERA_PRIORITY_INTERACTIVE);
+    uint32_t postRead(uint8_t cls, uint8_t subcls, CameraPriority priority = CAMERA_PRIORITY_INTERACTIVE) {
+        return post(cls, subcls, FLAG_READ, nullptr, 0, priority);
+    }
+    uint32_t postWrite(uint8_t cls, uint8_t subcls, const uint8_t* data = nullptr, uint8_t length = 0,
+                       CameraPriority priority = CAMERA_PRIORITY_INTERACTIVE) {
+        return post(cls, subcls, FLAG_WRITE, data, length, priority);
+    }
+
+    /**
+     * Recoge el siguiente resultado y registra sus latencias.
+     * @return false si no hay eventos.
+     */
+    bool poll(CameraEvent& event);
+
+    /**
+     * Ejecuta un comando y espera su resultado. Seguro desde cualquier tarea
+     * salvo la propia tarea de E/S; usa la notificación de la tarea llamante.
+     * @param result Ranura del llamante para el resultado (datos, código, tiempos).
+     * @return Código del comando, CAMERA_ERR_NOT_INITIALIZED si la tarea no está en marcha.
+     */
+    CameraErrorCode call(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t* data, uint8_t length,
+                         CameraEvent& result, CameraPriority priority = CAMERA_PRIORITY_INTERACTIVE);
+    CameraErrorCode read(uint8_t cls, uint8_t subcls, CameraEvent& result,
+                         CameraPriority priority = CAMERA_PRIORITY_INTERACTIVE) {
+        return call(cls, subcls, FLAG_READ, nullptr, 0, result, priority);
+    }
+    CameraErrorCode write(uint8_t cls, uint8_t subcls, const uint8_t* data = nullptr, uint8_t length = 0,
+                          CameraPriority priority = CAMERA_PRIORITY_INTERACTIVE) {
+        CameraEvent result;
+        return call(cls, subcls, FLAG_WRITE, data, length, result, priority);
+    }
+
+    /**
+     * Prepara una petición para postFromISR() (en setup(), fuera de la ISR).
+     * @return Petición con id 0; se puede cambiar el id para distinguirla en poll().
+     */
+    static CameraRequest prepare(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t* data = nullptr,
+                                 uint8_t length = 0, CameraPriority priority = CAMERA_PRIORITY_URGENT);
+
+    /**
+     * Encola una petición preparada desde una interrupción y despierta a la
+     * tarea de E/S. Sin reservas ni esperas; su resultado llega por poll().
+     * @return false si la cola de ISR está llena.
+     */
+    bool postFromISR(const CameraRequest& request);
+
+    /**
+     * @return Peticiones de cualquier fuente que esperan en las colas de entrada.
+     */
+    size_t pendingCommands() const { return _commands.size() + _calls.size() + _isr.size(); }
+    size_t pendingEvents() const { return _events.size(); }
+
+    /**
+     * Estadísticas de colas y latencias (se actualizan en post() y poll()).
+     */
+    const CameraTaskStats& stats();
+    void resetStats();
+    void printStats(Print& out);
+
+    /**
+     * Una vuelta de la tarea de E/S: ejecuta por prioridad los comandos en
+     * cola y llama a camera.update(). Público para usarlo sin tarea (un solo hilo).
+     * @return Comandos ejecutados.
+     */
+    size_t service();
+
+private:
+    static void taskEntry(void* context);
+    void run();
+    void wake();
+    void admit(const CameraRequest& request);
+    bool gather();
+    bool next(CameraScheduled& item);
+    static bool urgentWaiting(void* context);
+    void execute(const CameraRequest& request, CameraEvent& event);
+    void open(const CameraRequest& request, CameraEvent& event);
+    void close(const CameraRequest& request, CameraEvent& event, CameraErrorCode code);
+    void finish(const CameraScheduled& item, CameraEvent& event);
+    void releasePending();
+    void drop(const CameraScheduled& item);
+    void deliver(const CameraEvent& event);
+    void complete(CameraCall* call, CameraErrorCode code);
+
+    CameraController& _camera;
+    SpscQueue<CameraRequest, CAMERA_QUEUE_DEPTH> _commands;
+    SpscQueue<CameraEvent, CAMERA_EVENT_DEPTH> _events;
+    MpscQueue<CameraCall*, CAMERA_QUEUE_DEPTH> _calls;
+    MpscQueue<CameraRequest, CAMERA_ISR_DEPTH> _isr;
+    std::atomic<bool> _running;
+    std::atomic<bool> _stopping;
+    std::atomic<bool> _cooperative;
+    std::atomic<uint32_t> _eventsDropped;
+    std::atomic<uint32_t> _callsDone;
+    std::atomic<uint32_t> _isrPosted;
+    std::atomic<uint32_t> _isrRejected;
+    StaticRing<CameraScheduled, CAMERA_READY_DEPTH> _ready[CAMERA_PRIORITY_COUNT];   // solo la tarea de E/S
+    std::atomic<uint32_t> _urgentPending;
+    uint8_t _inFlight;          // prioridad del comando en curso (tarea de E/S)
+    std::atomic<uint32_t> _classExecuted[CAMERA_PRIORITY_COUNT];
+    std::atomic<uint32_t> _classAbandoned[CAMERA_PRIORITY_COUNT];
+    std::atomic<uint32_t> _classMaxWaitUs[CAMERA_PRIORITY_COUNT];
+    uint32_t _nextId;
+    CameraTaskStats _stats;
+    CameraScheduled _current;   // modo cooperativo: comando elegido o en curso
+    CameraEvent _currentEvent;
+    bool _staged;
+    bool _active;
+#ifdef ARDUINO
+    TaskHandle_t _handle;
+#else
+    std::thread _thread;
+#endif
+};
+
+#endif
@@ -0,0 +1,57 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraText.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Flash-resident text tables and frame decoder for JS-MINI256-9 responses
+*/
+
+#ifndef CAMERA_TEXT_H
+#define CAMERA_TEXT_H
+
+#include <Arduino.h>
+#include "CameraConfig.h"
+
+// Entrada de tabla indexada por clase/subclase
+struct CameraTextEntry {
+    uint8_t cls;
+    uint8_t subcls;
+    const char* text;
+};
+
+// Entrada de tabla indexada por un código de un byte
+struct CameraCodeText {
+    uint8_t code;
+    const char* text;
+};
+
+// Nombres cortos de comandos (estadísticas, trazas, análisis de logs)
+extern const CameraTextEntry CAMERA_COMMAND_NAMES[];
+extern const size_t CAMERA_COMMAND_NAME_COUNT;
+
+/**
+ * Busca un texto por clase/subclase en una tabla.
+ * @return Texto de la tabla o nullptr si no existe.
+ */
+const char* cameraFindText(const CameraTextEntry* table, size_t count, uint8_t cls, uint8_t subcls);
+
+/**
+ * Obtiene el nombre corto de un comando.
+ * @return Nombre del comando o "?" si es desconocido.
+ */
+const char* cameraCommandName(uint8_t cls, uint8_t subcls);
+
+/**
+ * Decodifica una trama de respuesta a texto legible.
+ * Con CAMERA_ENABLE_INTERPRETATION=0 solo escribe un resumen hexadecimal.
+ * @param resp Trama completa (desde 0xF0).
+ * @param len Longitud de la trama.
+ * @param out Buffer de salida terminado en '\0'.
+ * @param size Tamaño del buffer de salida.
+ * @return Número de caracteres escritos.
+ */
+size_t cameraInterpretFrame(const uint8_t* resp, size_t len, char* out, size_t size);
+
+#endif
@@ -0,0 +1,123 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraTrace.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Chrome trace_event spans for commands and menu actions
+Docs:
+    Con -D CAMERA_ENABLE_TRACE=1 cada comando emite un span asíncrono
+    "command" con el id de su petición, y dentro de él "queue" (post() ->
+    inicio, solo con CameraTask) y "wait" (TX -> respuesta). Como son b/e con
+    id, siguen bien anidados en modo cooperativo, donde la espera termina en
+    otra llamada. tx, parse, callback y las acciones de MenuSystem son spans
+    B/E normales en el hilo que los ejecuta (tid distinto por hilo). La salida
+    es JSON de Chrome trace_event escrito en cualquier Print (un fichero en el
+    host, o Serial), visible en chrome://tracing o ui.perfetto.dev:
+        CameraTrace::begin(&out);
+        ...
+        CameraTrace::end();
+    Se puede trazar desde varios hilos a la vez (CameraTask en otro núcleo):
+    cada evento se escribe entero bajo un mutex.
+*/
+
+#ifndef CAMERA_TRACE_H
+#define CAMERA_TRACE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+#include "CameraClock.h"
+
+// Trazas Chrome (desactivadas por defecto: pensadas para ejecuciones en el host)
+#ifndef CAMERA_ENABLE_TRACE
+#define CAMERA_ENABLE_TRACE 0
+#endif
+
+#if CAMERA_ENABLE_TRACE
+
+class CameraTrace {
+public:
+    /**
+     * Empieza una traza y escribe la cabecera JSON.
+     * @param out Destino de los eventos.
+     * @param pid Identificador de proceso en la traza (uno por cámara).
+     */
+    static void begin(Print* out, uint32_t pid = 1);
+
+    /**
+     * Cierra el JSON y deja de trazar.
+     */
+    static void end();
+
+    static bool active() { return _out.load(std::memory_order_acquire) != nullptr; }
+
+    /**
+     * Escribe un evento en el hilo actual.
+     * @param phase 'B' inicio, 'E' fin, 'i' instantáneo.
+     * @param detail Texto opcional en args.detail (se escapa).
+     */
+    static void event(const char* name, const char* category, char phase, const char* detail = nullptr);
+
+    /**
+     * Escribe un evento asíncrono: los b/e con el mismo id forman un span
+     * aunque empiecen y terminen en llamadas o hilos distintos.
+     * @param phase 'b' inicio, 'e' fin.
+     * @param id Identificador del span (el de la petición).
+     * @param timestampUs Instante del evento (cameraMicros()).
+     */
+    static void async(const char* name, const char* category, char phase, uint32_t id, uint32_t timestampUs,
+                      const char* detail = nullptr);
+
+private:
+    static void header(const char* name, const char* category, char phase, uint32_t timestampUs);
+    static void writeString(const char* text);
+    static uint32_t threadId();
+
+    static std::atomic<Print*> _out;
+    static std::mutex _lock;
+    static uint32_t _pid;
+    static bool _first;
+};
+
+// Span con ámbito: B al construir, E al destruir
+class CameraTraceScope {
+public:
+    CameraTraceScope(const char* name, const char* category, const char* detail = nullptr)
+        : _name(name), _category(category) {
+        CameraTrace::event(name, category, 'B', detail);
+    }
+    ~CameraTraceScope() {
+        CameraTrace::event(_name, _category, 'E');
+    }
+
+private:
+    const char* _name;
+    const char* _category;
+};
+
+#define CAMERA_TRACE_CAT2(a, b) a##b
+#define CAMERA_TRACE_CAT(a, b) CAMERA_TRACE_CAT2(a, b)
+#define CAMERA_TRACE_SCOPE(name, category, detail) \
+    CameraTraceScope CAMERA_TRACE_CAT(_traceScope, __LINE__)((name), (category), (detail))
+#define CAMERA_TRACE_ASYNC_BEGIN(name, category, id, detail) \
+    CameraTrace::async((name), (category), 'b', (id), cameraMicros(), (detail))
+#define CAMERA_TRACE_ASYNC_END(name, category, id) CameraTrace::async((name), (category), 'e', (id), cameraMicros())
+// Span ya transcurrido, con sus instantes de inicio y fin
+#define CAMERA_TRACE_ASYNC_SPAN(name, category, id, startUs, endUs) \
+    do { \
+        CameraTrace::async((name), (category), 'b', (id), (startUs)); \
+        CameraTrace::async((name), (category), 'e', (id), (endUs)); \
+    } while (0)
+
+#else
+
+#define CAMERA_TRACE_SCOPE(name, category, detail) do { } while (0)
+#define CAMERA_TRACE_ASYNC_BEGIN(name, category, id, detail) do { } while (0)
+#define CAMERA_TRACE_ASYNC_END(name, category, id) do { } while (0)
+#define CAMERA_TRACE_ASYNC_SPAN(name, category, id, startUs, endUs) do { } while (0)
+
+#endif
+
+#endif
@@ -14,6 +14,8 @@ Desc: Interactive Menu System for Camera Control
 #include <Arduino.h>
 #include "CameraController.h"
 
+#if CAMERA_ENABLE_MENU
+
 enum MenuState {
     MAIN_MENU,
     INFO_MENU,
@@ -21,7 +23,8 @@ enum MenuState {
     CAMERA_MENU,
     CURSOR_MENU,
     PALETTE_MENU,
-    SYSTEM_MENU
+    SYSTEM_MENU,
+    STATS_MENU
 };
 
 class MenuSystem {
@@ -29,8 +32,8 @@ private:
     CameraController* _camera;
     MenuState _currentMenu;
     bool _waitingForInput;
-    String _inputPrompt;
-    void (MenuSystem::*_inputHandler)(String);
+    const char* _inputPrompt;
+    void (MenuSystem::*_inputHandler)(const String&);
     
     // Funciones de menú
     /**
@@ -67,6 +70,11 @@ private:
      * Muestra el menú de configuración del sistema.
      */
     void showSystemMenu();
+
+    /**
+     * Muestra el menú de estadísticas de comandos.
+     */
+    void showStatsMenu();
     
     // Funciones de ejecución
     /**
@@ -123,25 +131,51 @@ private:
      * Prueba la conexión con la cámara.
      */
     void testConnection();
+
+    // Acciones de estadísticas
+    /**
+     * Imprime los contadores por comando (envíos, respuestas, timeouts, bytes).
+     */
+    void printCommandStats();
+
+    /**
+     * Imprime los histogramas de latencia por comando.
+     */
+    void printLatencyHistograms();
+
+    /**
+     * Vuelca por consola la captura de tráfico UART.
+     */
+    void dumpCapture();
+
+    /**
+     * Inicia o detiene la captura de tráfico (se reinicia al iniciar).
+     */
+    void toggleCapture();
+
+    /**
+     * Imprime tiempos por sección del loop y los últimos stalls.
+     */
+    void printLoopProfile();
     
     // Funciones de entrada
     /**
      * Maneja la entrada del usuario para configurar el brillo.
      * @param input Entrada del usuario.
      */
-    void handleBrightnessInput(String input);
+    void handleBrightnessInput(const String& input);
 
     /**
      * Maneja la entrada del usuario para configurar el contraste.
      * @param input Entrada del usuario.
      */
-    void handleContrastInput(String input);
+    void handleContrastInput(const String& input);
 
     /**
      * Maneja la entrada del usuario para seleccionar una paleta de colores.
      * @param input Entrada del usuario.
      */
-    void handlePaletteInput(String input);
+    void handlePaletteInput(const String& input);
     
     // Manejo de opciones del menú de información
     /**
@@ -156,13 +190,13 @@ private:
      * @param prompt Mensaje que se muestra al usuario.
      * @param handler Puntero a la función que manejará la entrada del usuario.
      */
-    void requestInput(String prompt, void (MenuSystem::*handler)(String));
+    void requestInput(const char* prompt, void (MenuSystem::*handler)(const String&));
 
     /**
      * Imprime el encabezado de un menú con un título específico.
      * @param title Título del menú.
      */
-    void printMenuHeader(String title);
+    void printMenuHeader(const char* title);
 
     /**
      * Imprime un elemento del menú con su número, nombre y descripción opcional.
@@ -170,13 +204,20 @@ private:
      * @param name Nombre del elemento.
      * @param description Descripción opcional del elemento.
      */
-    void printMenuItem(int number, String name, String description = "");
+    void printMenuItem(int number, const char* name, const char* description = nullptr);
 
     /**
      * Imprime un separador visual para los menús.
      */
     void printSeparator();
 
+    /**
+     * Imprime una línea de un mismo carácter sin construir String.
+     * @param c Carácter de la línea.
+     * @param width Número de caracteres.
+     */
+    void printRule(char c, size_t width);
+
     /**
      * Valida si una entrada numérica está dentro de un rango específico.
      * @param input Entrada del usuario.
@@ -184,19 +225,24 @@ private:
      * @param max Valor máximo permitido.
      * @return true si la entrada es válida, false en caso contrario.
      */
-    bool validateNumericInput(String input, int min, int max);
+    bool validateNumericInput(const String& input, int min, int max);
 
     /**
-     * Imprime un mensaje de error.
+     * Imprime un mensaje de error (sin concatenar String).
      * @param error Mensaje de error.
      */
-    void printError(String error);
+    void printError(const char* error);
+
+    /**
+     * Imprime el último error de la cámara con su comando (sin concatenar String).
+     */
+    void printCameraError();
 
     /**
-     * Imprime un mensaje de éxito.
+     * Imprime un mensaje de éxito (sin concatenar String).
      * @param message Mensaje de éxito.
      */
-    void printSuccess(String message);
+    void printSuccess(const char* message);
     
 public:
     MenuSystem(CameraController* camera);
@@ -207,4 +253,6 @@ public:
     void returnToMainMenu();
 };
 
+#endif // CAMERA_ENABLE_MENU
+
 #endif
\ No newline at end of file
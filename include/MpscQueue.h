@@ -0,0 +1,112 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+MpscQueue.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Lock-free multi-producer/single-consumer queue sized at compile time
+*/
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Cola sin bloqueos para varios productores (tareas) y un consumidor.
+ * Cada celda lleva un número de secuencia: el productor reserva una
+ * posición con compare_exchange sobre _head y publica el elemento al
+ * actualizar la secuencia, así que ningún productor espera a otro mientras
+ * copia. Capacity debe ser potencia de dos.
+ */
+template <typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    static constexpr size_t capacity = Capacity;
+
+    MpscQueue() : _head(0), _tail(0), _highWater(0) {
+        for (size_t i = 0; i < Capacity; i++) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Productor (cualquier tarea o ISR): inserta al final sin esperar.
+     * Siempre en línea para que una ISR en IRAM no salte a flash.
+     * @return false si la cola está llena.
+     */
+    __attribute__((always_inline)) bool push(const T& item) {
+        Cell* cell;
+        size_t pos = _head.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &_cells[pos & (Capacity - 1)];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+            if (diff == 0) {
+                if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _head.load(std::memory_order_relaxed);
+            }
+        }
+        cell->item = item;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        size_t depth = pos + 1 - _tail.load(std::memory_order_relaxed);
+        size_t high = _highWater.load(std::memory_order_relaxed);
+        while (depth > high && !_highWater.compare_exchange_weak(high, depth, std::memory_order_relaxed)) {
+        }
+        return true;
+    }
+
+    /**
+     * Consumidor (una sola tarea): extrae el elemento más antiguo sin esperar.
+     * @return false si la cola está vacía o el siguiente aún se está copiando.
+     */
+    bool pop(T& item) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        Cell& cell = _cells[tail & (Capacity - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != tail + 1) {
+            return false;
+        }
+        item = cell.item;
+        cell.sequence.store(tail + Capacity, std::memory_order_release);
+        _tail.store(tail + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @return Elementos reservados en cola (instantánea: puede cambiar al momento).
+     */
+    size_t size() const {
+        return _head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_relaxed);
+    }
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @return Profundidad máxima alcanzada desde el último resetHighWater().
+     */
+    size_t highWater() const { return _highWater.load(std::memory_order_relaxed); }
+    void resetHighWater() { _highWater.store(0, std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    Cell _cells[Capacity];
+    std::atomic<size_t> _head;
+    std::atomic<size_t> _tail;
+    std::atomic<size_t> _highWater;
+};
+
+#endif
@@ -0,0 +1,89 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+SpscQueue.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Lock-free single-producer/single-consumer queue sized at compile time
+*/
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Cola sin bloqueos para exactamente un productor y un consumidor, cada uno
+ * en su tarea o núcleo. Igual que StaticRing pero con índices atómicos:
+ * el productor solo escribe _head y el consumidor solo _tail.
+ * Capacity debe ser potencia de dos.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    static constexpr size_t capacity = Capacity;
+
+    SpscQueue() : _head(0), _tail(0), _highWater(0) {}
+
+    /**
+     * Productor: inserta al final sin esperar.
+     * @return false si la cola está llena.
+     */
+    bool push(const T& item) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t tail = _tail.load(std::memory_order_acquire);
+        if (head - tail == Capacity) {
+            return false;
+        }
+        _items[head & (Capacity - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+
+        size_t depth = head + 1 - tail;
+        if (depth > _highWater.load(std::memory_order_relaxed)) {
+            _highWater.store(depth, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /**
+     * Consumidor: extrae el elemento más antiguo sin esperar.
+     * @return false si la cola está vacía.
+     */
+    bool pop(T& item) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t head = _head.load(std::memory_order_acquire);
+        if (head == tail) {
+            return false;
+        }
+        item = _items[tail & (Capacity - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @return Elementos en cola (instantánea: puede cambiar al momento).
+     */
+    size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @return Profundidad máxima alcanzada desde el último resetHighWater().
+     */
+    size_t highWater() const { return _highWater.load(std::memory_order_relaxed); }
+    void resetHighWater() { _highWater.store(0, std::memory_order_relaxed); }
+
+private:
+    T _items[Capacity];
+    std::atomic<size_t> _head;
+    std::atomic<size_t> _tail;
+    std::atomic<size_t> _highWater;
+};
+
+#endif
@@ -0,0 +1,78 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+StaticRing.h (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Fixed-capacity ring buffer sized at compile time (no heap)
+*/
+
+#ifndef STATIC_RING_H
+#define STATIC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Anillo de capacidad fija. Capacity debe ser potencia de dos.
+ * Cuando está lleno, push() sobrescribe el elemento más antiguo si overwrite es true.
+ */
+template <typename T, size_t Capacity>
+class StaticRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    static constexpr size_t capacity = Capacity;
+
+    StaticRing() : _head(0), _tail(0) {}
+
+    /**
+     * Inserta un elemento al final del anillo.
+     * @param item Elemento a insertar.
+     * @param overwrite true para descartar el más antiguo si no hay espacio.
+     * @return true si se insertó, false si estaba lleno y no se sobrescribe.
+     */
+    bool push(const T& item, bool overwrite = false) {
+        if (full()) {
+            if (!overwrite) {
+                return false;
+            }
+            _tail++;
+        }
+        _items[_head & (Capacity - 1)] = item;
+        _head++;
+        return true;
+    }
+
+    /**
+     * Extrae el elemento más antiguo.
+     * @param item Destino del elemento extraído.
+     * @return true si había un elemento, false si estaba vacío.
+     */
+    bool pop(T& item) {
+        if (empty()) {
+            return false;
+        }
+        item = _items[_tail & (Capacity - 1)];
+        _tail++;
+        return true;
+    }
+
+    /**
+     * Acceso al elemento i-ésimo desde el más antiguo (0 = más antiguo).
+     */
+    const T& at(size_t index) const { return _items[(_tail + index) & (Capacity - 1)]; }
+
+    size_t size() const { return _head - _tail; }
+    bool empty() const { return _head == _tail; }
+    bool full() const { return size() == Capacity; }
+    void clear() { _head = _tail = 0; }
+
+private:
+    T _items[Capacity];
+    size_t _head;
+    size_t _tail;
+};
+
+#endif
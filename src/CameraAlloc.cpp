@@ -0,0 +1,163 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraAlloc.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Heap allocation tracking hook and per-call report
+*/
+
+#include "CameraAlloc.h"
+
+#if CAMERA_TRACK_ALLOCATIONS
+
+#include <atomic>
+#include <new>
+
+// Atómicos: CameraTask y la aplicación reservan desde hilos distintos
+static std::atomic<uint32_t> allocCount(0);
+static std::atomic<uint32_t> freeCount(0);
+static std::atomic<uint32_t> allocBytes(0);
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add((uint32_t)size, std::memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add((uint32_t)(count * size), std::memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add((uint32_t)size, std::memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void* ptr) {
+    if (ptr) {
+        freeCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    __real_free(ptr);
+}
+}
+
+#ifndef ARDUINO
+// En el host libstdc++ es una biblioteca compartida: su operator new no pasa por
+// los wraps, así que se reemplaza para que std::string también se cuente.
+void* operator new(size_t size) {
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+#endif
+
+CameraAllocSnapshot cameraAllocSnapshot() {
+    CameraAllocSnapshot snapshot;
+    snapshot.allocs = allocCount.load(std::memory_order_relaxed);
+    snapshot.frees = freeCount.load(std::memory_order_relaxed);
+    snapshot.bytes = allocBytes.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+#else
+
+CameraAllocSnapshot cameraAllocSnapshot() {
+    CameraAllocSnapshot snapshot;
+    snapshot.allocs = 0;
+    snapshot.frees = 0;
+    snapshot.bytes = 0;
+    return snapshot;
+}
+
+#endif
+
+CameraAllocReport::CameraAllocReport() : _count(0) {
+}
+
+void CameraAllocReport::add(const char* name, uint32_t allocs, uint32_t bytes) {
+    CameraAllocEntry* entry = nullptr;
+    for (size_t i = 0; i < _count; i++) {
+        if (_entries[i].name == name || strcmp(_entries[i].name, name) == 0) {
+            entry = &_entries[i];
+            break;
+        }
+    }
+    if (!entry) {
+        if (_count >= CAMERA_ALLOC_REPORT_SIZE) {
+            return;
+        }
+        entry = &_entries[_count++];
+        entry->name = name;
+        entry->calls = 0;
+        entry->allocs = 0;
+        entry->bytes = 0;
+        entry->maxAllocs = 0;
+    }
+    entry->calls++;
+    entry->allocs += allocs;
+    entry->bytes += bytes;
+    if (allocs > entry->maxAllocs) {
+        entry->maxAllocs = allocs;
+    }
+}
+
+size_t CameraAllocReport::allocatingCalls() const {
+    size_t count = 0;
+    for (size_t i = 0; i < _count; i++) {
+        if (_entries[i].allocs > 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void CameraAllocReport::printCsv(Print& out) const {
+    out.println("method,calls,allocs,bytes,allocs_per_call,max_allocs");
+    for (size_t i = 0; i < _count; i++) {
+        const CameraAllocEntry& e = _entries[i];
+        // Nombre entre comillas; las comillas internas se duplican (RFC 4180)
+        out.print('"');
+        for (const char* c = e.name; *c; c++) {
+            if (*c == '"') {
+                out.print('"');
+            }
+            out.print(*c);
+        }
+        out.printf("\",%lu,%lu,%lu,%.2f,%lu\n", (unsigned long)e.calls, (unsigned long)e.allocs,
+                   (unsigned long)e.bytes, e.calls ? (double)e.allocs / e.calls : 0.0,
+                   (unsigned long)e.maxAllocs);
+    }
+}
@@ -0,0 +1,130 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraCapture.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Binary UART traffic capture ring for ThermalCameraController
+*/
+
+#include "CameraCapture.h"
+#include "CameraClock.h"
+
+size_t captureDecodeRecord(const uint8_t* buffer, size_t size, CaptureRecord& record) {
+    if (size < CAPTURE_HEADER_SIZE) {
+        return 0;
+    }
+    uint8_t flags = buffer[4];
+    size_t length = flags & CAPTURE_MAX_CHUNK;
+    if (size < CAPTURE_HEADER_SIZE + length) {
+        return 0;
+    }
+    record.timestamp = (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) |
+                       ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+    record.direction = (flags & CAPTURE_DIR_RX) ? CAPTURE_RX : CAPTURE_TX;
+    record.length = (uint8_t)length;
+    memcpy(record.data, buffer + CAPTURE_HEADER_SIZE, length);
+    return CAPTURE_HEADER_SIZE + length;
+}
+
+#if CAMERA_ENABLE_CAPTURE
+
+CameraCapture::CameraCapture() : _enabled(false), _freezeOnError(true) {
+    clear();
+}
+
+void CameraCapture::clear() {
+    _start = 0;
+    _used = 0;
+    _records = 0;
+    _dropped = 0;
+    _frozen = false;
+}
+
+void CameraCapture::put(uint8_t value) {
+    _buffer[(_start + _used) & (CAMERA_CAPTURE_SIZE - 1)] = value;
+    _used++;
+}
+
+void CameraCapture::dropOldest() {
+    size_t size = CAPTURE_HEADER_SIZE + (byteAt(4) & CAPTURE_MAX_CHUNK);
+    _start = (_start + size) & (CAMERA_CAPTURE_SIZE - 1);
+    _used -= size;
+    _records--;
+    _dropped++;
+}
+
+void CameraCapture::record(CaptureDirection direction, const uint8_t* data, size_t length) {
+    if (!_enabled || _frozen) {
+        return;
+    }
+    uint32_t now = cameraMicros();
+
+    while (length > 0) {
+        size_t chunk = (length > CAPTURE_MAX_CHUNK) ? CAPTURE_MAX_CHUNK : length;
+        while (CAMERA_CAPTURE_SIZE - _used < CAPTURE_HEADER_SIZE + chunk) {
+            dropOldest();
+        }
+
+        put((uint8_t)now);
+        put((uint8_t)(now >> 8));
+        put((uint8_t)(now >> 16));
+        put((uint8_t)(now >> 24));
+        put((uint8_t)chunk | (direction == CAPTURE_RX ? CAPTURE_DIR_RX : 0));
+        for (size_t i = 0; i < chunk; i++) {
+            put(data[i]);
+        }
+        _records++;
+
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void CameraCapture::trigger() {
+    if (_enabled && _freezeOnError) {
+        _frozen = true;
+    }
+}
+
+size_t CameraCapture::exportTo(uint8_t* out, size_t size) const {
+    size_t offset = 0;
+    while (offset < _used) {
+        size_t recordSize = CAPTURE_HEADER_SIZE + (byteAt(offset + 4) & CAPTURE_MAX_CHUNK);
+        if (offset + recordSize > size) {
+            break;
+        }
+        for (size_t i = 0; i < recordSize; i++) {
+            out[offset + i] = byteAt(offset + i);
+        }
+        offset += recordSize;
+    }
+    return offset;
+}
+
+size_t CameraCapture::dump(Print& out) const {
+    size_t offset = 0;
+    size_t count = 0;
+    while (offset < _used) {
+        uint8_t header[CAPTURE_HEADER_SIZE];
+        for (size_t i = 0; i < CAPTURE_HEADER_SIZE; i++) {
+            header[i] = byteAt(offset + i);
+        }
+        uint32_t timestamp = (uint32_t)header[0] | ((uint32_t)header[1] << 8) |
+                             ((uint32_t)header[2] << 16) | ((uint32_t)header[3] << 24);
+        size_t length = header[4] & CAPTURE_MAX_CHUNK;
+
+        out.printf("@%lu %s", (unsigned long)timestamp, (header[4] & CAPTURE_DIR_RX) ? "RX" : "TX");
+        for (size_t i = 0; i < length; i++) {
+            out.printf(" %02X", byteAt(offset + CAPTURE_HEADER_SIZE + i));
+        }
+        out.println();
+
+        offset += CAPTURE_HEADER_SIZE + length;
+        count++;
+    }
+    return count;
+}
+
+#endif
@@ -0,0 +1,15 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraClock.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Injectable clock for timeouts, delays and timestamps
+*/
+
+#include "CameraClock.h"
+
+#if CAMERA_INJECTABLE_CLOCK
+std::atomic<CameraClock*> cameraActiveClock(nullptr);
+#endif
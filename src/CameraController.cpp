@@ -14,24 +14,53 @@ Docs:
 */
 
 #include "CameraController.h"
+#include "CameraClock.h"
+#include "CameraText.h"
 
-// Constantes estáticas
-const char* CameraController::PALETTE_NAMES[] = {
-    "White Hot", "Black Hot", "Iron", "Rainbow", "Rain", 
-    "Ice Fire", "Fusion", "Sepia", "Color1", "Color2", 
-    "Color3", "Color4", "Color5", "Color6", "Color7"
-};
+// Variables estáticas para callbacks globales
+CameraController::ResponseTextCallback CameraController::_globalTextCallback = nullptr;
+#if !CAMERA_STATIC_ALLOCATION
+CameraController::ResponseCallback CameraController::_globalCallback = nullptr;
+#endif
 
-const char* CameraController::SHUTTER_MODE_NAMES[] = {
-    "Disabled", "Manual", "Automatic", "Fully Automatic"
-};
+// Utilidades de formato sin heap
+static uint32_t readDateField(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
 
-const char* CameraController::MIRROR_MODE_NAMES[] = {
-    "Disabled", "Central", "Horizontal", "Vertical"
-};
+size_t cameraFormatVersion(char* out, size_t size, const uint8_t* version) {
+    int n = snprintf(out, size, "%u.%u.%u", version[0], version[1], version[2]);
+    return (n < 0) ? 0 : (size_t)n;
+}
 
-// Variable estática para callback global
-CameraController::ResponseCallback CameraController::_globalCallback = nullptr;
+size_t cameraFormatDate(char* out, size_t size, uint32_t date) {
+    int n = snprintf(out, size, "%lu-%lu-%lu", (unsigned long)(date / 10000),
+                     (unsigned long)((date / 100) % 100), (unsigned long)(date % 100));
+    return (n < 0) ? 0 : (size_t)n;
+}
+
+/**
+ * Copia texto a un campo de CameraInfo.
+ * @return false si src no cabía en el campo y se ha cortado.
+ */
+#if CAMERA_STATIC_ALLOCATION
+template <size_t N>
+static bool assignText(char (&dst)[N], const char* src) {
+    size_t n = strnlen(src, N);
+    bool fits = n < N;
+    if (!fits) {
+        n = N - 1;
+    }
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+    return fits;
+}
+#else
+static bool assignText(String& dst, const char* src) {
+    dst = src;
+    return true;
+}
+#endif
 
 /**
  * Constructor de la clase CameraController.
@@ -40,9 +69,16 @@ CameraController::ResponseCallback CameraController::_globalCallback = nullptr;
  * @param txPin Pin TX del ESP32.
  */
 CameraController::CameraController(HardwareSerial* serial, uint8_t rxPin, uint8_t txPin) 
-    : _serial(serial), _rxPin(rxPin), _txPin(txPin), _debugEnabled(false),
-      _responseTimeout(RESPONSE_TIMEOUT), _byteTimeout(BYTE_TIMEOUT),
-      _lastByteTime(0) {
+    : _serial(serial), _rxPin(rxPin), _txPin(txPin), _debugEnabled(false), _logFlushedElsewhere(false),
+      _lastError(CAMERA_OK), _responseTimeout(RESPONSE_TIMEOUT), _byteTimeout(BYTE_TIMEOUT),
+      _lastByteTime(0), _awaitingAsync(false), _abandoned(false), _abandonedUntil(0),
+      _pending(false), _noWait(false), _waitStart(0), _waitTimeout(0),
+      _waitInterrupt(nullptr), _waitInterruptContext(nullptr), _txStartUs(0), _firstByteUs(0), _lastByteUs(0),
+      _traceId(0), _traceSeq(0), _traceSpan(0) {
+    _lastStatus.cls = 0;
+    _lastStatus.subcls = 0;
+    _lastStatus.code = CAMERA_OK;
+    resetErrorCounts();
     initializeResponse();
 }
 
@@ -52,17 +88,13 @@ CameraController::CameraController(HardwareSerial* serial, uint8_t rxPin, uint8_
  */
 bool CameraController::begin() {
     if (!_serial) {
-        _lastError = "Serial port not initialized";
-        return false;
+        return fail(CAMERA_ERR_NOT_INITIALIZED);
     }
     
     _serial->begin(UART_BAUDRATE, SERIAL_8N1, _rxPin, _txPin);
-    delay(100);
+    cameraDelay(100);
     
-    if (_debugEnabled) {
-        Serial.println("Camera controller initialized");
-        Serial.println("Ready for communication");
-    }
+    CAMERA_LOG_AT(CAMERA_LOG_INFO, _log, LOG_EVENT_INIT, nullptr, 0);
     
     return true;
 }
@@ -71,10 +103,94 @@ bool CameraController::begin() {
  * Procesa los bytes de respuesta recibidos desde la cámara.
  */
 void CameraController::update() {
+    CAMERA_PROFILE_SCOPE(_profiler, PROFILE_UPDATE, 0, 0);
     processResponseBytes();
+#if CAMERA_LOG_LEVEL > CAMERA_LOG_NONE
+    // Consumidor de baja prioridad: pocos registros por vuelta del loop
+    if (_debugEnabled && !_logFlushedElsewhere.load(std::memory_order_relaxed)) {
+        _log.flush(Serial, CAMERA_LOG_FLUSH_PER_UPDATE);
+    }
+#endif
+}
+
+size_t CameraController::flushLog(Print& out, size_t maxRecords) {
+#if CAMERA_LOG_LEVEL > CAMERA_LOG_NONE
+    _logFlushedElsewhere.store(true, std::memory_order_relaxed);
+    return _log.flush(out, maxRecords);
+#else
+    (void)out;
+    (void)maxRecords;
+    return 0;
+#endif
+}
+
+#if CAMERA_ENABLE_CAPTURE
+void CameraController::enableCapture(bool enable, bool freezeOnError) {
+    _capture.setEnabled(enable);
+    _capture.setFreezeOnError(freezeOnError);
+}
+
+size_t CameraController::dumpCapture(Print& out) const {
+    out.printf("# capture %lu records, %u bytes, %lu dropped%s\n", (unsigned long)_capture.records(),
+               (unsigned)_capture.used(), (unsigned long)_capture.dropped(), _capture.frozen() ? ", frozen" : "");
+    return _capture.dump(out);
+}
+
+void CameraController::resetCapture() {
+    _capture.clear();
+}
+
+const CameraCapture& CameraController::getCapture() const {
+    return _capture;
+}
+#endif
+
+#if CAMERA_ENABLE_PROFILER
+CameraProfiler& CameraController::getProfiler() {
+    return _profiler;
+}
+
+void CameraController::setLoopBudget(uint32_t budgetUs, StallCallback callback) {
+    _profiler.setBudgetUs(budgetUs);
+    _profiler.setStallCallback(callback);
+}
+#endif
+
+const CameraLinkQuality& CameraController::getLinkQuality() const {
+    return _link;
+}
+
+uint8_t CameraController::getLinkScore() const {
+    return _link.score();
+}
+
+void CameraController::setLinkQualityCallback(LinkQualityCallback callback, uint8_t threshold) {
+    _link.setCallback(callback, threshold);
+}
+
+void CameraController::resetLinkQuality() {
+    _link.reset();
+}
+
+#if CAMERA_ENABLE_STATS
+const CameraStats& CameraController::getStats() const {
+    return _stats;
 }
 
-// Funciones privadas de protocolo
+void CameraController::resetStats() {
+    _stats.reset();
+}
+#endif
+
+size_t CameraController::getLogPending() const {
+#if CAMERA_LOG_LEVEL > CAMERA_LOG_NONE
+    return _log.pending();
+#else
+    return 0;
+#endif
+}
+
+// Funciones de protocolo
 uint8_t CameraController::calculateChecksum(uint8_t device, uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t *data, uint8_t dataLen) {
     uint16_t sum = device + cls + subcls + rw;
     for (uint8_t i = 0; i < dataLen; i++) {
@@ -109,249 +225,596 @@ bool CameraController::sendCommand(uint8_t cls, uint8_t subcls, uint8_t rw, cons
     uint8_t cmdBuffer[16];
     uint8_t totalLen = 8 + dataLen;
     
-    buildCommand(cmdBuffer, DEVICE_ADDR, cls, subcls, rw, data, dataLen);
-    
-    if (_debugEnabled) {
-        Serial.print("Sending command: ");
-        for (uint8_t i = 0; i < totalLen; i++) {
-            Serial.printf("0x%02X ", cmdBuffer[i]);
-        }
-        Serial.println();
+    if (totalLen > sizeof(cmdBuffer)) {
+        return fail(CAMERA_ERR_OUT_OF_RANGE, cls, subcls);
     }
     
-    // Solo esperar respuesta si es un comando READ (rw=0x01)
-    bool shouldWaitForResponse = commandExpectsResponse(rw);
+    _lastStatus.cls = cls;
+    _lastStatus.subcls = subcls;
+    _lastStatus.code = CAMERA_OK;
     
-    if (shouldWaitForResponse) {
-        initializeResponse();
-    }
+    buildCommand(cmdBuffer, DEVICE_ADDR, cls, subcls, rw, data, dataLen);
     
-    _serial->write(cmdBuffer, totalLen);
+    CAMERA_LOG_AT(CAMERA_LOG_DEBUG, _log, LOG_EVENT_TX, cmdBuffer, totalLen);
     
-    if (shouldWaitForResponse) {
-        if (_debugEnabled) {
-            Serial.println("Command expects response, waiting...");
-        }
-        return waitForResponse();
-    } else {
-        if (_debugEnabled) {
-            Serial.println("Write/Action command sent (no response expected)");
-        }
-        return true; // Comando de escritura/acción enviado correctamente
-    }
+    // Solo esperar respuesta si es un comando READ (rw=0x01)
+    return transmit(cmdBuffer, totalLen, commandExpectsResponse(rw));
 }
 
-bool CameraController::sendDynamicCommand(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t *data, uint8_t dataLen, String name) {
-    if (_debugEnabled && name != "") {
-        Serial.println("Sending: " + name);
+bool CameraController::sendDynamicCommand(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t *data, uint8_t dataLen, const char* name) {
+    if (name && name[0]) {
+        CAMERA_LOG_AT(CAMERA_LOG_DEBUG, _log, LOG_EVENT_NAME, (const uint8_t*)name, strlen(name));
     }
     return sendCommand(cls, subcls, rw, data, dataLen);
 }
 
-bool CameraController::sendRawCommand(const uint8_t *cmd, size_t len, String name) {
-    if (_debugEnabled) {
-        if (name != "") {
-            Serial.println("Sending: " + name);
-        }
-        Serial.print("Raw command: ");
-        for (size_t i = 0; i < len; i++) {
-            Serial.printf("0x%02X ", cmd[i]);
-        }
-        Serial.println();
+bool CameraController::sendRawCommand(const uint8_t *cmd, size_t len, const char* name) {
+    if (name && name[0]) {
+        CAMERA_LOG_AT(CAMERA_LOG_DEBUG, _log, LOG_EVENT_NAME, (const uint8_t*)name, strlen(name));
     }
+    CAMERA_LOG_AT(CAMERA_LOG_DEBUG, _log, LOG_EVENT_TX, cmd, len);
     
     // Extraer el flag R/W del comando (posición 5 si es un comando válido)
     bool shouldWaitForResponse = false;
+    _lastStatus.cls = (len >= 5) ? cmd[3] : 0;
+    _lastStatus.subcls = (len >= 5) ? cmd[4] : 0;
+    _lastStatus.code = CAMERA_OK;
+    
+    // Si no es un comando válido o no podemos determinar el tipo,
+    // asumimos que no espera respuesta para evitar bloqueos
     if (len >= 6 && cmd[0] == HEADER_BYTE) {
         uint8_t rwFlag = cmd[5];
         shouldWaitForResponse = commandExpectsResponse(rwFlag);
-    } else {
-        // Si no es un comando válido o no podemos determinar el tipo, 
-        // asumimos que no espera respuesta para evitar bloqueos
-        if (_debugEnabled) {
-            Serial.println("Warning: Cannot determine command type from raw data, assuming no response expected");
-        }
     }
     
-    if (shouldWaitForResponse) {
+    return transmit(cmd, len, shouldWaitForResponse);
+}
+
+/**
+ * Envía una trama ya construida y, si es una lectura, espera la respuesta.
+ * Punto único de TX: captura, estadísticas y trazas se registran aquí.
+ * @param frame Trama completa.
+ * @param len Longitud de la trama.
+ * @param expectResponse true para esperar la respuesta (comandos READ).
+ * @return true si se envió (y se recibió respuesta válida cuando se espera).
+ */
+bool CameraController::transmit(const uint8_t* frame, size_t len, bool expectResponse) {
+    CAMERA_PROFILE_SCOPE(_profiler, PROFILE_COMMAND, _lastStatus.cls, _lastStatus.subcls);
+    
+    // Ids propios con el bit alto para no chocar con los de CameraTask
+    _traceSpan = _traceId ? _traceId : (0x80000000UL | ++_traceSeq);
+    _traceId = 0;
+    CAMERA_TRACE_ASYNC_BEGIN("command", "camera", _traceSpan, cameraCommandName(_lastStatus.cls, _lastStatus.subcls));
+    
+    if (expectResponse) {
+        drainAbandoned();
         initializeResponse();
     }
     
-    _serial->write(cmd, len);
+    {
+        CAMERA_TRACE_SCOPE("tx", "camera", nullptr);
+        _txStartUs = cameraMicros();
+        _serial->write(frame, len);
+    }
+#if CAMERA_ENABLE_CAPTURE
+    _capture.record(CAPTURE_TX, frame, len);
+#endif
+#if CAMERA_ENABLE_STATS
+    _stats.recordSent(_lastStatus.cls, _lastStatus.subcls, len);
+#endif
     
-    if (shouldWaitForResponse) {
-        if (_debugEnabled) {
-            Serial.println("Raw command expects response, waiting...");
+    if (expectResponse) {
+        if (_noWait) {
+            startWait(_responseTimeout); // modo cooperativo: pollResponse() la completa
+            return true;
         }
-        return waitForResponse();
-    } else {
-        if (_debugEnabled) {
-            Serial.println("Raw write/action command sent (no response expected)");
+        return waitForResponse(_responseTimeout);
+    }
+    _awaitingAsync = true; // la confirmación, si llega, se procesa en update()
+    CAMERA_TRACE_ASYNC_END("command", "camera", _traceSpan);
+    return true; // Comando de escritura/acción enviado correctamente
+}
+
+/**
+ * Antes de esperar otra respuesta, deja pasar la de una lectura abandonada
+ * para no tomarla por la nueva (como mucho hasta su timeout original).
+ */
+void CameraController::drainAbandoned() {
+    while (_abandoned && (long)(cameraMillis() - _abandonedUntil) < 0) {
+        processResponseBytes();
+        if (_abandoned) {
+            cameraDelay(1);
+        }
+    }
+    _abandoned = false; // lo que quede a medias lo descarta initializeResponse()
+}
+
+bool CameraController::readyForRead() {
+    if (_abandoned) {
+        if ((long)(cameraMillis() - _abandonedUntil) < 0) {
+            processResponseBytes();
+        } else {
+            _abandoned = false;
         }
-        return true; // Comando de escritura/acción enviado correctamente
     }
+    return !_pending && !_abandoned;
+}
+
+bool CameraController::startCommand(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t* data, uint8_t dataLen) {
+    if (_pending || (commandExpectsResponse(rw) && !readyForRead())) {
+        return false;
+    }
+    _noWait = true;
+    bool sent = sendCommand(cls, subcls, rw, data, dataLen);
+    _noWait = false;
+    return sent;
+}
+
+void CameraController::abandonResponse() {
+    if (!_pending) {
+        return;
+    }
+    _pending = false;
+    _abandoned = true;
+    _abandonedUntil = _waitStart + _waitTimeout;
+    _awaitingAsync = true;
+    CAMERA_TRACE_ASYNC_END("wait", "camera", _traceSpan);
+    CAMERA_TRACE_ASYNC_END("command", "camera", _traceSpan);
+    // Ceder el turno es una decisión del planificador, no un fallo: sin
+    // fail() no cuenta como error ni sale en el log
+    _lastStatus.code = CAMERA_ERR_ABORTED;
 }
 
 void CameraController::initializeResponse() {
     _currentResponse.length = 0;
-    _currentResponse.timestamp = millis();
+    _currentResponse.timestamp = cameraMillis();
     _currentResponse.complete = false;
     _currentResponse.valid = false;
 }
 
 
 bool CameraController::waitForResponse(unsigned long timeout) {
-    unsigned long startTime = millis();
-    _lastByteTime = startTime;
-    
-    if (_debugEnabled) {
-        Serial.println("Waiting for response...");
+    startWait(timeout);
+    CameraErrorCode code;
+    while (!pollResponse(code)) {
+        cameraDelay(1);
+    }
+    return code == CAMERA_OK;
+}
+
+void CameraController::startWait(unsigned long timeout) {
+    _waitStart = cameraMillis();
+    _waitTimeout = timeout;
+    _lastByteTime = _waitStart;
+    _pending = true;
+    CAMERA_TRACE_ASYNC_BEGIN("wait", "camera", _traceSpan, nullptr);
+}
+
+/**
+ * Un paso de la espera de respuesta, sin bloquear: lee lo disponible y
+ * comprueba fin de trama, abandono y timeout.
+ */
+bool CameraController::pollResponse(CameraErrorCode& code) {
+    if (!_pending) {
+        code = _lastStatus.code;
+        return true;
+    }
+    if (_serial->available()) {
+        readAvailable();
     }
     
-    while (millis() - startTime < timeout) {
-        if (_serial->available()) {
-            while (_serial->available() && _currentResponse.length < MAX_RESPONSE_SIZE) {
-                _currentResponse.data[_currentResponse.length] = _serial->read();
-                if (_debugEnabled) {
-                    Serial.printf("Received byte[%d]: 0x%02X\n", _currentResponse.length, _currentResponse.data[_currentResponse.length]);
-                }
-                _currentResponse.length++;
-                _lastByteTime = millis();
-            }
-        }
+    if (_currentResponse.length > 0 && 
+        (cameraMillis() - _lastByteTime) > _byteTimeout) {
+        _pending = false;
+        CAMERA_TRACE_ASYNC_END("wait", "camera", _traceSpan);
+        code = finishResponse();
         
-        if (_currentResponse.length > 0 && 
-            (millis() - _lastByteTime) > _byteTimeout) {
-            _currentResponse.complete = true;
-            _currentResponse.valid = (_currentResponse.length >= 7);
-            
-            if (_debugEnabled) {
-                Serial.printf("Response complete. Length: %d, Valid: %s\n", 
-                             _currentResponse.length, _currentResponse.valid ? "YES" : "NO");
-            }
-            
-            if (_currentResponse.valid) {
-                String interpretation = interpretResponse();
-                
-                if (_debugEnabled) {
-                    Serial.println("=== RESPUESTA COMPLETA DEL DISPOSITIVO ===");
-                    Serial.print("Raw data (" + String(_currentResponse.length) + " bytes): ");
-                    for (size_t i = 0; i < _currentResponse.length; i++) {
-                        Serial.printf("0x%02X ", _currentResponse.data[i]);
-                    }
-                    Serial.println();
-                    Serial.println("Interpretación: " + interpretation);
-                    Serial.println("==========================================");
-                }
-                
-                // Llamar callback global si existe
-                if (_globalCallback) {
-                    _globalCallback(interpretation);
-                }
-            }
-            
-            return _currentResponse.valid;
+        if (!_currentResponse.valid) {
+#if CAMERA_ENABLE_STATS
+            _stats.recordFailure(_lastStatus.cls, _lastStatus.subcls, _currentResponse.length);
+#endif
+            failResponse(code);
+            CAMERA_TRACE_ASYNC_END("command", "camera", _traceSpan);
+            return true;
         }
         
-        delay(1);
+#if CAMERA_ENABLE_STATS
+        _stats.recordReply(_lastStatus.cls, _lastStatus.subcls, _currentResponse.length,
+                           _firstByteUs - _txStartUs, _lastByteUs - _firstByteUs);
+#endif
+        dispatchResponse();
+        CAMERA_TRACE_ASYNC_END("command", "camera", _traceSpan);
+        return true;
     }
     
-    if (_debugEnabled) {
-        Serial.printf("Response timeout after %lu ms. Received %d bytes.\n", timeout, _currentResponse.length);
-        if (_currentResponse.length > 0) {
-            Serial.print("Partial data: ");
-            for (size_t i = 0; i < _currentResponse.length; i++) {
-                Serial.printf("0x%02X ", _currentResponse.data[i]);
-            }
-            Serial.println();
-        }
+    if (_currentResponse.length == 0 && _waitInterrupt && _waitInterrupt(_waitInterruptContext)) {
+        // Nada recibido aún: abandonar y dejar la respuesta tardía para update()
+        abandonResponse();
+        code = CAMERA_ERR_ABORTED;
+        return true;
     }
     
-    _lastError = "Response timeout";
+    if (cameraMillis() - _waitStart >= _waitTimeout) {
+        _pending = false;
+#if CAMERA_ENABLE_STATS
+        _stats.recordTimeout(_lastStatus.cls, _lastStatus.subcls, _currentResponse.length);
+#endif
+        _link.record(LINK_TIMEOUT);
+        CAMERA_TRACE_ASYNC_END("wait", "camera", _traceSpan);
+        code = CAMERA_ERR_TIMEOUT;
+        failResponse(code);
+        CAMERA_TRACE_ASYNC_END("command", "camera", _traceSpan);
+        return true;
+    }
     return false;
 }
 
+/**
+ * Valida la trama recibida según la guía del protocolo:
+ * BEGIN(0xF0) SIZE DEV CLASS SUBCLASS FLAG DATA... CHK END(0xFF),
+ * con CHK = suma de DEV..DATA (8 bits inferiores).
+ * @return CAMERA_OK si la trama es válida, el código de error en caso contrario.
+ */
+CameraErrorCode CameraController::validateFrame(const uint8_t* resp, size_t len) {
+    if (len < 7 || resp[0] != HEADER_BYTE || resp[len - 1] != FOOTER_BYTE) {
+        return CAMERA_ERR_SHORT_FRAME;
+    }
+
+    uint8_t sum = 0;
+    for (size_t i = 2; i < len - 2; i++) {
+        sum += resp[i];
+    }
+    if (sum != resp[len - 2]) {
+        return CAMERA_ERR_BAD_CHECKSUM;
+    }
+
+    // Flag 0x04: el módulo devuelve un código de error (0x00 sin comando, 0x01 umbral excedido)
+    if (resp[5] == 0x04) {
+        return (resp[6] == 0x01) ? CAMERA_ERR_OUT_OF_RANGE : CAMERA_ERR_NOT_SUPPORTED;
+    }
+
+    return CAMERA_OK;
+}
+
+/**
+ * Registra un error local (argumento fuera de rango, sin inicializar):
+ * actualiza el último código, el estado del comando y el contador.
+ * No congela la captura: por la UART no ha pasado nada que mirar.
+ * @return Siempre false, para usar como "return fail(...)".
+ */
+bool CameraController::fail(CameraErrorCode code, uint8_t cls, uint8_t subcls) {
+    _lastError = code;
+    _lastStatus.cls = cls;
+    _lastStatus.subcls = subcls;
+    _lastStatus.code = code;
+    countError(code, cls, subcls);
+    return false;
+}
+
+/**
+ * El comando en curso terminó con un error del enlace (trama inválida o timeout).
+ * @return Siempre false.
+ */
+bool CameraController::failResponse(CameraErrorCode code) {
+    _lastError = code;
+    _lastStatus.code = code;
+    wireError(code, _lastStatus.cls, _lastStatus.subcls);
+    return false;
+}
+
+/**
+ * Punto único de los errores del enlace, del comando en curso o de una
+ * respuesta asíncrona o tardía: los cuenta y congela la captura.
+ */
+void CameraController::wireError(CameraErrorCode code, uint8_t cls, uint8_t subcls) {
+    countError(code, cls, subcls);
+#if CAMERA_ENABLE_CAPTURE
+    _capture.trigger();
+#endif
+}
+
+/**
+ * Respuesta asíncrona o tardía inválida: no es el resultado de ningún
+ * comando, pero es un error del enlace igual que los demás.
+ */
+void CameraController::asyncError(CameraErrorCode code) {
+    const uint8_t* d = _currentResponse.data;
+    bool named = _currentResponse.length >= 5 && d[0] == HEADER_BYTE;
+    wireError(code, named ? d[3] : 0, named ? d[4] : 0);
+}
+
+void CameraController::countError(CameraErrorCode code, uint8_t cls, uint8_t subcls) {
+    _errorCounts[code]++;
+#if CAMERA_LOG_LEVEL >= CAMERA_LOG_ERROR
+    const uint8_t entry[3] = {(uint8_t)code, cls, subcls};
+    CAMERA_LOG_AT(CAMERA_LOG_ERROR, _log, LOG_EVENT_ERROR, entry, sizeof(entry));
+#else
+    (void)cls;
+    (void)subcls;
+#endif
+}
+
+
+/**
+ * Lee los bytes disponibles en la respuesta actual, con marcas de tiempo.
+ * Si el buffer se llena descarta el resto para no mezclarlo con la siguiente trama.
+ * @return Bytes añadidos a la respuesta.
+ */
+size_t CameraController::readAvailable() {
+    size_t chunkStart = _currentResponse.length;
+    if (chunkStart == 0) {
+        _firstByteUs = cameraMicros();
+    }
+    while (_serial->available() && _currentResponse.length < MAX_RESPONSE_SIZE) {
+        _currentResponse.data[_currentResponse.length] = _serial->read();
+        _currentResponse.length++;
+        _lastByteTime = cameraMillis();
+    }
+    _lastByteUs = cameraMicros();
+    
+    if (_currentResponse.length >= MAX_RESPONSE_SIZE && _serial->available()) {
+        size_t dropped = 0;
+        while (_serial->available()) {
+            _serial->read();
+            dropped++;
+        }
+        _link.record(LINK_OVERFLOW);
+        _link.addDiscarded(dropped);
+    }
+    
+#if CAMERA_ENABLE_CAPTURE
+    _capture.record(CAPTURE_RX, _currentResponse.data + chunkStart, _currentResponse.length - chunkStart);
+#endif
+    // Un registro por bloque leído, no un printf por byte
+    CAMERA_LOG_AT(CAMERA_LOG_TRACE, _log, LOG_EVENT_RX, _currentResponse.data + chunkStart,
+                  _currentResponse.length - chunkStart);
+    return _currentResponse.length - chunkStart;
+}
+
+/**
+ * Descarta bytes sueltos antes de la cabecera 0xF0 (ruido o restos de otra trama).
+ */
+void CameraController::resyncResponse() {
+    size_t len = _currentResponse.length;
+    if (len == 0 || _currentResponse.data[0] == HEADER_BYTE) {
+        return;
+    }
+    
+    size_t start = 1;
+    while (start < len && _currentResponse.data[start] != HEADER_BYTE) {
+        start++;
+    }
+    memmove(_currentResponse.data, _currentResponse.data + start, len - start);
+    _currentResponse.length = len - start;
+    _link.record(LINK_RESYNC);
+    _link.addDiscarded(start);
+}
+
+/**
+ * Cierra la respuesta actual: resincroniza, valida y registra el resultado en el monitor de enlace.
+ * @return CAMERA_OK si la trama es válida, el código de error en caso contrario.
+ */
+CameraErrorCode CameraController::finishResponse() {
+    CAMERA_TRACE_SCOPE("parse", "camera", nullptr);
+    resyncResponse();
+    splitResponse();
+    return closeFrame();
+}
+
+/**
+ * Valida la trama que queda en la respuesta actual y registra el resultado en el monitor de enlace.
+ */
+CameraErrorCode CameraController::closeFrame() {
+    CameraErrorCode code = validateFrame(_currentResponse.data, _currentResponse.length);
+    _currentResponse.complete = true;
+    _currentResponse.valid = (code == CAMERA_OK);
+    
+    if (code == CAMERA_ERR_SHORT_FRAME) {
+        _link.record(LINK_FRAMING_ERROR);
+    } else if (code == CAMERA_ERR_BAD_CHECKSUM) {
+        _link.record(LINK_CHECKSUM_ERROR);
+    } else {
+        _link.record(LINK_FRAME_OK); // códigos 0x04 del módulo: trama correcta
+    }
+    return code;
+}
+
+/**
+ * Tramas llegadas sin pausa entre ellas (la confirmación de una escritura
+ * pegada a la respuesta de la lectura siguiente) se separan por su campo
+ * SIZE, como en CameraLogAnalyzer. Todas menos la última son respuestas
+ * asíncronas y se procesan como en update(); la última queda en la respuesta.
+ */
+void CameraController::splitResponse() {
+    for (;;) {
+        size_t len = _currentResponse.length;
+        if (len < 2 || _currentResponse.data[0] != HEADER_BYTE) {
+            return;
+        }
+        size_t frameLen = (size_t)_currentResponse.data[1] + 4;
+        if (frameLen < 7 || frameLen >= len) {
+            return; // una sola trama (o SIZE corrupto): se valida entera
+        }
+        uint8_t rest[MAX_RESPONSE_SIZE];
+        size_t restLen = len - frameLen;
+        memcpy(rest, _currentResponse.data + frameLen, restLen);
+        _currentResponse.length = frameLen;
+        CameraErrorCode code = closeFrame();
+        if (code == CAMERA_OK) {
+            dispatchResponse();
+        } else {
+            asyncError(code);
+        }
+        memcpy(_currentResponse.data, rest, restLen);
+        _currentResponse.length = restLen;
+        _currentResponse.complete = false;
+        _currentResponse.valid = false;
+        resyncResponse();
+    }
+}
 
 void CameraController::processResponseBytes() {
+    if (_pending) {
+        return; // los bytes son de la lectura en curso: los recoge pollResponse()
+    }
     if (_serial->available()) {
-        while (_serial->available() && _currentResponse.length < MAX_RESPONSE_SIZE) {
-            _currentResponse.data[_currentResponse.length] = _serial->read();
-            _currentResponse.length++;
-            _lastByteTime = millis();
+        if (_currentResponse.complete) {
+            initializeResponse(); // la respuesta anterior ya se entregó
         }
+        readAvailable();
     }
     
     if (_currentResponse.length > 0 && 
-        (millis() - _lastByteTime) > _byteTimeout && 
+        (cameraMillis() - _lastByteTime) > _byteTimeout && 
         !_currentResponse.complete) {
         
-        _currentResponse.complete = true;
-        _currentResponse.valid = (_currentResponse.length >= 7);
+        CameraErrorCode code = finishResponse();
+        if (!_awaitingAsync) {
+            _link.record(LINK_UNSOLICITED);
+        }
+        _awaitingAsync = false;
+        _abandoned = false;
         
         if (_currentResponse.valid) {
-            String interpretation = interpretResponse();
-            
-            if (_debugEnabled) {
-                Serial.print("Respuesta completa del dispositivo (");
-                Serial.print(_currentResponse.length);
-                Serial.print(" bytes): ");
-                
-                for (size_t i = 0; i < _currentResponse.length; i++) {
-                    Serial.print("0x");
-                    if (_currentResponse.data[i] < 0x10) Serial.print("0");
-                    Serial.print(_currentResponse.data[i], HEX);
-                    Serial.print(" ");
-                }
-                Serial.println();
-            }
-            
-            // Usar callback global si está disponible
-            if (_globalCallback) {
-                _globalCallback(interpretResponse());
-            }
+            dispatchResponse();
+        } else {
+            asyncError(code);
         }
         
         initializeResponse();
     }
 }
 
+/**
+ * Interpreta la respuesta actual y la entrega a los callbacks globales.
+ * El texto se formatea en la pila; solo el callback String reserva heap.
+ * El volcado de depuración se guarda en binario y se formatea al vaciar el log.
+ */
+void CameraController::dispatchResponse() {
+    CAMERA_TRACE_SCOPE("callback", "camera", nullptr);
+    CAMERA_LOG_AT(CAMERA_LOG_DEBUG, _log, LOG_EVENT_RESPONSE, _currentResponse.data, _currentResponse.length);
+
+    bool hasCallback = (_globalTextCallback != nullptr);
+#if !CAMERA_STATIC_ALLOCATION
+    hasCallback = hasCallback || (_globalCallback != nullptr);
+#endif
+    if (!hasCallback) {
+        return; // Nadie consume el texto: no formatear
+    }
+
+    char interpretation[CAMERA_TEXT_SIZE];
+    interpretResponse(interpretation, sizeof(interpretation));
+
+    // Llamar callbacks globales si existen
+    if (_globalTextCallback) {
+        _globalTextCallback(interpretation);
+    }
+#if !CAMERA_STATIC_ALLOCATION
+    if (_globalCallback) {
+        _globalCallback(String(interpretation));
+    }
+#endif
+}
+
 // Información del dispositivo
-String CameraController::getModel() {
+bool CameraController::getModel(char* buffer, size_t size) {
+    if (size == 0) {
+        return false;
+    }
+    buffer[0] = '\0';
+
     if (sendCommand(CLASS_INFO, 0x02, FLAG_READ)) {
         if (_currentResponse.length >= 8) {
-            String model = "";
+            size_t n = 0;
             uint8_t dataLen = _currentResponse.data[6];
-            for (int i = 7; i < 7 + dataLen && i < _currentResponse.length - 2; i++) {
-                model += (char)_currentResponse.data[i];
+            for (size_t i = 7; i < 7u + dataLen && i < _currentResponse.length - 2 && n + 1 < size; i++) {
+                buffer[n++] = (char)_currentResponse.data[i];
             }
-            return model;
+            buffer[n] = '\0';
+            return n > 0;
         }
     }
-    return "";
+    return false;
 }
 
-String CameraController::getFPGAVersion() {
-    if (sendCommand(CLASS_INFO, 0x03, FLAG_READ)) {
-        if (_currentResponse.length >= 10) {
-            return String(_currentResponse.data[7]) + "." + 
-                   String(_currentResponse.data[8]) + "." + 
-                   String(_currentResponse.data[9]);
-        }
+bool CameraController::readVersionBytes(uint8_t subcls, uint8_t* version) {
+    if (sendCommand(CLASS_INFO, subcls, FLAG_READ) && _currentResponse.length >= 10) {
+        memcpy(version, &_currentResponse.data[7], 3);
+        return true;
     }
-    return "";
+    return false;
 }
 
-String CameraController::getSoftwareVersion() {
-    if (sendCommand(CLASS_INFO, 0x05, FLAG_READ)) {
-        if (_currentResponse.length >= 10) {
-            return String(_currentResponse.data[7]) + "." + 
-                   String(_currentResponse.data[8]) + "." + 
-                   String(_currentResponse.data[9]);
-        }
+bool CameraController::readDateValue(uint8_t subcls, uint32_t& date) {
+    if (sendCommand(CLASS_INFO, subcls, FLAG_READ) && _currentResponse.length >= 11) {
+        date = readDateField(&_currentResponse.data[7]);
+        return true;
     }
-    return "";
+    return false;
 }
 
+bool CameraController::readVersionText(uint8_t subcls, char* out, size_t size) {
+    uint8_t version[3];
+    out[0] = '\0';
+    if (readVersionBytes(subcls, version)) {
+        return cameraFormatVersion(out, size, version) < size;
+    }
+    return false;
+}
+
+bool CameraController::readDateText(uint8_t subcls, char* out, size_t size) {
+    uint32_t date;
+    out[0] = '\0';
+    if (readDateValue(subcls, date)) {
+        return cameraFormatDate(out, size, date) < size;
+    }
+    return false;
+}
+
+#if !CAMERA_STATIC_ALLOCATION
+String CameraController::getModel() {
+    char model[MAX_RESPONSE_SIZE];
+    getModel(model, sizeof(model));
+    return String(model);
+}
+
+String CameraController::getFPGAVersion() {
+    char text[CAMERA_VERSION_TEXT_SIZE];
+    readVersionText(0x03, text, sizeof(text));
+    return String(text);
+}
+
+String CameraController::getSoftwareVersion() {
+    char text[CAMERA_VERSION_TEXT_SIZE];
+    readVersionText(0x05, text, sizeof(text));
+    return String(text);
+}
+
+String CameraController::getFPGABuildDate() {
+    char text[CAMERA_VERSION_TEXT_SIZE];
+    readDateText(0x04, text, sizeof(text));
+    return String(text);
+}
+
+String CameraController::getSoftwareBuildDate() {
+    char text[CAMERA_VERSION_TEXT_SIZE];
+    readDateText(0x06, text, sizeof(text));
+    return String(text);
+}
+
+String CameraController::getCalibrationVersion() {
+    char text[CAMERA_VERSION_TEXT_SIZE];
+    readVersionText(0x07, text, sizeof(text));
+    return String(text);
+}
+
+String CameraController::getISPVersion() {
+    char text[CAMERA_VERSION_TEXT_SIZE];
+    readVersionText(0x08, text, sizeof(text));
+    return String(text);
+}
+#endif
+
 CameraStatus CameraController::getStatus() {
     if (sendCommand(CLASS_CAMERA, 0x14, FLAG_READ)) {
         if (_currentResponse.length >= 8) {
@@ -364,8 +827,7 @@ CameraStatus CameraController::getStatus() {
 // Control de imagen
 bool CameraController::setBrightness(uint8_t value) {
     if (value > 100) {
-        _lastError = "Brightness value out of range (0-100)";
-        return false;
+        return fail(CAMERA_ERR_OUT_OF_RANGE, CLASS_IMAGE, 0x02);
     }
     uint8_t data[] = {value};
     return sendCommand(CLASS_IMAGE, 0x02, FLAG_WRITE, data, 1);
@@ -373,8 +835,7 @@ bool CameraController::setBrightness(uint8_t value) {
 
 bool CameraController::setContrast(uint8_t value) {
     if (value > 100) {
-        _lastError = "Contrast value out of range (0-100)";
-        return false;
+        return fail(CAMERA_ERR_OUT_OF_RANGE, CLASS_IMAGE, 0x03);
     }
     uint8_t data[] = {value};
     return sendCommand(CLASS_IMAGE, 0x03, FLAG_WRITE, data, 1);
@@ -382,8 +843,7 @@ bool CameraController::setContrast(uint8_t value) {
 
 bool CameraController::setDigitalEnhancement(uint8_t value) {
     if (value > 100) {
-        _lastError = "Digital enhancement value out of range (0-100)";
-        return false;
+        return fail(CAMERA_ERR_OUT_OF_RANGE, CLASS_IMAGE, 0x10);
     }
     uint8_t data[] = {value};
     return sendCommand(CLASS_IMAGE, 0x10, FLAG_WRITE, data, 1);
@@ -391,8 +851,7 @@ bool CameraController::setDigitalEnhancement(uint8_t value) {
 
 bool CameraController::setStaticNoiseReduction(uint8_t value) {
     if (value > 100) {
-        _lastError = "Static noise reduction value out of range (0-100)";
-        return false;
+        return fail(CAMERA_ERR_OUT_OF_RANGE, CLASS_IMAGE, 0x15);
     }
     uint8_t data[] = {value};
     return sendCommand(CLASS_IMAGE, 0x15, FLAG_WRITE, data, 1);
@@ -400,8 +859,7 @@ bool CameraController::setStaticNoiseReduction(uint8_t value) {
 
 bool CameraController::setDynamicNoiseReduction(uint8_t value) {
     if (value > 100) {
-        _lastError = "Dynamic noise reduction value out of range (0-100)";
-        return false;
+        return fail(CAMERA_ERR_OUT_OF_RANGE, CLASS_IMAGE, 0x16);
     }
     uint8_t data[] = {value};
     return sendCommand(CLASS_IMAGE, 0x16, FLAG_WRITE, data, 1);
@@ -409,8 +867,7 @@ bool CameraController::setDynamicNoiseReduction(uint8_t value) {
 
 bool CameraController::setPalette(ColorPalette palette) {
     if (palette > PALETTE_COLOR7) {
-        _lastError = "Invalid palette value";
-        return false;
+        return fail(CAMERA_ERR_OUT_OF_RANGE, CLASS_IMAGE, 0x20);
     }
     uint8_t data[] = {(uint8_t)palette};
     return sendCommand(CLASS_IMAGE, 0x20, FLAG_WRITE, data, 1);
@@ -444,8 +901,7 @@ ColorPalette CameraController::getCurrentPalette() {
 // Control de obturador
 bool CameraController::setAutoShutter(AutoShutterMode mode) {
     if (mode > SHUTTER_FULL_AUTO) {
-        _lastError = "Invalid shutter mode";
-        return false;
+        return fail(CAMERA_ERR_OUT_OF_RANGE, CLASS_CAMERA, 0x04);
     }
     uint8_t data[] = {(uint8_t)mode};
     return sendCommand(CLASS_CAMERA, 0x04, FLAG_WRITE, data, 1);
@@ -487,8 +943,7 @@ bool CameraController::centerCursor() {
 
 bool CameraController::moveCursorUp(uint8_t pixels) {
     if (pixels == 0 || pixels > 15) {
-        _lastError = "Pixels out of range (1-15)";
-        return false;
+        return fail(CAMERA_ERR_OUT_OF_RANGE, CLASS_IMAGE, 0x1A);
     }
     
     if (pixels == 1) {
@@ -502,8 +957,7 @@ bool CameraController::moveCursorUp(uint8_t pixels) {
 
 bool CameraController::moveCursorDown(uint8_t pixels) {
     if (pixels == 0 || pixels > 15) {
-        _lastError = "Pixels out of range (1-15)";
-        return false;
+        return fail(CAMERA_ERR_OUT_OF_RANGE, CLASS_IMAGE, 0x1A);
     }
     
     if (pixels == 1) {
@@ -517,8 +971,7 @@ bool CameraController::moveCursorDown(uint8_t pixels) {
 
 bool CameraController::moveCursorLeft(uint8_t pixels) {
     if (pixels == 0 || pixels > 15) {
-        _lastError = "Pixels out of range (1-15)";
-        return false;
+        return fail(CAMERA_ERR_OUT_OF_RANGE, CLASS_IMAGE, 0x1A);
     }
     
     if (pixels == 1) {
@@ -532,8 +985,7 @@ bool CameraController::moveCursorLeft(uint8_t pixels) {
 
 bool CameraController::moveCursorRight(uint8_t pixels) {
     if (pixels == 0 || pixels > 15) {
-        _lastError = "Pixels out of range (1-15)";
-        return false;
+        return fail(CAMERA_ERR_OUT_OF_RANGE, CLASS_IMAGE, 0x1A);
     }
     
     if (pixels == 1) {
@@ -566,126 +1018,180 @@ bool CameraController::restoreFactory() {
 
 // Funciones de utilidad
 bool CameraController::isConnected() {
-    String model = getModel();
-    return (model.length() > 0);
+    char model[CAMERA_MODEL_SIZE];
+    return getModel(model, sizeof(model));
 }
 
-String CameraController::getLastError() {
+CameraErrorCode CameraController::getLastErrorCode() const {
     return _lastError;
 }
 
+size_t CameraController::getResponseData(uint8_t* out, size_t size) const {
+    if (!_currentResponse.complete || !_currentResponse.valid || _currentResponse.length < 9) {
+        return 0;
+    }
+    // F0 SIZE DEV CLS SUB FLAG LEN DATA... CHK FF
+    size_t length = _currentResponse.length - 9;
+    if (length > size) {
+        length = size;
+    }
+    memcpy(out, &_currentResponse.data[7], length);
+    return length;
+}
+
+const char* CameraController::getLastErrorText() const {
+    return cameraErrorText(_lastError);
+}
+
+CommandStatus CameraController::getLastCommandStatus() const {
+    return _lastStatus;
+}
+
+uint32_t CameraController::getErrorCount(CameraErrorCode code) const {
+    return (code < CAMERA_ERR_COUNT) ? _errorCounts[code] : 0;
+}
+
+void CameraController::resetErrorCounts() {
+    for (uint8_t i = 0; i < CAMERA_ERR_COUNT; i++) {
+        _errorCounts[i] = 0;
+    }
+}
+
+#if !CAMERA_STATIC_ALLOCATION
+String CameraController::getLastError() {
+    return String(getLastErrorText());
+}
+#endif
+
 void CameraController::enableDebug(bool enable) {
     _debugEnabled = enable;
+#if CAMERA_LOG_LEVEL > CAMERA_LOG_NONE
+    _log.setEnabled(enable);
+#endif
+}
+
+void CameraController::setWaitInterrupt(bool (*check)(void* context), void* context) {
+    _waitInterrupt = check;
+    _waitInterruptContext = context;
 }
 
 void CameraController::setTimeouts(unsigned long responseTimeout, unsigned long byteTimeout) {
     _responseTimeout = responseTimeout;
     _byteTimeout = byteTimeout;
     
-    if (_debugEnabled) {
-        Serial.println("Timeouts set - Response: " + String(_responseTimeout) + "ms, Byte: " + String(_byteTimeout) + "ms");
-    }
+#if CAMERA_LOG_LEVEL >= CAMERA_LOG_INFO
+    uint8_t entry[8];
+    for (uint8_t i = 0; i < 4; i++) {
+        entry[i] = (uint8_t)(_responseTimeout >> (8 * i));
+        entry[4 + i] = (uint8_t)(_byteTimeout >> (8 * i));
+    }
+    CAMERA_LOG_AT(CAMERA_LOG_INFO, _log, LOG_EVENT_CONFIG, entry, sizeof(entry));
+#endif
+}
+
+void CameraController::setGlobalResponseTextHandler(ResponseTextCallback callback) {
+    _globalTextCallback = callback;
 }
 
+#if !CAMERA_STATIC_ALLOCATION
 void CameraController::setGlobalResponseHandler(ResponseCallback callback) {
     _globalCallback = callback;
 }
+#endif
 
 bool CameraController::getDeviceInfo(CameraInfo& info) {
-    // Leer modelo
-    info.model = getModel();
-    if (info.model.length() == 0) {
-        _lastError = "Failed to read device model";
+    char text[MAX_RESPONSE_SIZE];
+
+    // Leer modelo (si no cabe en info.model se corta y se devuelve false)
+    if (!getModel(text, sizeof(text))) {
+        assignText(info.model, "");
         return false;
     }
-    
+    bool complete = assignText(info.model, text);
+
+#if CAMERA_STATIC_ALLOCATION
+    // Versiones y fechas directamente en su campo: siempre caben (static_assert en CameraController.h)
+    readVersionText(0x03, info.fpgaVersion, sizeof(info.fpgaVersion));
+    readDateText(0x04, info.fpgaBuildDate, sizeof(info.fpgaBuildDate));
+    readVersionText(0x05, info.softwareVersion, sizeof(info.softwareVersion));
+    readDateText(0x06, info.softwareBuildDate, sizeof(info.softwareBuildDate));
+    readVersionText(0x07, info.calibrationVersion, sizeof(info.calibrationVersion));
+    readVersionText(0x08, info.ispVersion, sizeof(info.ispVersion));
+#else
     // Leer versión FPGA
-    info.fpgaVersion = getFPGAVersion();
+    readVersionText(0x03, text, sizeof(text));
+    assignText(info.fpgaVersion, text);
     
     // Leer fecha de compilación FPGA
-    if (sendCommand(CLASS_INFO, 0x04, FLAG_READ)) {
-        if (_currentResponse.length >= 11) {
-            uint32_t fecha = (_currentResponse.data[7] << 24) | 
-                            (_currentResponse.data[8] << 16) | 
-                            (_currentResponse.data[9] << 8) | 
-                            _currentResponse.data[10];
-            info.fpgaBuildDate = String(fecha / 10000) + "-" + 
-                               String((fecha / 100) % 100) + "-" + 
-                               String(fecha % 100);
-        }
-    }
+    readDateText(0x04, text, sizeof(text));
+    assignText(info.fpgaBuildDate, text);
     
     // Leer versión software
-    info.softwareVersion = getSoftwareVersion();
+    readVersionText(0x05, text, sizeof(text));
+    assignText(info.softwareVersion, text);
     
     // Leer fecha de compilación software
-    if (sendCommand(CLASS_INFO, 0x06, FLAG_READ)) {
-        if (_currentResponse.length >= 11) {
-            uint32_t fecha = (_currentResponse.data[7] << 24) | 
-                            (_currentResponse.data[8] << 16) | 
-                            (_currentResponse.data[9] << 8) | 
-                            _currentResponse.data[10];
-            info.softwareBuildDate = String(fecha / 10000) + "-" + 
-                                   String((fecha / 100) % 100) + "-" + 
-                                   String(fecha % 100);
-        }
-    }
+    readDateText(0x06, text, sizeof(text));
+    assignText(info.softwareBuildDate, text);
     
     // Leer versión de calibración
-    if (sendCommand(CLASS_INFO, 0x07, FLAG_READ)) {
-        if (_currentResponse.length >= 10) {
-            info.calibrationVersion = String(_currentResponse.data[7]) + "." + 
-                                     String(_currentResponse.data[8]) + "." + 
-                                     String(_currentResponse.data[9]);
-        }
-    }
+    readVersionText(0x07, text, sizeof(text));
+    assignText(info.calibrationVersion, text);
     
     // Leer versión ISP
-    if (sendCommand(CLASS_INFO, 0x08, FLAG_READ)) {
-        if (_currentResponse.length >= 10) {
-            info.ispVersion = String(_currentResponse.data[7]) + "." + 
-                             String(_currentResponse.data[8]) + "." + 
-                             String(_currentResponse.data[9]);
-        }
-    }
-    
+    readVersionText(0x08, text, sizeof(text));
+    assignText(info.ispVersion, text);
+#endif
+
     // Leer estado
     info.status = getStatus();
     
-    return true;
+    return complete;
 }
 
 
-String CameraController::getFPGABuildDate() {
-    if (sendCommand(CLASS_INFO, 0x04, FLAG_READ)) {
-        if (_currentResponse.length >= 11) {
-            uint32_t fecha = (_currentResponse.data[7] << 24) | 
-                            (_currentResponse.data[8] << 16) | 
-                            (_currentResponse.data[9] << 8) | 
-                            _currentResponse.data[10];
-            return String(fecha / 10000) + "-" + 
-                   String((fecha / 100) % 100) + "-" + 
-                   String(fecha % 100);
-        }
-    }
-    return "";
-}
+bool CameraController::getDeviceInfo(CameraInfoPacked& info) {
+    memset(&info, 0, sizeof(info));
 
-String CameraController::getSoftwareBuildDate() {
-    if (sendCommand(CLASS_INFO, 0x06, FLAG_READ)) {
-        if (_currentResponse.length >= 11) {
-            uint32_t fecha = (_currentResponse.data[7] << 24) | 
-                            (_currentResponse.data[8] << 16) | 
-                            (_currentResponse.data[9] << 8) | 
-                            _currentResponse.data[10];
-            return String(fecha / 10000) + "-" + 
-                   String((fecha / 100) % 100) + "-" + 
-                   String(fecha % 100);
-        }
+    if (!getModel(info.model, sizeof(info.model))) {
+        memset(info.model, 0, sizeof(info.model));
+        return false;
     }
-    return "";
+
+    readVersionBytes(0x03, info.fpgaVersion);
+    readDateValue(0x04, info.fpgaBuildDate);
+    readVersionBytes(0x05, info.softwareVersion);
+    readDateValue(0x06, info.softwareBuildDate);
+    readVersionBytes(0x07, info.calibrationVersion);
+    readVersionBytes(0x08, info.ispVersion);
+    info.status = (uint8_t)getStatus();
+
+    return true;
 }
 
+void cameraUnpackInfo(const CameraInfoPacked& packed, CameraInfo& info) {
+    char text[sizeof(packed.model) + 1];
+
+    // model puede no llevar '\0' si viene de datos serializados
+    size_t n = strnlen(packed.model, sizeof(packed.model));
+    memcpy(text, packed.model, n);
+    text[n] = '\0';
+    assignText(info.model, text);
+
+    cameraFormatVersion(text, sizeof(text), packed.fpgaVersion);
+    assignText(info.fpgaVersion, text);
+    cameraFormatDate(text, sizeof(text), packed.fpgaBuildDate);
+    assignText(info.fpgaBuildDate, text);
+    cameraFormatVersion(text, sizeof(text), packed.softwareVersion);
+    assignText(info.softwareVersion, text);
+    cameraFormatDate(text, sizeof(text), packed.softwareBuildDate);
+    assignText(info.softwareBuildDate, text);
+    cameraFormatVersion(text, sizeof(text), packed.calibrationVersion);
+    assignText(info.calibrationVersion, text);
+    cameraFormatVersion(text, sizeof(text), packed.ispVersion);
+    assignText(info.ispVersion, text);
+    info.status = (CameraStatus)packed.status;
+}
 
 uint8_t CameraController::getDigitalEnhancement() {
     if (sendCommand(CLASS_IMAGE, 0x10, FLAG_READ) && _currentResponse.length >= 8) {
@@ -720,8 +1226,7 @@ MirrorMode CameraController::getCurrentMirror() {
 
 bool CameraController::setMirror(MirrorMode mode) {
     if (mode > MIRROR_VERTICAL) {
-        _lastError = "Invalid mirror mode";
-        return false;
+        return fail(CAMERA_ERR_OUT_OF_RANGE, CLASS_MIRROR, 0x11);
     }
     uint8_t data[] = {(uint8_t)mode};
     return sendCommand(CLASS_MIRROR, 0x11, FLAG_WRITE, data, 1);
@@ -744,368 +1249,23 @@ uint16_t CameraController::getShutterInterval() {
     return 0;
 }
 
-String CameraController::getCalibrationVersion() {
-    if (sendCommand(CLASS_INFO, 0x07, FLAG_READ)) {
-        if (_currentResponse.length >= 10) {
-            return String(_currentResponse.data[7]) + "." + 
-                   String(_currentResponse.data[8]) + "." + 
-                   String(_currentResponse.data[9]);
-        }
+// INTERPRETACIÓN COMPLETA DE RESPUESTAS - tablas y decodificador en CameraText.cpp
+// Escribe el texto en un buffer del llamador para no reservar heap por respuesta.
+size_t CameraController::interpretResponse(char* out, size_t size) {
+    if (!_currentResponse.valid) {
+        return cameraInterpretFrame(_currentResponse.data, 0, out, size);
     }
-    return "";
-}
 
-String CameraController::getISPVersion() {
-    if (sendCommand(CLASS_INFO, 0x08, FLAG_READ)) {
-        if (_currentResponse.length >= 10) {
-            return String(_currentResponse.data[7]) + "." + 
-                   String(_currentResponse.data[8]) + "." + 
-                   String(_currentResponse.data[9]);
-        }
-    }
-    return "";
+    return cameraInterpretFrame(_currentResponse.data, _currentResponse.length, out, size);
 }
 
-// INTERPRETACIÓN COMPLETA DE RESPUESTAS - IGUAL QUE EL CÓDIGO ORIGINAL
+#if !CAMERA_STATIC_ALLOCATION
 String CameraController::interpretResponse() {
-    if (!_currentResponse.valid || _currentResponse.length < 7) {
-        return "Invalid response";
-    }
-    
-    uint8_t* resp = _currentResponse.data;
-    uint8_t header = resp[0];      // 0xF0
-    uint8_t length = resp[1];      // 0x05
-    uint8_t device = resp[2];      // 0x36
-    uint8_t classByte = resp[3];   // 0x78
-    uint8_t subClassByte = resp[4]; // 0x20
-    uint8_t rwFlag = resp[5];      // 0x03
-    uint8_t dataLength = resp[6];  // 0x01
-    // Datos empiezan en resp[7]
-    
-    String interpretation = "";
-    
-    if (_debugEnabled) {
-        Serial.println("\n=== INTERPRETACIÓN DE RESPUESTA ===");
-        Serial.printf("📋 Estructura: H=0x%02X L=0x%02X D=0x%02X C=0x%02X S=0x%02X R=0x%02X DL=0x%02X\n", 
-                      header, length, device, classByte, subClassByte, rwFlag, dataLength);
-
-        // Imprimir respuesta completa en todos los formatos
-        Serial.print("🔍 Respuesta completa (hex): ");
-        for (size_t i = 0; i < _currentResponse.length; i++) {
-            if (resp[i] < 0x10) Serial.print("0");
-            Serial.print(resp[i], HEX);
-            Serial.print(" ");
-        }
-        Serial.println();
-        
-        Serial.print("🔍 Respuesta completa (bin): ");
-        for (size_t i = 0; i < _currentResponse.length; i++) {
-            Serial.print(resp[i], BIN);
-            Serial.print(" ");
-        }
-        Serial.println();
-
-        Serial.print("🔍 Respuesta completa (dec): ");
-        for (size_t i = 0; i < _currentResponse.length; i++) {
-            Serial.print(resp[i], DEC);
-            Serial.print(" ");
-        }
-        Serial.println();
-
-        Serial.print("🔍 Respuesta completa (oct): ");
-        for (size_t i = 0; i < _currentResponse.length; i++) {
-            Serial.print(resp[i], OCT);
-            Serial.print(" ");
-        }
-        Serial.println();
-    }
-
-    // COMANDOS DE LECTURA DE INFORMACIÓN (Clase 0x74)
-    if (classByte == 0x74) {
-        switch (subClassByte) {
-            case 0x02: // Modelo del módulo (ASCII)
-                {
-                    String model = "";
-                    for (int i = 7; i < 7 + dataLength; i++) {
-                        if (i < _currentResponse.length - 2) model += (char)resp[i];
-                    }
-                    interpretation = "📦 Modelo del módulo: " + model;
-                }
-                break;
-                
-            case 0x03: // Versión FPGA
-                if (dataLength >= 3) {
-                    interpretation = "🔧 Versión FPGA: " + String(resp[7]) + "." + String(resp[8]) + "." + String(resp[9]);
-                }
-                break;
-                
-            case 0x04: // Compilación FPGA
-                if (dataLength >= 4) {
-                    uint32_t fecha = (resp[7] << 24) | (resp[8] << 16) | (resp[9] << 8) | resp[10];
-                    interpretation = "📅 Compilación FPGA: " + String(fecha / 10000) + "-" + String((fecha / 100) % 100) + "-" + String(fecha % 100);
-                }
-                break;
-                
-            case 0x05: // Versión software
-                if (dataLength >= 3) {
-                    interpretation = "💾 Versión software: " + String(resp[7]) + "." + String(resp[8]) + "." + String(resp[9]);
-                }
-                break;
-                
-            case 0x06: // Compilación software
-                if (dataLength >= 4) {
-                    uint32_t fecha = (resp[7] << 24) | (resp[8] << 16) | (resp[9] << 8) | resp[10];
-                    interpretation = "📅 Compilación software: " + String(fecha / 10000) + "-" + String((fecha / 100) % 100) + "-" + String(fecha % 100);
-                }
-                break;
-                
-            case 0x0B: // Versión calibración cámara
-                if (dataLength >= 4) {
-                    uint32_t fecha = (resp[7] << 24) | (resp[8] << 16) | (resp[9] << 8) | resp[10];
-                    interpretation = "📷 Versión calibración cámara: " + String(fecha / 10000) + "-" + String((fecha / 100) % 100) + "-" + String(fecha % 100);
-                }
-                break;
-                
-            case 0x0C: // Versión parámetros ISP
-                if (dataLength >= 4) {
-                    interpretation = "⚙️  Versión parámetros ISP: 0x" + String(resp[7], HEX) + String(resp[8], HEX) + String(resp[9], HEX) + String(resp[10], HEX);
-                }
-                break;
-                
-            case 0x10: // Guardar configuración
-                interpretation = "💾 Configuración guardada correctamente";
-                break;
-                
-            case 0x0F: // Restaurar fábrica
-                interpretation = "🔄 Configuración de fábrica restaurada";
-                break;
-                
-            default:
-                interpretation = "❓ Comando clase 0x74, subclase 0x" + String(subClassByte, HEX) + " no interpretado";
-                break;
-        }
-    }
-    // COMANDOS DE CONTROL DE CÁMARA (Clase 0x7C)
-    else if (classByte == 0x7C) {
-        switch (subClassByte) {
-            case 0x14: // Estado de inicialización
-                if (dataLength >= 1) {
-                    switch (resp[7]) {
-                        case 0x00:
-                            interpretation = "📺 Estado: Inicializando (loading)";
-                            break;
-                        case 0x01:
-                            interpretation = "📺 Estado: Video activo (output)";
-                            break;
-                        default:
-                            interpretation = "📺 Estado desconocido: 0x" + String(resp[7], HEX);
-                            break;
-                    }
-                }
-                break;
-                
-            case 0x02: // Calibración obturador manual
-                interpretation = "🎯 Calibración de obturador manual ejecutada";
-                break;
-                
-            case 0x03: // Corrección de fondo manual
-                interpretation = "🎨 Corrección de fondo manual ejecutada";
-                break;
-                
-            case 0x04: // Control auto obturador
-                if (dataLength >= 1) {
-                    const char* modos[] = {"Deshabilitado", "Manual", "Automático", "Totalmente automático"};
-                    int modo = resp[7];
-                    if (modo <= 3) {
-                        if (rwFlag == 0x01) {
-                            interpretation = "📷 Obturador automático actual: " + String(modos[modo]) + " (valor: " + String(modo) + ")";
-                        } else {
-                            interpretation = "📷 Obturador automático configurado: " + String(modos[modo]);
-                        }
-                    } else {
-                        interpretation = "📷 Modo obturador: 0x" + String(resp[7], HEX);
-                    }
-                }
-                break;
-                
-            case 0x05: // Intervalo obturación automático
-                if (dataLength >= 2) {
-                    uint16_t minutos = (resp[7] << 8) | resp[8];
-                    if (rwFlag == 0x01) {
-                        interpretation = "⏱️  Intervalo obturación automático actual: " + String(minutos) + " minutos";
-                    } else {
-                        interpretation = "⏱️  Intervalo obturación automático configurado: " + String(minutos) + " minutos";
-                    }
-                } else if (dataLength >= 1) {
-                    if (rwFlag == 0x01) {
-                        interpretation = "⏱️  Intervalo obturación automático actual: " + String(resp[7]) + " minutos";
-                    } else {
-                        interpretation = "⏱️  Intervalo obturación automático configurado: " + String(resp[7]) + " minutos";
-                    }
-                }
-                break;
-                
-            case 0x0C: // Corrección viñeteado
-                interpretation = "🔧 Corrección de viñeteado ejecutada";
-                break;
-                
-            default:
-                interpretation = "❓ Comando clase 0x7C, subclase 0x" + String(subClassByte, HEX) + " no interpretado";
-                break;
-        }
-    }
-    // COMANDOS DE IMAGEN (Clase 0x78)
-    else if (classByte == 0x78) {
-        switch (subClassByte) {
-            case 0x02: // Brillo
-                if (dataLength >= 1) {
-                    if (rwFlag == 0x01) {
-                        interpretation = "☀️  Brillo actual: " + String(resp[7]) + "/100";
-                    } else {
-                        interpretation = "☀️  Brillo configurado: " + String(resp[7]) + "/100";
-                    }
-                }
-                break;
-                
-            case 0x03: // Contraste
-                if (dataLength >= 1) {
-                    if (rwFlag == 0x01) {
-                        interpretation = "🌗 Contraste actual: " + String(resp[7]) + "/100";
-                    } else {
-                        interpretation = "🌗 Contraste configurado: " + String(resp[7]) + "/100";
-                    }
-                }
-                break;
-                
-            case 0x10: // Mejora digital de detalle
-                if (dataLength >= 1) {
-                    if (rwFlag == 0x01) {
-                        interpretation = "🔍 Mejora digital detalle actual: " + String(resp[7]) + "/100";
-                    } else {
-                        interpretation = "🔍 Mejora digital detalle configurado: " + String(resp[7]) + "/100";
-                    }
-                }
-                break;
-                
-            case 0x15: // Denoising estático
-                if (dataLength >= 1) {
-                    if (rwFlag == 0x01) {
-                        interpretation = "🔇 Reducción ruido estático actual: " + String(resp[7]) + "/100";
-                    } else {
-                        interpretation = "🔇 Reducción ruido estático configurado: " + String(resp[7]) + "/100";
-                    }
-                }
-                break;
-                
-            case 0x16: // Denoising dinámico
-                if (dataLength >= 1) {
-                    if (rwFlag == 0x01) {
-                        interpretation = "🔊 Reducción ruido dinámico actual: " + String(resp[7]) + "/100";
-                    } else {
-                        interpretation = "🔊 Reducción ruido dinámico configurado: " + String(resp[7]) + "/100";
-                    }
-                }
-                break;
-                
-            case 0x20: // Paleta de colores
-                if (dataLength >= 1) {
-                    const char* paletas[] = {
-                        "White Hot", "Black Hot", "Iron", "Rainbow", "Rain", 
-                        "Ice Fire", "Fusion", "Sepia", "Color1", "Color2", 
-                        "Color3", "Color4", "Color5", "Color6", "Color7"
-                    };
-                    
-                    // ANÁLISIS CORRECTO DE LA RESPUESTA DE PALETA:
-                    // Según main copy.cpp, el valor real está en resp[6], no en resp[7]
-                    int paleta = resp[6];  // USAR resp[6] para paleta
-                    
-                    if (_debugEnabled) {
-                        Serial.printf("🔍 Debug: Valor leído en resp[6] = 0x%02X (%d)\n", paleta, paleta);
-                    }
-
-                    if (paleta <= 14) {
-                        if (rwFlag == 0x01) {
-                            interpretation = "🎨 Paleta actual: " + String(paletas[paleta]) + " (valor: 0x" + String(paleta, HEX) + ")";
-                        } else {
-                            interpretation = "🎨 Paleta configurada: " + String(paletas[paleta]) + " (valor: 0x" + String(paleta, HEX) + ")";
-                        }
-                    } else {
-                        interpretation = "🎨 Paleta: Modo desconocido 0x" + String(paleta, HEX);
-                    }
-                }
-                break;
-                
-            case 0x1A: // Comandos de cursor
-                if (dataLength >= 1) {
-                    uint8_t cursorData = resp[7];
-                    
-                    switch (cursorData) {
-                        case 0x00: interpretation = "👁️‍🗨️ Cursor ocultado"; break;
-                        case 0x02: interpretation = "⬆️  Cursor movido arriba"; break;
-                        case 0x03: interpretation = "⬇️  Cursor movido abajo"; break;
-                        case 0x04: interpretation = "⬅️  Cursor movido izquierda"; break;
-                        case 0x05: interpretation = "➡️  Cursor movido derecha"; break;
-                        case 0x06: interpretation = "🎯 Cursor centrado"; break;
-                        case 0x0D: interpretation = "❌ Píxel defectuoso agregado"; break;
-                        case 0x0E: interpretation = "✅ Píxel defectuoso removido"; break;
-                        case 0x0F: interpretation = "👁️  Cursor mostrado"; break;
-                        default:
-                            // Comandos de movimiento múltiple
-                            if ((cursorData & 0xF0) == 0x20) {
-                                interpretation = "⬆️  Cursor movido " + String(cursorData & 0x0F) + " píxeles arriba";
-                            } else if ((cursorData & 0xF0) == 0x30) {
-                                interpretation = "⬇️  Cursor movido " + String(cursorData & 0x0F) + " píxeles abajo";
-                            } else if ((cursorData & 0xF0) == 0x40) {
-                                interpretation = "⬅️  Cursor movido " + String(cursorData & 0x0F) + " píxeles izquierda";
-                            } else if ((cursorData & 0xF0) == 0x50) {
-                                interpretation = "➡️  Cursor movido " + String(cursorData & 0x0F) + " píxeles derecha";
-                            } else {
-                                interpretation = "🖱️  Comando cursor: 0x" + String(cursorData, HEX);
-                            }
-                            break;
-                    }
-                }
-                break;
-                
-            default:
-                interpretation = "❓ Comando clase 0x78, subclase 0x" + String(subClassByte, HEX) + " no interpretado";
-                break;
-        }
-    }
-    // COMANDOS DE MIRRORING (Clase 0x70)
-    else if (classByte == 0x70) {
-        switch (subClassByte) {
-            case 0x11: // Mirroring
-                if (dataLength >= 1) {
-                    const char* modos[] = {"Deshabilitado", "Central", "Horizontal", "Vertical"};
-                    int modo = resp[7];
-                    if (modo <= 3) {
-                        if (rwFlag == 0x01) {
-                            interpretation = "🪞 Mirroring actual: " + String(modos[modo]) + " (valor: " + String(modo) + ")";
-                        } else {
-                            interpretation = "🪞 Mirroring configurado: " + String(modos[modo]);
-                        }
-                    } else {
-                        interpretation = "🪞 Mirroring: Modo " + String(resp[7]);
-                    }
-                }
-                break;
-                
-            default:
-                interpretation = "❓ Comando clase 0x70, subclase 0x" + String(subClassByte, HEX) + " no interpretado";
-                break;
-        }
-    }
-    else {
-        interpretation = "❓ Clase 0x" + String(classByte, HEX) + " no reconocida";
-    }
-    
-    if (_debugEnabled) {
-        Serial.println("====================================\n");
-    }
-    
-    return interpretation;
+    char text[CAMERA_TEXT_SIZE];
+    interpretResponse(text, sizeof(text));
+    return String(text);
 }
+#endif
 
 // Métodos para comandos de lectura
 bool CameraController::readDeviceModel() {
@@ -0,0 +1,180 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraCoroutine.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: C++20 coroutine API to sequence multi-step camera procedures
+*/
+
+#include "CameraCoroutine.h"
+
+#if CAMERA_HAS_COROUTINES
+
+#include "CameraClock.h"
+
+CameraProcedure& CameraProcedure::operator=(CameraProcedure&& other) noexcept {
+    if (this != &other) {
+        if (_handle) {
+            _handle.destroy();
+        }
+        _handle = other._handle;
+        other._handle = nullptr;
+    }
+    return *this;
+}
+
+CameraProcedure::~CameraProcedure() {
+    if (_handle) {
+        _handle.destroy();
+    }
+}
+
+bool CameraAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    _handle = handle;
+    return _sequencer.suspend(this);
+}
+
+CameraSequencer::CameraSequencer(CameraTask& io)
+    : _io(io), _procedureCount(0), _eventHandler(nullptr), _finishedHandler(nullptr) {
+    for (size_t i = 0; i < CAMERA_CORO_WAITERS; i++) {
+        _waiters[i] = nullptr;
+    }
+}
+
+CameraSequencer::~CameraSequencer() {
+    // Destruir un procedimiento raíz destruye también los anidados que esperaba
+    for (size_t i = 0; i < _procedureCount; i++) {
+        _procedures[i].destroy();
+    }
+}
+
+bool CameraSequencer::start(CameraProcedure procedure) {
+    if (!procedure.valid() || _procedureCount >= CAMERA_CORO_PROCEDURES) {
+        return false;
+    }
+    CameraProcedure::Handle handle = procedure.release();
+    _procedures[_procedureCount++] = handle;
+    handle.resume();
+    reap();
+    return true;
+}
+
+CameraAwaiter CameraSequencer::command(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t* data, uint8_t length,
+                                       CameraPriority priority) {
+    CameraAwaiter awaiter(*this);
+    awaiter._request = CameraTask::prepare(cls, subcls, rw, data, length, priority);
+    return awaiter;
+}
+
+CameraAwaiter CameraSequencer::read(uint8_t cls, uint8_t subcls, CameraPriority priority) {
+    return command(cls, subcls, FLAG_READ, nullptr, 0, priority);
+}
+
+CameraAwaiter CameraSequencer::write(uint8_t cls, uint8_t subcls, const uint8_t* data, uint8_t length,
+                                     CameraPriority priority) {
+    return command(cls, subcls, FLAG_WRITE, data, length, priority);
+}
+
+CameraAwaiter CameraSequencer::delay(uint32_t ms) {
+    CameraAwaiter awaiter(*this);
+    awaiter._isDelay = true;
+    awaiter._wakeMs = cameraMillis() + ms;
+    return awaiter;
+}
+
+/**
+ * Registra una espera. Sin hueco libre no se suspende y el co_await
+ * devuelve CAMERA_ERR_ABORTED.
+ * @return true si la corrutina queda suspendida.
+ */
+bool CameraSequencer::suspend(CameraAwaiter* awaiter) {
+    for (size_t i = 0; i < CAMERA_CORO_WAITERS; i++) {
+        if (!_waiters[i]) {
+            _waiters[i] = awaiter;
+            if (!awaiter->_isDelay) {
+                submit(awaiter);
+            }
+            return true;
+        }
+    }
+    awaiter->_event.code = CAMERA_ERR_ABORTED;
+    awaiter->_event.length = 0;
+    return false;
+}
+
+void CameraSequencer::submit(CameraAwaiter* awaiter) {
+    const CameraRequest& r = awaiter->_request;
+    awaiter->_id = _io.post(r.cls, r.subcls, r.rw, r.data, r.length, (CameraPriority)r.priority);
+}
+
+/**
+ * Libera los procedimientos raíz terminados e informa de su código.
+ */
+void CameraSequencer::reap() {
+    size_t i = 0;
+    while (i < _procedureCount) {
+        CameraProcedure::Handle handle = _procedures[i];
+        if (!handle.done()) {
+            i++;
+            continue;
+        }
+        CameraErrorCode code = handle.promise().result;
+        handle.destroy();
+        _procedures[i] = _procedures[--_procedureCount];
+        if (_finishedHandler) {
+            _finishedHandler(code);
+        }
+    }
+}
+
+size_t CameraSequencer::update() {
+    // Sin tarea de E/S (un solo núcleo) los comandos avanzan aquí
+    if (_io.cooperative()) {
+        _io.pollIo();
+    } else if (!_io.running()) {
+        _io.service();
+    }
+
+    CameraEvent event;
+    while (_io.poll(event)) {
+        CameraAwaiter* owner = nullptr;
+        for (size_t i = 0; i < CAMERA_CORO_WAITERS && event.id != 0; i++) {
+            if (_waiters[i] && !_waiters[i]->_isDelay && _waiters[i]->_id == event.id) {
+                owner = _waiters[i];
+                _waiters[i] = nullptr;
+                break;
+            }
+        }
+        if (owner) {
+            owner->_event = event;
+            owner->_handle.resume();
+        } else if (_eventHandler) {
+            _eventHandler(event);
+        }
+    }
+
+    uint32_t now = cameraMillis();
+    for (size_t i = 0; i < CAMERA_CORO_WAITERS; i++) {
+        CameraAwaiter* waiter = _waiters[i];
+        if (!waiter) {
+            continue;
+        }
+        if (!waiter->_isDelay) {
+            if (waiter->_id == 0) {
+                submit(waiter); // la cola estaba llena: reintentar
+            }
+        } else if ((int32_t)(now - waiter->_wakeMs) >= 0) {
+            _waiters[i] = nullptr;
+            waiter->_event.code = CAMERA_OK;
+            waiter->_event.length = 0;
+            waiter->_handle.resume();
+        }
+    }
+
+    reap();
+    return _procedureCount;
+}
+
+#endif // CAMERA_HAS_COROUTINES
@@ -0,0 +1,360 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraGroup.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Several cameras on their own UARTs, scheduled concurrently
+*/
+
+#include "CameraGroup.h"
+#include "CameraClock.h"
+
+CameraGroup::CameraGroup()
+    : _count(0), _batchCount(0), _batchStartUs(0), _ffcPending(0), _ffcNext(0), _ffcIssued(false), _lastFfcUs(0),
+      _ffcStaggerMs(CAMERA_FFC_STAGGER_MS), _ffcIntervalMs(0), _lastPeriodicMs(0), _ffcSeen(false),
+      _lastFfcCamera(0), _lastFfcStartUs(0), _eventHandler(nullptr) {
+    for (size_t i = 0; i < CAMERA_GROUP_MAX; i++) {
+        _members[i] = nullptr;
+        _batchNext[i] = 0;
+        _batchRetry[i] = 0;
+        _batchCode[i] = CAMERA_OK;
+        _ffcIds[i] = 0;
+    }
+    resetStats();
+}
+
+int CameraGroup::add(CameraTask& io) {
+    if (_count >= CAMERA_GROUP_MAX) {
+        return -1;
+    }
+    _members[_count] = &io;
+    return (int)_count++;
+}
+
+bool CameraGroup::begin() {
+    if (_count == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < _count; i++) {
+        if (!_members[i]->running()) {
+            _members[i]->beginCooperative();
+        }
+    }
+    _lastPeriodicMs = cameraMillis();
+    return true;
+}
+
+void CameraGroup::end() {
+    for (size_t i = 0; i < _count; i++) {
+        if (_members[i]->cooperative()) {
+            _members[i]->end();
+        }
+        _batchNext[i] = 0;
+        _batchRetry[i] = 0;
+        _ffcIds[i] = 0;
+    }
+    _batchCount = 0;
+    _ffcPending = 0;
+    _ffcIntervalMs = 0;
+}
+
+// ============================================================================
+// DIFUSIÓN
+// ============================================================================
+
+bool CameraGroup::broadcast(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t* data, uint8_t length,
+                            CameraPriority priority) {
+    if (_batchCount >= CAMERA_GROUP_BATCH || length > CAMERA_REQUEST_DATA) {
+        return false;
+    }
+    if (_batchCount == 0) {
+        // Lote nuevo: los resultados del anterior dejan de valer
+        _batchStartUs = cameraMicros();
+        for (size_t i = 0; i < CAMERA_GROUP_MAX; i++) {
+            _batchCode[i] = CAMERA_OK;
+        }
+    }
+    for (size_t i = 0; i < _count; i++) {
+        _batchIds[i][_batchCount] = 0;
+    }
+    _batch[_batchCount++] = CameraTask::prepare(cls, subcls, rw, data, length, priority);
+    return true;
+}
+
+bool CameraGroup::setPaletteAll(ColorPalette palette) {
+    if (palette > PALETTE_COLOR7) {
+        return false;
+    }
+    uint8_t value = (uint8_t)palette;
+    return broadcast(CLASS_IMAGE, 0x20, FLAG_WRITE, &value, 1);
+}
+
+bool CameraGroup::applyAll(const CameraSetting* settings, size_t count) {
+    if (_batchCount + count > CAMERA_GROUP_BATCH) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        broadcast(settings[i].cls, settings[i].subcls, FLAG_WRITE, &settings[i].value, 1);
+    }
+    return true;
+}
+
+CameraErrorCode CameraGroup::waitBroadcast(uint32_t timeoutMs) {
+    uint32_t start = cameraMillis();
+    while (_batchCount > 0) {
+        if (cameraMillis() - start >= timeoutMs) {
+            return CAMERA_ERR_TIMEOUT;
+        }
+        update();
+        if (_batchCount > 0) {
+            cameraDelay(1);
+        }
+    }
+    for (size_t i = 0; i < _count; i++) {
+        if (_batchCode[i] != CAMERA_OK) {
+            return _batchCode[i];
+        }
+    }
+    return CAMERA_OK;
+}
+
+/**
+ * Envía a una cámara lo que le quepa del lote; el resto, en la próxima vuelta.
+ */
+void CameraGroup::feed(uint8_t index) {
+    CameraTask& io = *_members[index];
+    for (size_t k = 0; _batchRetry[index] && k < _batchNext[index]; k++) {
+        if (!(_batchRetry[index] & (1UL << k))) {
+            continue;
+        }
+        const CameraRequest& r = _batch[k];
+        uint32_t id = io.post(r.cls, r.subcls, r.rw, r.length ? r.data : nullptr, r.length,
+                              (CameraPriority)r.priority);
+        if (!id) {
+            return; // cola llena
+        }
+        _batchIds[index][k] = id;
+        _batchRetry[index] &= ~(1UL << k);
+    }
+    while (_batchNext[index] < _batchCount) {
+        const CameraRequest& r = _batch[_batchNext[index]];
+        uint32_t id = io.post(r.cls, r.subcls, r.rw, r.length ? r.data : nullptr, r.length,
+                              (CameraPriority)r.priority);
+        if (!id) {
+            return; // cola llena
+        }
+        _batchIds[index][_batchNext[index]++] = id;
+    }
+}
+
+void CameraGroup::finishBatch() {
+    for (size_t i = 0; i < _count; i++) {
+        if (_batchNext[i] < _batchCount || _batchRetry[i]) {
+            return;
+        }
+        for (size_t k = 0; k < _batchCount; k++) {
+            if (_batchIds[i][k]) {
+                return;
+            }
+        }
+    }
+    uint32_t elapsed = cameraMicros() - _batchStartUs;
+    _stats.batches++;
+    _stats.lastBatchUs = elapsed;
+    if (elapsed > _stats.maxBatchUs) {
+        _stats.maxBatchUs = elapsed;
+    }
+    _batchCount = 0;
+    for (size_t i = 0; i < _count; i++) {
+        _batchNext[i] = 0;
+    }
+}
+
+// ============================================================================
+// FFC ESCALONADO
+// ============================================================================
+
+bool CameraGroup::ffc(uint8_t index) {
+    if (index >= _count) {
+        return false;
+    }
+    _ffcPending |= 1UL << index;
+    return true;
+}
+
+void CameraGroup::ffcAll() {
+    _ffcPending |= (1UL << _count) - 1;
+}
+
+void CameraGroup::setFfcInterval(uint32_t intervalMs) {
+    _ffcIntervalMs = intervalMs;
+    _lastPeriodicMs = cameraMillis();
+}
+
+/**
+ * Como mucho un FFC cada _ffcStaggerMs, rotando entre las cámaras pendientes.
+ */
+void CameraGroup::releaseFfc() {
+    uint32_t now = cameraMillis();
+    if (_ffcIntervalMs && now - _lastPeriodicMs >= _ffcIntervalMs) {
+        _lastPeriodicMs = now;
+        ffcAll();
+    }
+    if (!_ffcPending || (_ffcIssued && cameraMicros() - _lastFfcUs < _ffcStaggerMs * 1000UL)) {
+        return;
+    }
+    for (size_t n = 0; n < _count; n++) {
+        uint8_t i = (uint8_t)((_ffcNext + n) % _count);
+        if (!(_ffcPending & (1UL << i))) {
+            continue;
+        }
+        uint32_t id = _members[i]->postWrite(CLASS_CAMERA, 0x02, nullptr, 0, CAMERA_PRIORITY_URGENT);
+        if (!id) {
+            return; // cola llena: reintentar en la próxima vuelta
+        }
+        _ffcIds[i] = id;
+        _ffcPending &= ~(1UL << i);
+        _ffcNext = (uint8_t)((i + 1) % _count);
+        _ffcIssued = true;
+        _lastFfcUs = cameraMicros();
+        return;
+    }
+}
+
+// ============================================================================
+// BUCLE
+// ============================================================================
+
+size_t CameraGroup::update(uint32_t budgetUs) {
+    if (_count == 0) {
+        return 0;
+    }
+    releaseFfc();
+
+    // Ninguna cámara espera a otra: cada pollIo() vuelve en cuanto tendría que esperar
+    uint32_t share = budgetUs / _count;
+    for (size_t i = 0; i < _count; i++) {
+        feed(i);
+        CameraTask& io = *_members[i];
+        if (io.cooperative()) {
+            io.pollIo(share);
+        } else if (!io.running()) {
+            io.service();
+        }
+    }
+
+    size_t handled = 0;
+    CameraEvent event;
+    for (size_t i = 0; i < _count; i++) {
+        while (_members[i]->poll(event)) {
+            handle(i, event);
+            handled++;
+        }
+    }
+    if (_batchCount > 0) {
+        finishBatch();
+    }
+    return handled;
+}
+
+void CameraGroup::handle(uint8_t index, const CameraEvent& event) {
+    CameraMemberStats& m = _stats.cameras[index];
+    m.commands++;
+    if (event.code == CAMERA_ERR_TIMEOUT) {
+        m.timeouts++;
+    }
+    if (event.code != CAMERA_OK && event.code != CAMERA_ERR_ABORTED) {
+        m.errors++;
+    }
+    uint32_t serviceUs = event.doneUs - event.startUs;
+    if (serviceUs > m.maxServiceUs) {
+        m.maxServiceUs = serviceUs;
+    }
+
+    if (event.id != 0 && event.id == _ffcIds[index]) {
+        _ffcIds[index] = 0;
+        if (event.code == CAMERA_OK) {
+            m.ffcs++;
+            _lastFfcUs = event.startUs; // la separación cuenta desde que salió de verdad
+            if (_ffcSeen && _lastFfcCamera != index) {
+                uint32_t gapUs = event.startUs - _lastFfcStartUs;
+                if (_stats.minFfcGapUs == 0 || gapUs < _stats.minFfcGapUs) {
+                    _stats.minFfcGapUs = gapUs;
+                }
+            }
+            _ffcSeen = true;
+            _lastFfcCamera = index;
+            _lastFfcStartUs = event.startUs;
+        }
+    }
+
+    for (size_t k = 0; k < _batchCount && event.id != 0; k++) {
+        if (_batchIds[index][k] == event.id) {
+            _batchIds[index][k] = 0;
+            if (event.code == CAMERA_ERR_ABORTED) {
+                // Cedida a un comando urgente (p. ej. el FFC del grupo): no es
+                // un resultado, se repite sin avisar a la aplicación
+                _batchRetry[index] |= 1UL << k;
+                _stats.batchRetries++;
+                return;
+            }
+            if (event.code != CAMERA_OK && _batchCode[index] == CAMERA_OK) {
+                _batchCode[index] = event.code;
+            }
+            break;
+        }
+    }
+
+    if (_eventHandler) {
+        _eventHandler(index, event);
+    }
+}
+
+// ============================================================================
+// ESTADÍSTICAS
+// ============================================================================
+
+const CameraGroupStats& CameraGroup::stats() {
+    _stats.commands = 0;
+    _stats.errors = 0;
+    _stats.ffcs = 0;
+    _stats.minLinkScore = 100;
+    for (size_t i = 0; i < _count; i++) {
+        CameraMemberStats& m = _stats.cameras[i];
+        m.linkScore = _members[i]->controller().getLinkScore();
+        _stats.commands += m.commands;
+        _stats.errors += m.errors;
+        _stats.ffcs += m.ffcs;
+        if (m.linkScore < _stats.minLinkScore) {
+            _stats.minLinkScore = m.linkScore;
+        }
+    }
+    return _stats;
+}
+
+void CameraGroup::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+    _ffcSeen = false;
+}
+
+void CameraGroup::printStats(Print& out) {
+    const CameraGroupStats& s = stats();
+    out.printf("Grupo: %u cámaras, %lu comandos, %lu errores, %lu FFC, enlace mín %u/100\n", (unsigned)_count,
+               (unsigned long)s.commands, (unsigned long)s.errors, (unsigned long)s.ffcs, s.minLinkScore);
+    out.printf("Difusiones: %lu lotes, último %lu us, máx %lu us, %lu repetidos tras ceder a un urgente\n",
+               (unsigned long)s.batches, (unsigned long)s.lastBatchUs, (unsigned long)s.maxBatchUs,
+               (unsigned long)s.batchRetries);
+    if (s.minFfcGapUs) {
+        out.printf("FFC: separación mínima %lu ms (objetivo %lu ms)\n", (unsigned long)(s.minFfcGapUs / 1000),
+                   (unsigned long)_ffcStaggerMs);
+    }
+    for (size_t i = 0; i < _count; i++) {
+        const CameraMemberStats& m = s.cameras[i];
+        out.printf("  cámara %u: %lu comandos, %lu errores (%lu timeouts), %lu FFC, servicio máx %lu us, "
+                   "enlace %u/100\n",
+                   (unsigned)i, (unsigned long)m.commands, (unsigned long)m.errors, (unsigned long)m.timeouts,
+                   (unsigned long)m.ffcs, (unsigned long)m.maxServiceUs, m.linkScore);
+    }
+}
@@ -0,0 +1,67 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraLink.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: UART link quality monitor for ThermalCameraController
+*/
+
+#include "CameraLink.h"
+
+CameraLinkQuality::CameraLinkQuality() : _threshold(0), _callback(nullptr) {
+    reset();
+}
+
+void CameraLinkQuality::reset() {
+    for (uint8_t i = 0; i < LINK_EVENT_COUNT; i++) {
+        _counts[i] = 0;
+    }
+    _discarded = 0;
+    _history = 0;
+    _samples = 0;
+    _degraded = false;
+}
+
+void CameraLinkQuality::record(LinkEvent event) {
+    if (event >= LINK_EVENT_COUNT) {
+        return;
+    }
+    _counts[event]++;
+
+    _history = (_history << 1) | (event == LINK_FRAME_OK ? 1u : 0u);
+    if (_samples < 32) {
+        _samples++;
+    }
+
+    if (!_callback || _samples < CAMERA_LINK_MIN_SAMPLES) {
+        return;
+    }
+    uint8_t current = score();
+    bool below = current < _threshold;
+    if (below != _degraded) {
+        _degraded = below;
+        _callback(current, below);
+    }
+}
+
+uint8_t CameraLinkQuality::score() const {
+    if (_samples == 0) {
+        return 100;
+    }
+    uint32_t mask = (_samples >= 32) ? 0xFFFFFFFFUL : ((1UL << _samples) - 1);
+    uint32_t good = _history & mask;
+    uint8_t ones = 0;
+    while (good) {
+        good &= good - 1;
+        ones++;
+    }
+    return (uint8_t)((ones * 100u) / _samples);
+}
+
+void CameraLinkQuality::setCallback(LinkQualityCallback callback, uint8_t threshold) {
+    _callback = callback;
+    _threshold = threshold;
+    _degraded = false;
+}
@@ -0,0 +1,128 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraLog.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Deferred binary debug log for ThermalCameraController
+*/
+
+#include "CameraLog.h"
+
+#if CAMERA_LOG_LEVEL > CAMERA_LOG_NONE
+
+#include "CameraController.h"
+#include "CameraClock.h"
+#include "CameraText.h"
+
+static const char* const LOG_EVENT_NAMES[LOG_EVENT_COUNT] PROGMEM = {
+    "INIT", "TX", "NAME", "RX", "RESP", "ERROR", "CONFIG"
+};
+
+static uint32_t readLogU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void printLogBytes(Print& out, const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        out.printf("%02X ", data[i]);
+    }
+}
+
+#if CAMERA_ENABLE_DEBUG_DUMPS
+// Volcado completo de una trama en todos los formatos (solo al vaciar el log)
+static void printLogDump(Print& out, const uint8_t* data, size_t length) {
+    static const uint8_t BASES[] = {BIN, DEC, OCT};
+    static const char* const LABELS[] = {"bin", "dec", "oct"};
+    for (size_t b = 0; b < sizeof(BASES); b++) {
+        out.printf("\n    %s: ", LABELS[b]);
+        for (size_t i = 0; i < length; i++) {
+            out.print(data[i], BASES[b]);
+            out.print(" ");
+        }
+    }
+}
+#endif
+
+CameraLog::CameraLog() : _dropped(0), _enabled(false) {
+}
+
+void CameraLog::record(CameraLogEvent event, const uint8_t* data, size_t length) {
+    CameraLogRecord rec;
+    rec.timestamp = cameraMicros();
+    rec.event = event;
+    if (length > CAMERA_LOG_DATA_SIZE) {
+        length = CAMERA_LOG_DATA_SIZE;
+    }
+    rec.length = (uint8_t)length;
+    if (length > 0) {
+        memcpy(rec.data, data, length);
+    }
+    if (!_ring.push(rec)) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+size_t CameraLog::flush(Print& out, size_t maxRecords) {
+    size_t count = 0;
+    CameraLogRecord rec;
+
+    if (_dropped.load(std::memory_order_relaxed) > 0) {
+        out.printf("[log] %lu registros descartados\n", (unsigned long)_dropped.exchange(0));
+    }
+
+    while (count < maxRecords && _ring.pop(rec)) {
+        const char* name = (rec.event < LOG_EVENT_COUNT) ? LOG_EVENT_NAMES[rec.event] : "?";
+        out.printf("[%10lu us] %-6s ", (unsigned long)rec.timestamp, name);
+
+        switch (rec.event) {
+            case LOG_EVENT_NAME:
+                out.write(rec.data, rec.length);
+                break;
+            case LOG_EVENT_ERROR:
+                if (rec.length >= 3) {
+                    out.printf("%s (0x%02X/0x%02X)", cameraErrorText((CameraErrorCode)rec.data[0]),
+                               rec.data[1], rec.data[2]);
+                }
+                break;
+            case LOG_EVENT_CONFIG:
+                if (rec.length >= 8) {
+                    out.printf("timeouts respuesta=%lums byte=%lums",
+                               (unsigned long)readLogU32(rec.data), (unsigned long)readLogU32(rec.data + 4));
+                }
+                break;
+            case LOG_EVENT_TX:
+                printLogBytes(out, rec.data, rec.length);
+                if (rec.length >= 6 && rec.data[5] != FLAG_READ) {
+                    out.print("(sin respuesta)");
+                }
+                break;
+            case LOG_EVENT_RESPONSE: {
+                printLogBytes(out, rec.data, rec.length);
+                char text[CAMERA_TEXT_SIZE];
+                cameraInterpretFrame(rec.data, rec.length, text, sizeof(text));
+                out.printf("\n    %s", text);
+#if CAMERA_ENABLE_DEBUG_DUMPS
+                printLogDump(out, rec.data, rec.length);
+#endif
+                break;
+            }
+            default:
+                printLogBytes(out, rec.data, rec.length);
+                break;
+        }
+        out.println();
+        count++;
+    }
+    return count;
+}
+
+void CameraLog::clear() {
+    CameraLogRecord rec;
+    while (_ring.pop(rec)) {
+    }
+    _dropped.store(0, std::memory_order_relaxed);
+}
+
+#endif
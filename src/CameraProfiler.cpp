@@ -0,0 +1,87 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraProfiler.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Loop latency profiler and stall watchdog
+*/
+
+#include "CameraProfiler.h"
+#include "CameraClock.h"
+
+#if CAMERA_ENABLE_PROFILER
+
+CameraProfiler::CameraProfiler()
+    : _budgetUs(CAMERA_LOOP_BUDGET_US), _callback(nullptr) {
+    reset();
+}
+
+void CameraProfiler::reset() {
+    for (uint8_t i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        _sections[i].reset();
+    }
+    _stalls.clear();
+    _stallCount = 0;
+    _depth = 0;
+    _worstUs = 0;
+    _worstCls = 0;
+    _worstSubcls = 0;
+}
+
+uint32_t CameraProfiler::begin() {
+    if (_depth == 0) {
+        _worstUs = 0;
+        _worstCls = 0;
+        _worstSubcls = 0;
+    }
+    _depth++;
+    return cameraMicros();
+}
+
+void CameraProfiler::end(ProfileSection section, uint32_t startUs, uint8_t cls, uint8_t subcls) {
+    uint32_t now = cameraMicros();
+    uint32_t duration = now - startUs;
+    if (_depth > 0) {
+        _depth--;
+    }
+    if (section >= PROFILE_SECTION_COUNT) {
+        return;
+    }
+    _sections[section].add(duration);
+
+    if (section == PROFILE_COMMAND) {
+        if (duration >= _worstUs) {
+            _worstUs = duration;
+            _worstCls = cls;
+            _worstSubcls = subcls;
+        }
+    } else {
+        // Atribuir al comando más lento ejecutado dentro de la sección
+        cls = _worstCls;
+        subcls = _worstSubcls;
+    }
+
+    if (duration <= _budgetUs) {
+        return;
+    }
+    // Un stall de comando anidado ya se notificó: no repetirlo en la sección exterior
+    if (section != PROFILE_COMMAND && _worstUs > _budgetUs) {
+        return;
+    }
+
+    CameraStall stall;
+    stall.timestamp = now;
+    stall.durationUs = duration;
+    stall.section = section;
+    stall.cls = cls;
+    stall.subcls = subcls;
+    _stalls.push(stall, true);
+    _stallCount++;
+    if (_callback) {
+        _callback(stall);
+    }
+}
+
+#endif
@@ -0,0 +1,257 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraSoak.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Long-running soak/stress driver with a weighted random command mix
+*/
+
+#include "CameraSoak.h"
+#include "CameraAlloc.h"
+#include "CameraClock.h"
+
+// Retraso máximo antes de recolocar el calendario en lugar de recuperar operaciones
+#define SOAK_MAX_LAG_US 1000000UL
+
+void CameraSoakOpStats::reset() {
+    ops = 0;
+    errors = 0;
+    latency.reset();
+}
+
+CameraSoak::CameraSoak(CameraController& camera, const CameraSoakConfig& config)
+    : _camera(camera), _config(config) {
+    begin();
+}
+
+void CameraSoak::begin() {
+    _rng = _config.seed ? _config.seed : 1;
+    _weightTotal = 0;
+    for (uint8_t i = 0; i < SOAK_OP_COUNT; i++) {
+        _weightTotal += _config.weights[i];
+        _total[i].reset();
+        _window[i].reset();
+    }
+    memset(_errorCounts, 0, sizeof(_errorCounts));
+    memset(&_heap, 0, sizeof(_heap));
+    _worstFragmentation = 0;
+    CameraAllocSnapshot snap = cameraAllocSnapshot();
+    _baseAllocs = snap.allocs - snap.frees;
+
+    float rate = _config.ratePerSec > 0 ? _config.ratePerSec : 1.0f;
+    _intervalUs = (uint32_t)(1000000.0f / rate);
+    _startMs = cameraMillis();
+    _lastSummaryMs = _startMs;
+    _nextUs = cameraMicros();
+    _done = false;
+    sampleHeap();
+}
+
+uint32_t CameraSoak::random(uint32_t bound) {
+    // xorshift32: determinista con la semilla y sin dependencias de la plataforma
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return bound ? _rng % bound : 0;
+}
+
+SoakOp CameraSoak::pickOp() {
+    if (_weightTotal == 0) {
+        return SOAK_READ;
+    }
+    uint32_t r = random(_weightTotal);
+    for (uint8_t i = 0; i < SOAK_OP_COUNT; i++) {
+        if (r < _config.weights[i]) {
+            return (SoakOp)i;
+        }
+        r -= _config.weights[i];
+    }
+    return SOAK_READ;
+}
+
+bool CameraSoak::runOp(SoakOp op) {
+    switch (op) {
+        case SOAK_READ:
+            switch (random(5)) {
+                case 0: _camera.getBrightness(); break;
+                case 1: _camera.getContrast(); break;
+                case 2: _camera.getDigitalEnhancement(); break;
+                case 3: _camera.getStaticNoiseReduction(); break;
+                default: _camera.getDynamicNoiseReduction(); break;
+            }
+            break;
+        case SOAK_WRITE: {
+            uint8_t value = (uint8_t)random(101);
+            switch (random(5)) {
+                case 0: _camera.setBrightness(value); break;
+                case 1: _camera.setContrast(value); break;
+                case 2: _camera.setDigitalEnhancement(value); break;
+                case 3: _camera.setStaticNoiseReduction(value); break;
+                default: _camera.setDynamicNoiseReduction(value); break;
+            }
+            break;
+        }
+        case SOAK_CURSOR: {
+            uint8_t pixels = (uint8_t)(1 + random(4));
+            switch (random(5)) {
+                case 0: _camera.moveCursorUp(pixels); break;
+                case 1: _camera.moveCursorDown(pixels); break;
+                case 2: _camera.moveCursorLeft(pixels); break;
+                case 3: _camera.moveCursorRight(pixels); break;
+                default: _camera.centerCursor(); break;
+            }
+            break;
+        }
+        default:
+            _camera.performManualFFC();
+            break;
+    }
+    // Los getters devuelven 0 tanto en error como con valor 0: manda el estado del comando
+    return _camera.getLastCommandStatus().code == CAMERA_OK;
+}
+
+bool CameraSoak::update(Print& out) {
+    if (_done) {
+        return false;
+    }
+
+    uint32_t nowUs = cameraMicros();
+    if ((int32_t)(nowUs - _nextUs) >= 0) {
+        SoakOp op = pickOp();
+        uint32_t start = cameraMicros();
+        bool ok = runOp(op);
+        uint32_t us = cameraMicros() - start;
+
+        CameraSoakOpStats* sets[] = {&_total[op], &_window[op]};
+        for (CameraSoakOpStats* s : sets) {
+            s->ops++;
+            s->latency.add(us);
+            if (!ok) {
+                s->errors++;
+            }
+        }
+        if (!ok) {
+            _errorCounts[_camera.getLastCommandStatus().code]++;
+        }
+
+        _nextUs += _intervalUs;
+        if ((int32_t)(cameraMicros() - _nextUs) > (int32_t)SOAK_MAX_LAG_US) {
+            // Muy por detrás (timeouts seguidos): no encadenar ráfagas para recuperar
+            _nextUs = cameraMicros();
+        }
+    }
+
+    uint32_t nowMs = cameraMillis();
+    if (_config.durationMs && nowMs - _startMs >= _config.durationMs) {
+        printSummary(out);
+        _done = true;
+        return false;
+    }
+    if (_config.summaryIntervalMs && nowMs - _lastSummaryMs >= _config.summaryIntervalMs) {
+        printSummary(out);
+    }
+    return true;
+}
+
+uint32_t CameraSoak::msUntilNext() const {
+    int32_t remaining = (int32_t)(_nextUs - cameraMicros());
+    return remaining > 0 ? (uint32_t)remaining / 1000 : 0;
+}
+
+void CameraSoak::sampleHeap() {
+    _heap.freeBytes = ESP.getFreeHeap();
+    _heap.minFreeBytes = ESP.getMinFreeHeap();
+    _heap.maxBlockBytes = ESP.getMaxAllocHeap();
+    _heap.fragmentation = _heap.freeBytes ? (uint8_t)(100 - (uint64_t)_heap.maxBlockBytes * 100 / _heap.freeBytes) : 0;
+    if (_heap.fragmentation > _worstFragmentation) {
+        _worstFragmentation = _heap.fragmentation;
+    }
+    CameraAllocSnapshot snap = cameraAllocSnapshot();
+    _heap.liveAllocs = snap.allocs - snap.frees - _baseAllocs;
+}
+
+void CameraSoak::printOpLine(Print& out, const char* label, const CameraSoakOpStats& s) {
+    out.printf("  %-7s n=%-8lu err=%-6lu (%5.2f%%) p50=%lu p95=%lu p99=%lu max=%lu us\n", label,
+               (unsigned long)s.ops, (unsigned long)s.errors, s.ops ? s.errors * 100.0 / s.ops : 0.0,
+               (unsigned long)s.latency.percentileUs(50), (unsigned long)s.latency.percentileUs(95),
+               (unsigned long)s.latency.percentileUs(99), (unsigned long)(s.latency.count ? s.latency.maxUs : 0));
+}
+
+void CameraSoak::printSummary(Print& out) {
+    uint32_t nowMs = cameraMillis();
+    uint32_t windowMs = nowMs - _lastSummaryMs;
+    uint32_t windowOps = 0;
+    uint32_t windowErrors = 0;
+    for (uint8_t i = 0; i < SOAK_OP_COUNT; i++) {
+        windowOps += _window[i].ops;
+        windowErrors += _window[i].errors;
+    }
+    sampleHeap();
+
+    out.printf("[soak] t=%lus ventana=%lus ops=%lu (%.1f/s) err=%lu | total ops=%lu err=%lu (%.3f%%)\n",
+               (unsigned long)(elapsedMs() / 1000), (unsigned long)(windowMs / 1000), (unsigned long)windowOps,
+               windowMs ? windowOps * 1000.0 / windowMs : 0.0, (unsigned long)windowErrors,
+               (unsigned long)totalOps(), (unsigned long)totalErrors(),
+               totalOps() ? totalErrors() * 100.0 / totalOps() : 0.0);
+    if (_heap.freeBytes) {
+        out.printf("  heap libre=%lu min=%lu bloque=%lu frag=%u%% (peor %u%%)",
+                   (unsigned long)_heap.freeBytes, (unsigned long)_heap.minFreeBytes,
+                   (unsigned long)_heap.maxBlockBytes, _heap.fragmentation, _worstFragmentation);
+    } else {
+        out.print("  heap n/a");
+    }
+#if CAMERA_TRACK_ALLOCATIONS
+    out.printf(" reservas vivas=%ld", (long)(int32_t)_heap.liveAllocs);
+#endif
+    out.println();
+
+    for (uint8_t i = 0; i < SOAK_OP_COUNT; i++) {
+        if (_total[i].ops) {
+            printOpLine(out, SOAK_OP_NAME[i], _window[i]);
+        }
+    }
+    for (uint8_t code = CAMERA_OK + 1; code < CAMERA_ERR_COUNT; code++) {
+        if (_errorCounts[code]) {
+            out.printf("  %s: %lu\n", cameraErrorText((CameraErrorCode)code), (unsigned long)_errorCounts[code]);
+        }
+    }
+
+    for (uint8_t i = 0; i < SOAK_OP_COUNT; i++) {
+        _window[i].reset();
+    }
+    _lastSummaryMs = nowMs;
+}
+
+uint32_t CameraSoak::elapsedMs() const {
+    return cameraMillis() - _startMs;
+}
+
+uint32_t CameraSoak::totalOps() const {
+    uint32_t n = 0;
+    for (uint8_t i = 0; i < SOAK_OP_COUNT; i++) {
+        n += _total[i].ops;
+    }
+    return n;
+}
+
+uint32_t CameraSoak::totalErrors() const {
+    uint32_t n = 0;
+    for (uint8_t i = 0; i < SOAK_OP_COUNT; i++) {
+        n += _total[i].errors;
+    }
+    return n;
+}
+
+uint32_t CameraSoak::errorCount(CameraErrorCode code) const {
+    return code < CAMERA_ERR_COUNT ? _errorCounts[code] : 0;
+}
+
+const CameraSoakOpStats& CameraSoak::stats(SoakOp op) const {
+    return _total[op];
+}
+
+const CameraSoakHeap& CameraSoak::heap() const {
+    return _heap;
+}
@@ -0,0 +1,127 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraStats.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Per-command counters and latency histograms for ThermalCameraController
+*/
+
+#include "CameraStats.h"
+
+void CameraLatencyHistogram::reset(const uint32_t* bucketLimits) {
+    memset(buckets, 0, sizeof(buckets));
+    limits = bucketLimits;
+    count = 0;
+    minUs = 0xFFFFFFFFUL;
+    maxUs = 0;
+    totalUs = 0;
+}
+
+void CameraLatencyHistogram::add(uint32_t us) {
+    size_t i = 0;
+    while (us > limitUs(i)) {
+        i++;
+    }
+    buckets[i]++;
+    count++;
+    totalUs += us;
+    if (us < minUs) minUs = us;
+    if (us > maxUs) maxUs = us;
+}
+
+uint32_t CameraLatencyHistogram::meanUs() const {
+    return count ? (uint32_t)(totalUs / count) : 0;
+}
+
+uint32_t CameraLatencyHistogram::percentileUs(uint8_t pct) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t target = ((uint64_t)count * pct + 99) / 100;
+    uint32_t seen = 0;
+    for (size_t i = 0; i < CAMERA_LATENCY_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return (limitUs(i) < maxUs) ? limitUs(i) : maxUs;
+        }
+    }
+    return maxUs;
+}
+
+#if CAMERA_ENABLE_STATS
+
+CameraStats::CameraStats() {
+    reset();
+}
+
+void CameraStats::reset() {
+    _count = 0;
+    _untracked = 0;
+}
+
+CameraCommandStats* CameraStats::slot(uint8_t cls, uint8_t subcls) {
+    for (size_t i = 0; i < _count; i++) {
+        if (_slots[i].cls == cls && _slots[i].subcls == subcls) {
+            return &_slots[i];
+        }
+    }
+    if (_count >= CAMERA_STATS_SLOTS) {
+        _untracked++;
+        return nullptr;
+    }
+
+    CameraCommandStats* s = &_slots[_count++];
+    memset(s, 0, sizeof(*s));
+    s->cls = cls;
+    s->subcls = subcls;
+    s->firstByte.reset(CAMERA_REPLY_BUCKET_US);
+    s->transfer.reset(CAMERA_REPLY_BUCKET_US);
+    return s;
+}
+
+const CameraCommandStats* CameraStats::find(uint8_t cls, uint8_t subcls) const {
+    for (size_t i = 0; i < _count; i++) {
+        if (_slots[i].cls == cls && _slots[i].subcls == subcls) {
+            return &_slots[i];
+        }
+    }
+    return nullptr;
+}
+
+void CameraStats::recordSent(uint8_t cls, uint8_t subcls, size_t bytesOut) {
+    CameraCommandStats* s = slot(cls, subcls);
+    if (s) {
+        s->sent++;
+        s->bytesOut += bytesOut;
+    }
+}
+
+void CameraStats::recordReply(uint8_t cls, uint8_t subcls, size_t bytesIn, uint32_t firstByteUs, uint32_t transferUs) {
+    CameraCommandStats* s = slot(cls, subcls);
+    if (s) {
+        s->replied++;
+        s->bytesIn += bytesIn;
+        s->firstByte.add(firstByteUs);
+        s->transfer.add(transferUs);
+    }
+}
+
+void CameraStats::recordTimeout(uint8_t cls, uint8_t subcls, size_t bytesIn) {
+    CameraCommandStats* s = slot(cls, subcls);
+    if (s) {
+        s->timedOut++;
+        s->bytesIn += bytesIn;
+    }
+}
+
+void CameraStats::recordFailure(uint8_t cls, uint8_t subcls, size_t bytesIn) {
+    CameraCommandStats* s = slot(cls, subcls);
+    if (s) {
+        s->failed++;
+        s->bytesIn += bytesIn;
+    }
+}
+
+#endif
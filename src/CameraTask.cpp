@@ -0,0 +1,648 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraTask.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Camera I/O task pinned to its own core, fed through lock-free queues
+*/
+
+#include "CameraTask.h"
+#include "CameraClock.h"
+
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+CameraTask::CameraTask(CameraController& camera)
+    : _camera(camera), _running(false), _stopping(false), _cooperative(false), _eventsDropped(0), _callsDone(0), _isrPosted(0), _isrRejected(0), _urgentPending(0), _inFlight(CAMERA_PRIORITY_URGENT),
+      _nextId(0), _staged(false), _active(false) {
+#ifdef ARDUINO
+    _handle = nullptr;
+#endif
+    resetStats();
+}
+
+CameraTask::~CameraTask() {
+    end();
+}
+
+bool CameraTask::begin(int core, uint8_t priority, uint32_t stackSize) {
+    if (_running.load() || _cooperative.load()) {
+        return false;
+    }
+    _stopping.store(false);
+    _urgentPending.store(0); // lo que quedó en cola de una sesión anterior ya no cuenta
+    _inFlight = CAMERA_PRIORITY_URGENT;
+    _running.store(true);
+    _camera.setWaitInterrupt(urgentWaiting, this);
+#ifdef ARDUINO
+    if (xTaskCreatePinnedToCore(taskEntry, "camera_io", stackSize, this, priority, &_handle, core) != pdPASS) {
+        _running.store(false);
+        _handle = nullptr;
+        return false;
+    }
+#else
+    (void)core;
+    (void)priority;
+    (void)stackSize;
+    _thread = std::thread(taskEntry, this);
+#endif
+    return true;
+}
+
+void CameraTask::end() {
+    if (_cooperative.load()) {
+        _cooperative.store(false);
+        if (_active) {
+            // La lectura ya salió: termina como abandonada
+            _camera.abandonResponse();
+            close(_current.request, _currentEvent, CAMERA_ERR_ABORTED);
+            finish(_current, _currentEvent);
+        } else if (_staged) {
+            drop(_current);
+        }
+        _staged = false;
+        _active = false;
+        releasePending();
+        _camera.setWaitInterrupt(nullptr, nullptr);
+        return;
+    }
+    if (!_running.load()) {
+        return;
+    }
+    _stopping.store(true);
+    wake();
+#ifdef ARDUINO
+    while (_running.load()) {
+        delay(1);
+    }
+    _handle = nullptr;
+#else
+    _thread.join();
+#endif
+    _camera.setWaitInterrupt(nullptr, nullptr);
+}
+
+/**
+ * No dejar a nadie esperando un resultado que ya no llegará: las llamadas
+ * terminan con CAMERA_ERR_NOT_INITIALIZED y cada post() pendiente recibe
+ * su evento con ese mismo código.
+ */
+void CameraTask::releasePending() {
+    // Vaciar también las colas de entrada: lo urgente que quede ahí seguiría
+    // contando en _urgentPending y abandonaría las lecturas de la próxima sesión
+    do {
+        gather();
+        for (uint8_t c = 0; c < CAMERA_PRIORITY_COUNT; c++) {
+            CameraScheduled item;
+            while (_ready[c].pop(item)) {
+                if (c == CAMERA_PRIORITY_URGENT) {
+                    _urgentPending.fetch_sub(1);
+                }
+                drop(item);
+            }
+        }
+    } while (!_isr.empty() || !_commands.empty() || !_calls.empty());
+}
+
+/**
+ * Petición que ya no se ejecutará: CAMERA_ERR_NOT_INITIALIZED a quien la pidió.
+ */
+void CameraTask::drop(const CameraScheduled& item) {
+    if (item.call) {
+        complete(item.call, CAMERA_ERR_NOT_INITIALIZED);
+        return;
+    }
+    CameraEvent event;
+    event.id = item.request.id;
+    event.cls = item.request.cls;
+    event.subcls = item.request.subcls;
+    event.rw = item.request.rw;
+    event.code = CAMERA_ERR_NOT_INITIALIZED;
+    event.length = 0;
+    event.fromIsr = item.fromIsr;
+    event.priority = item.request.priority;
+    event.postedUs = item.request.postedUs;
+    event.startUs = cameraMicros();
+    event.doneUs = event.startUs;
+    deliver(event);
+}
+
+bool CameraTask::beginCooperative() {
+    if (_running.load() || _cooperative.load()) {
+        return false;
+    }
+    _staged = false;
+    _active = false;
+    _urgentPending.store(0);
+    _inFlight = CAMERA_PRIORITY_URGENT;
+    _camera.setWaitInterrupt(urgentWaiting, this);
+    _cooperative.store(true);
+    return true;
+}
+
+void CameraTask::taskEntry(void* context) {
+    static_cast<CameraTask*>(context)->run();
+}
+
+void CameraTask::run() {
+    while (!_stopping.load()) {
+        service();
+#ifdef ARDUINO
+        // Dormir hasta el siguiente post() o 1 tick para atender respuestas asíncronas
+        ulTaskNotifyTake(pdTRUE, 1);
+#else
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+#endif
+    }
+    releasePending();
+    _running.store(false);
+#ifdef ARDUINO
+    vTaskDelete(nullptr);
+#endif
+}
+
+void CameraTask::wake() {
+#ifdef ARDUINO
+    if (_handle) {
+        xTaskNotifyGive(_handle);
+    }
+#endif
+}
+
+CameraRequest CameraTask::prepare(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t* data, uint8_t length,
+                                  CameraPriority priority) {
+    CameraRequest request;
+    memset(&request, 0, sizeof(request));
+    request.cls = cls;
+    request.subcls = subcls;
+    request.rw = rw;
+    request.priority = priority;
+    request.length = length > CAMERA_REQUEST_DATA ? CAMERA_REQUEST_DATA : length;
+    if (data && request.length) {
+        memcpy(request.data, data, request.length);
+    }
+    return request;
+}
+
+bool IRAM_ATTR CameraTask::postFromISR(const CameraRequest& request) {
+    CameraRequest queued = request;
+    queued.postedUs = cameraMicros();
+    admit(queued);
+    if (!_isr.push(queued)) {
+        if (queued.priority == CAMERA_PRIORITY_URGENT) {
+            _urgentPending.fetch_sub(1);
+        }
+        _isrRejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    _isrPosted.fetch_add(1, std::memory_order_relaxed);
+#ifdef ARDUINO
+    if (_handle) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(_handle, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+#endif
+    return true;
+}
+
+// ============================================================================
+// LADO DE LA APLICACIÓN
+// ============================================================================
+
+/**
+ * Anota una petición urgente antes de encolarla (cualquier tarea o ISR), para
+ * que la tarea de E/S pueda abandonar la espera en curso.
+ */
+void IRAM_ATTR CameraTask::admit(const CameraRequest& request) {
+    if (request.priority == CAMERA_PRIORITY_URGENT) {
+        _urgentPending.fetch_add(1);
+    }
+}
+
+uint32_t CameraTask::post(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t* data, uint8_t length,
+                          CameraPriority priority) {
+    if (length > CAMERA_REQUEST_DATA || priority >= CAMERA_PRIORITY_COUNT) {
+        _stats.rejected++;
+        return 0;
+    }
+    CameraRequest request;
+    if (++_nextId == 0) {
+        _nextId = 1; // 0 queda para "rechazado"
+    }
+    request.id = _nextId;
+    request.cls = cls;
+    request.subcls = subcls;
+    request.rw = rw;
+    request.length = length;
+    if (length) {
+        memcpy(request.data, data, length);
+    }
+    request.priority = priority;
+    request.postedUs = cameraMicros();
+
+    admit(request);
+    if (!_commands.push(request)) {
+        if (priority == CAMERA_PRIORITY_URGENT) {
+            _urgentPending.fetch_sub(1);
+        }
+        _stats.rejected++;
+        return 0;
+    }
+    _stats.posted++;
+    wake();
+    return request.id;
+}
+
+CameraErrorCode CameraTask::call(uint8_t cls, uint8_t subcls, uint8_t rw, const uint8_t* data, uint8_t length,
+                                 CameraEvent& result, CameraPriority priority) {
+    if (length > CAMERA_REQUEST_DATA || priority >= CAMERA_PRIORITY_COUNT) {
+        return CAMERA_ERR_OUT_OF_RANGE;
+    }
+    CameraCall call;
+    call.request.id = 0;
+    call.request.cls = cls;
+    call.request.subcls = subcls;
+    call.request.rw = rw;
+    call.request.length = length;
+    if (length) {
+        memcpy(call.request.data, data, length);
+    }
+    call.request.priority = priority;
+    call.result = &result;
+    call.done.store(false);
+#ifdef ARDUINO
+    call.waiter = xTaskGetCurrentTaskHandle();
+#endif
+    call.request.postedUs = cameraMicros();
+
+    if (!_running.load() && !_cooperative.load()) {
+        return CAMERA_ERR_NOT_INITIALIZED;
+    }
+    // La cola solo se llena con CAMERA_QUEUE_DEPTH llamadas simultáneas: esperar turno
+    admit(call.request);
+    while (!_calls.push(&call)) {
+        if (!_running.load() && !_cooperative.load()) {
+            if (priority == CAMERA_PRIORITY_URGENT) {
+                _urgentPending.fetch_sub(1);
+            }
+            return CAMERA_ERR_NOT_INITIALIZED;
+        }
+        delay(1);
+    }
+    wake();
+
+#ifdef ARDUINO
+    while (!call.done.load(std::memory_order_acquire)) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+#else
+    std::unique_lock<std::mutex> lock(call.lock);
+    call.wake.wait(lock, [&call]() { return call.done.load(std::memory_order_acquire); });
+#endif
+    return result.code;
+}
+
+bool CameraTask::poll(CameraEvent& event) {
+    if (!_events.pop(event)) {
+        return false;
+    }
+    _stats.completed++;
+    _stats.queueWait.add(event.startUs - event.postedUs);
+    _stats.service.add(event.doneUs - event.startUs);
+    _stats.delivery.add(cameraMicros() - event.doneUs);
+    if (event.fromIsr) {
+        _stats.isrWait.add(event.startUs - event.postedUs);
+    }
+    if (event.priority < CAMERA_PRIORITY_COUNT) {
+        _stats.classes[event.priority].wait.add(event.startUs - event.postedUs);
+    }
+    return true;
+}
+
+const CameraTaskStats& CameraTask::stats() {
+    _stats.eventsDropped = _eventsDropped.load();
+    _stats.commandHighWater = _commands.highWater();
+    _stats.eventHighWater = _events.highWater();
+    _stats.calls = _callsDone.load();
+    _stats.callHighWater = _calls.highWater();
+    _stats.isrPosted = _isrPosted.load();
+    _stats.isrRejected = _isrRejected.load();
+    _stats.isrHighWater = _isr.highWater();
+    for (uint8_t c = 0; c < CAMERA_PRIORITY_COUNT; c++) {
+        _stats.classes[c].executed = _classExecuted[c].load();
+        _stats.classes[c].abandoned = _classAbandoned[c].load();
+        _stats.classes[c].maxWaitUs = _classMaxWaitUs[c].load();
+    }
+    return _stats;
+}
+
+void CameraTask::resetStats() {
+    _stats.posted = 0;
+    _stats.rejected = 0;
+    _stats.completed = 0;
+    _stats.eventsDropped = 0;
+    _stats.commandHighWater = 0;
+    _stats.eventHighWater = 0;
+    _stats.calls = 0;
+    _stats.callHighWater = 0;
+    _stats.pollCalls = 0;
+    _stats.pollMaxUs = 0;
+    _stats.isrPosted = 0;
+    _stats.isrRejected = 0;
+    _stats.isrHighWater = 0;
+    _stats.isrWait.reset();
+    _stats.queueWait.reset();
+    _stats.service.reset();
+    _stats.delivery.reset();
+    _eventsDropped.store(0);
+    _callsDone.store(0);
+    _calls.resetHighWater();
+    _isrPosted.store(0);
+    _isrRejected.store(0);
+    _isr.resetHighWater();
+    for (uint8_t c = 0; c < CAMERA_PRIORITY_COUNT; c++) {
+        _stats.classes[c].executed = 0;
+        _stats.classes[c].abandoned = 0;
+        _stats.classes[c].maxWaitUs = 0;
+        _stats.classes[c].wait.reset();
+        _classExecuted[c].store(0);
+        _classAbandoned[c].store(0);
+        _classMaxWaitUs[c].store(0);
+    }
+    _commands.resetHighWater();
+    _events.resetHighWater();
+}
+
+void CameraTask::printStats(Print& out) {
+    const CameraTaskStats& s = stats();
+    out.printf("Tarea E/S: %lu enviados, %lu rechazados, %lu completados, %lu eventos perdidos\n",
+               (unsigned long)s.posted, (unsigned long)s.rejected, (unsigned long)s.completed,
+               (unsigned long)s.eventsDropped);
+    out.printf("Colas: comandos %u/%u (máx %u), eventos %u/%u (máx %u)\n", (unsigned)pendingCommands(),
+               (unsigned)CAMERA_QUEUE_DEPTH, (unsigned)s.commandHighWater, (unsigned)pendingEvents(),
+               (unsigned)CAMERA_EVENT_DEPTH, (unsigned)s.eventHighWater);
+    out.printf("Interrupciones: %lu enviadas, %lu rechazadas, cola máx %u/%u\n", (unsigned long)s.isrPosted,
+               (unsigned long)s.isrRejected, (unsigned)s.isrHighWater, (unsigned)CAMERA_ISR_DEPTH);
+    if (s.pollCalls) {
+        out.printf("Modo cooperativo: %lu llamadas a pollIo(), la más larga %lu us\n", (unsigned long)s.pollCalls,
+                   (unsigned long)s.pollMaxUs);
+    }
+    out.printf("Llamadas de otras tareas: %lu completadas, cola máx %u/%u\n", (unsigned long)s.calls,
+               (unsigned)s.callHighWater, (unsigned)CAMERA_QUEUE_DEPTH);
+    const CameraLatencyHistogram* histograms[] = {&s.queueWait, &s.service, &s.delivery, &s.isrWait};
+    const char* names[] = {"espera en cola", "servicio", "entrega", "ISR -> TX"};
+    for (size_t i = 0; i < 4; i++) {
+        const CameraLatencyHistogram& h = *histograms[i];
+        out.printf("  %-15s media=%lu p50=%lu p99=%lu max=%lu us\n", names[i], (unsigned long)h.meanUs(),
+                   (unsigned long)h.percentileUs(50), (unsigned long)h.percentileUs(99),
+                   (unsigned long)(h.count ? h.maxUs : 0));
+    }
+    out.println("Por prioridad:");
+    for (uint8_t c = 0; c < CAMERA_PRIORITY_COUNT; c++) {
+        const CameraClassStats& cs = s.classes[c];
+        out.printf("  %-12s %lu ejecutados, %lu abandonados, espera máx %lu us, p50=%lu p99=%lu us\n",
+                   CAMERA_PRIORITY_NAMES[c], (unsigned long)cs.executed, (unsigned long)cs.abandoned,
+                   (unsigned long)cs.maxWaitUs, (unsigned long)cs.wait.percentileUs(50),
+                   (unsigned long)cs.wait.percentileUs(99));
+    }
+}
+
+// ============================================================================
+// LADO DE E/S
+// ============================================================================
+
+void CameraTask::execute(const CameraRequest& request, CameraEvent& event) {
+    open(request, event);
+    _camera.sendDynamicCommand(request.cls, request.subcls, request.rw, request.length ? request.data : nullptr,
+                               request.length);
+    close(request, event, _camera.getLastCommandStatus().code);
+}
+
+/**
+ * Inicio de un comando: copia la petición al evento y anota la espera en cola
+ * (también como span "queue" de la traza, con el id de la petición).
+ */
+void CameraTask::open(const CameraRequest& request, CameraEvent& event) {
+    event.id = request.id;
+    event.cls = request.cls;
+    event.subcls = request.subcls;
+    event.rw = request.rw;
+    event.fromIsr = false;
+    event.priority = request.priority;
+    event.postedUs = request.postedUs;
+    event.startUs = cameraMicros();
+
+    uint8_t priority = request.priority; // gather() ya la dejó dentro de rango
+    uint32_t waitUs = event.startUs - event.postedUs;
+    if (waitUs > _classMaxWaitUs[priority].load(std::memory_order_relaxed)) {
+        _classMaxWaitUs[priority].store(waitUs, std::memory_order_relaxed);
+    }
+    _inFlight = priority;
+
+    // call() no numera sus peticiones (id 0): el controlador usa uno propio
+    if (request.id) {
+        CAMERA_TRACE_ASYNC_SPAN("queue", "camera", request.id, event.postedUs, event.startUs);
+        _camera.setTraceId(request.id);
+    }
+}
+
+/**
+ * Fin de un comando: resultado, datos de la respuesta y contadores por clase.
+ */
+void CameraTask::close(const CameraRequest& request, CameraEvent& event, CameraErrorCode code) {
+    event.code = code;
+    event.length = 0;
+    if (code == CAMERA_OK && request.rw == FLAG_READ) {
+        event.length = (uint8_t)_camera.getResponseData(event.data, sizeof(event.data));
+    }
+    event.doneUs = cameraMicros();
+    _inFlight = CAMERA_PRIORITY_URGENT;
+
+    _classExecuted[request.priority].fetch_add(1, std::memory_order_relaxed);
+    if (code == CAMERA_ERR_ABORTED) {
+        _classAbandoned[request.priority].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Entrega el resultado a quien lo pidió: ranura de call() o cola de eventos.
+ */
+void CameraTask::finish(const CameraScheduled& item, CameraEvent& event) {
+    if (item.call) {
+        *item.call->result = event;
+        _callsDone.fetch_add(1);
+        complete(item.call, CAMERA_OK);
+    } else {
+        event.fromIsr = item.fromIsr;
+        deliver(event);
+    }
+}
+
+void CameraTask::complete(CameraCall* call, CameraErrorCode code) {
+    if (code != CAMERA_OK) {
+        call->result->code = code;
+        call->result->length = 0;
+    }
+#ifdef ARDUINO
+    // Tras done = true la llamada puede salir de la pila: leer antes el handle
+    TaskHandle_t waiter = call->waiter;
+    call->done.store(true, std::memory_order_release);
+    xTaskNotifyGive(waiter);
+#else
+    std::lock_guard<std::mutex> lock(call->lock);
+    call->done.store(true, std::memory_order_release);
+    call->wake.notify_one();
+#endif
+}
+
+void CameraTask::deliver(const CameraEvent& event) {
+    if (!_events.push(event)) {
+        _eventsDropped.fetch_add(1); // la aplicación no recoge: no se la espera
+    }
+}
+
+/**
+ * Reparte lo que haya en las colas de entrada entre las colas por clase.
+ * Solo saca de una fuente mientras quepa en cualquier clase, así lo que no
+ * cabe se queda esperando en su cola de entrada sin perderse.
+ * @return true si repartió algo.
+ */
+bool CameraTask::gather() {
+    bool moved = false;
+    CameraScheduled item;
+    for (;;) {
+        for (uint8_t c = 0; c < CAMERA_PRIORITY_COUNT; c++) {
+            if (_ready[c].full()) {
+                return moved;
+            }
+        }
+        item.call = nullptr;
+        item.fromIsr = false;
+        if (_isr.pop(item.request)) {
+            item.fromIsr = true;
+        } else if (_commands.pop(item.request)) {
+        } else if (_calls.pop(item.call)) {
+            item.request = item.call->request;
+        } else {
+            return moved;
+        }
+        if (item.request.priority >= CAMERA_PRIORITY_COUNT) {
+            item.request.priority = CAMERA_PRIORITY_BACKGROUND;
+        }
+        _ready[item.request.priority].push(item);
+        moved = true;
+    }
+}
+
+/**
+ * Elige la siguiente petición: la de mejor clase efectiva, donde cada
+ * CAMERA_AGING_MS de espera sube una clase; a igualdad gana la clase original.
+ * @return false si no hay nada en cola.
+ */
+bool CameraTask::next(CameraScheduled& item) {
+    uint32_t now = cameraMicros();
+    int best = -1;
+    int bestEffective = 0;
+    for (uint8_t c = 0; c < CAMERA_PRIORITY_COUNT; c++) {
+        if (_ready[c].empty()) {
+            continue;
+        }
+        uint32_t waited = now - _ready[c].at(0).request.postedUs;
+        int effective = (int)c - (int)(waited / (CAMERA_AGING_MS * 1000UL));
+        if (best < 0 || effective < bestEffective) {
+            best = c;
+            bestEffective = effective;
+        }
+    }
+    if (best < 0) {
+        return false;
+    }
+    _ready[best].pop(item);
+    if (best == CAMERA_PRIORITY_URGENT) {
+        _urgentPending.fetch_sub(1);
+    }
+    return true;
+}
+
+/**
+ * Consulta del controlador durante la espera de una respuesta: abandonarla
+ * si hay trabajo urgente y lo que está en curso no lo es.
+ */
+bool CameraTask::urgentWaiting(void* context) {
+    CameraTask* task = static_cast<CameraTask*>(context);
+    return task->_inFlight != CAMERA_PRIORITY_URGENT && task->_urgentPending.load() > 0;
+}
+
+size_t CameraTask::service() {
+    size_t executed = 0;
+    CameraScheduled item;
+    CameraEvent event;
+    // Repartir antes de cada comando para ver lo urgente que acaba de llegar
+    while (gather(), next(item)) {
+        execute(item.request, event);
+        finish(item, event);
+        executed++;
+    }
+    _camera.update();
+    return executed;
+}
+
+size_t CameraTask::pollIo(uint32_t budgetUs) {
+    if (!_cooperative.load()) {
+        return 0;
+    }
+    uint32_t start = cameraMicros();
+    size_t finished = 0;
+    for (;;) {
+        if (_active) {
+            CameraErrorCode code;
+            if (!_camera.pollResponse(code)) {
+                break; // sin respuesta completa aún: devolver el control al loop
+            }
+            close(_current.request, _currentEvent, code);
+            finish(_current, _currentEvent);
+            _active = false;
+            _staged = false;
+            finished++;
+        }
+        if (cameraMicros() - start >= budgetUs) {
+            break;
+        }
+        if (!_staged) {
+            gather();
+            if (!next(_current)) {
+                _camera.update(); // nada en cola: confirmaciones, callbacks y log
+                break;
+            }
+            _staged = true;
+        }
+        // Una lectura no sale mientras pueda llegar la respuesta de otra abandonada
+        if (_current.request.rw == FLAG_READ && !_camera.readyForRead()) {
+            break;
+        }
+        const CameraRequest& r = _current.request;
+        open(r, _currentEvent);
+        if (_camera.startCommand(r.cls, r.subcls, r.rw, r.length ? r.data : nullptr, r.length) &&
+            _camera.responsePending()) {
+            _active = true;
+            continue;
+        }
+        close(r, _currentEvent, _camera.getLastCommandStatus().code);
+        finish(_current, _currentEvent);
+        _staged = false;
+        finished++;
+    }
+
+    uint32_t elapsed = cameraMicros() - start;
+    _stats.pollCalls++;
+    if (elapsed > _stats.pollMaxUs) {
+        _stats.pollMaxUs = elapsed;
+    }
+    return finished;
+}
@@ -0,0 +1,290 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraText.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Flash-resident text tables and frame decoder for JS-MINI256-9 responses
+Docs:
+    Todas las tablas son "const ... const" para que tanto los textos como los
+    arrays de punteros queden en flash (.rodata) y no ocupen RAM.
+*/
+
+#include "CameraText.h"
+#include "CameraController.h"
+
+// Nombres públicos de modos (CameraController::*_NAMES)
+const char* const CameraController::PALETTE_NAMES[] PROGMEM = {
+    "White Hot", "Black Hot", "Iron", "Rainbow", "Rain",
+    "Ice Fire", "Fusion", "Sepia", "Color1", "Color2",
+    "Color3", "Color4", "Color5", "Color6", "Color7"
+};
+
+const char* const CameraController::SHUTTER_MODE_NAMES[] PROGMEM = {
+    "Disabled", "Manual", "Automatic", "Fully Automatic"
+};
+
+const char* const CameraController::MIRROR_MODE_NAMES[] PROGMEM = {
+    "Disabled", "Central", "Horizontal", "Vertical"
+};
+
+const CameraTextEntry CAMERA_COMMAND_NAMES[] PROGMEM = {
+    {CLASS_INFO, 0x02, "Model"},
+    {CLASS_INFO, 0x03, "FPGA version"},
+    {CLASS_INFO, 0x04, "FPGA build date"},
+    {CLASS_INFO, 0x05, "Software version"},
+    {CLASS_INFO, 0x06, "Software build date"},
+    {CLASS_INFO, 0x07, "Calibration version"},
+    {CLASS_INFO, 0x08, "ISP version"},
+    {CLASS_INFO, 0x0B, "Calibration date"},
+    {CLASS_INFO, 0x0C, "ISP parameters"},
+    {CLASS_INFO, 0x0F, "Factory reset"},
+    {CLASS_INFO, 0x10, "Save configuration"},
+    {CLASS_CAMERA, 0x02, "Manual FFC"},
+    {CLASS_CAMERA, 0x03, "Background correction"},
+    {CLASS_CAMERA, 0x04, "Auto shutter"},
+    {CLASS_CAMERA, 0x05, "Shutter interval"},
+    {CLASS_CAMERA, 0x0C, "Vignetting correction"},
+    {CLASS_CAMERA, 0x14, "Init status"},
+    {CLASS_IMAGE, 0x02, "Brightness"},
+    {CLASS_IMAGE, 0x03, "Contrast"},
+    {CLASS_IMAGE, 0x10, "Digital enhancement"},
+    {CLASS_IMAGE, 0x15, "Static denoise"},
+    {CLASS_IMAGE, 0x16, "Dynamic denoise"},
+    {CLASS_IMAGE, 0x1A, "Cursor"},
+    {CLASS_IMAGE, 0x20, "Palette"},
+    {CLASS_MIRROR, 0x11, "Mirror"}
+};
+
+const size_t CAMERA_COMMAND_NAME_COUNT = sizeof(CAMERA_COMMAND_NAMES) / sizeof(CAMERA_COMMAND_NAMES[0]);
+
+const char* cameraFindText(const CameraTextEntry* table, size_t count, uint8_t cls, uint8_t subcls) {
+    for (size_t i = 0; i < count; i++) {
+        if (table[i].cls == cls && table[i].subcls == subcls) {
+            return table[i].text;
+        }
+    }
+    return nullptr;
+}
+
+const char* cameraCommandName(uint8_t cls, uint8_t subcls) {
+    const char* name = cameraFindText(CAMERA_COMMAND_NAMES, CAMERA_COMMAND_NAME_COUNT, cls, subcls);
+    return name ? name : "?";
+}
+
+#if CAMERA_ENABLE_INTERPRETATION
+
+#define TABLE_SIZE(table) (sizeof(table) / sizeof(table[0]))
+
+// Valores 0-100 ("<etiqueta> actual/configurado: N/100")
+static const CameraTextEntry PERCENT_TEXTS[] PROGMEM = {
+    {CLASS_IMAGE, 0x02, "☀️  Brillo"},
+    {CLASS_IMAGE, 0x03, "🌗 Contraste"},
+    {CLASS_IMAGE, 0x10, "🔍 Mejora digital detalle"},
+    {CLASS_IMAGE, 0x15, "🔇 Reducción ruido estático"},
+    {CLASS_IMAGE, 0x16, "🔊 Reducción ruido dinámico"}
+};
+
+// Versiones "a.b.c"
+static const CameraTextEntry VERSION_TEXTS[] PROGMEM = {
+    {CLASS_INFO, 0x03, "🔧 Versión FPGA"},
+    {CLASS_INFO, 0x05, "💾 Versión software"}
+};
+
+// Fechas AAAAMMDD
+static const CameraTextEntry DATE_TEXTS[] PROGMEM = {
+    {CLASS_INFO, 0x04, "📅 Compilación FPGA"},
+    {CLASS_INFO, 0x06, "📅 Compilación software"},
+    {CLASS_INFO, 0x0B, "📷 Versión calibración cámara"}
+};
+
+// Acciones sin datos
+static const CameraTextEntry ACTION_TEXTS[] PROGMEM = {
+    {CLASS_INFO, 0x10, "💾 Configuración guardada correctamente"},
+    {CLASS_INFO, 0x0F, "🔄 Configuración de fábrica restaurada"},
+    {CLASS_CAMERA, 0x02, "🎯 Calibración de obturador manual ejecutada"},
+    {CLASS_CAMERA, 0x03, "🎨 Corrección de fondo manual ejecutada"},
+    {CLASS_CAMERA, 0x0C, "🔧 Corrección de viñeteado ejecutada"}
+};
+
+static const CameraCodeText STATUS_TEXTS[] PROGMEM = {
+    {0x00, "📺 Estado: Inicializando (loading)"},
+    {0x01, "📺 Estado: Video activo (output)"}
+};
+
+static const CameraCodeText CURSOR_TEXTS[] PROGMEM = {
+    {0x00, "👁️‍🗨️ Cursor ocultado"},
+    {0x02, "⬆️  Cursor movido arriba"},
+    {0x03, "⬇️  Cursor movido abajo"},
+    {0x04, "⬅️  Cursor movido izquierda"},
+    {0x05, "➡️  Cursor movido derecha"},
+    {0x06, "🎯 Cursor centrado"},
+    {0x0D, "❌ Píxel defectuoso agregado"},
+    {0x0E, "✅ Píxel defectuoso removido"},
+    {0x0F, "👁️  Cursor mostrado"}
+};
+
+// Movimientos múltiples: nibble alto = dirección, nibble bajo = píxeles
+static const CameraCodeText CURSOR_MOVE_TEXTS[] PROGMEM = {
+    {0x20, "⬆️  Cursor movido %u píxeles arriba"},
+    {0x30, "⬇️  Cursor movido %u píxeles abajo"},
+    {0x40, "⬅️  Cursor movido %u píxeles izquierda"},
+    {0x50, "➡️  Cursor movido %u píxeles derecha"}
+};
+
+static const char* const SHUTTER_TEXTS[] PROGMEM = {
+    "Deshabilitado", "Manual", "Automático", "Totalmente automático"
+};
+
+static const char* const MIRROR_TEXTS[] PROGMEM = {
+    "Deshabilitado", "Central", "Horizontal", "Vertical"
+};
+
+static const char* findCode(const CameraCodeText* table, size_t count, uint8_t code) {
+    for (size_t i = 0; i < count; i++) {
+        if (table[i].code == code) {
+            return table[i].text;
+        }
+    }
+    return nullptr;
+}
+
+static uint32_t readDate(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+size_t cameraInterpretFrame(const uint8_t* resp, size_t len, char* out, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    out[0] = '\0';
+
+    if (len < 7) {
+        return snprintf(out, size, "Invalid response");
+    }
+
+    uint8_t classByte = resp[3];
+    uint8_t subClassByte = resp[4];
+    uint8_t rwFlag = resp[5];
+    uint8_t dataLength = resp[6];
+    // Datos empiezan en resp[7]
+    const char* state = (rwFlag == 0x01) ? "actual" : "configurado";
+    const char* text;
+    int written = 0;
+
+    if ((text = cameraFindText(PERCENT_TEXTS, TABLE_SIZE(PERCENT_TEXTS), classByte, subClassByte))) {
+        if (dataLength >= 1) {
+            written = snprintf(out, size, "%s %s: %u/100", text, state, resp[7]);
+        }
+    } else if ((text = cameraFindText(VERSION_TEXTS, TABLE_SIZE(VERSION_TEXTS), classByte, subClassByte))) {
+        if (dataLength >= 3) {
+            written = snprintf(out, size, "%s: %u.%u.%u", text, resp[7], resp[8], resp[9]);
+        }
+    } else if ((text = cameraFindText(DATE_TEXTS, TABLE_SIZE(DATE_TEXTS), classByte, subClassByte))) {
+        if (dataLength >= 4) {
+            uint32_t fecha = readDate(&resp[7]);
+            written = snprintf(out, size, "%s: %lu-%lu-%lu", text, (unsigned long)(fecha / 10000),
+                               (unsigned long)((fecha / 100) % 100), (unsigned long)(fecha % 100));
+        }
+    } else if ((text = cameraFindText(ACTION_TEXTS, TABLE_SIZE(ACTION_TEXTS), classByte, subClassByte))) {
+        written = snprintf(out, size, "%s", text);
+    } else if (classByte == CLASS_INFO && subClassByte == 0x02) {
+        // Modelo del módulo (ASCII)
+        written = snprintf(out, size, "📦 Modelo del módulo: ");
+        for (int i = 7; i < 7 + dataLength && written >= 0 && (size_t)written + 1 < size; i++) {
+            if (i < (int)len - 2) out[written++] = (char)resp[i];
+        }
+        if (written >= 0 && (size_t)written < size) out[written] = '\0';
+    } else if (classByte == CLASS_INFO && subClassByte == 0x0C) {
+        if (dataLength >= 4) {
+            written = snprintf(out, size, "⚙️  Versión parámetros ISP: 0x%x%x%x%x", resp[7], resp[8], resp[9], resp[10]);
+        }
+    } else if (classByte == CLASS_CAMERA && subClassByte == 0x14) {
+        if (dataLength >= 1) {
+            text = findCode(STATUS_TEXTS, TABLE_SIZE(STATUS_TEXTS), resp[7]);
+            written = text ? snprintf(out, size, "%s", text)
+                           : snprintf(out, size, "📺 Estado desconocido: 0x%x", resp[7]);
+        }
+    } else if (classByte == CLASS_CAMERA && subClassByte == 0x04) {
+        if (dataLength >= 1) {
+            uint8_t modo = resp[7];
+            if (modo <= 3 && rwFlag == 0x01) {
+                written = snprintf(out, size, "📷 Obturador automático actual: %s (valor: %d)", SHUTTER_TEXTS[modo], modo);
+            } else if (modo <= 3) {
+                written = snprintf(out, size, "📷 Obturador automático configurado: %s", SHUTTER_TEXTS[modo]);
+            } else {
+                written = snprintf(out, size, "📷 Modo obturador: 0x%x", modo);
+            }
+        }
+    } else if (classByte == CLASS_CAMERA && subClassByte == 0x05) {
+        if (dataLength >= 1) {
+            unsigned minutos = (dataLength >= 2) ? ((resp[7] << 8) | resp[8]) : resp[7];
+            written = snprintf(out, size, "⏱️  Intervalo obturación automático %s: %u minutos", state, minutos);
+        }
+    } else if (classByte == CLASS_IMAGE && subClassByte == 0x20) {
+        if (dataLength >= 1) {
+            // Según main copy.cpp, el valor real de la paleta está en resp[6], no en resp[7]
+            uint8_t paleta = resp[6];
+            if (paleta <= PALETTE_COLOR7) {
+                written = snprintf(out, size, "🎨 Paleta %s: %s (valor: 0x%x)",
+                                   (rwFlag == 0x01) ? "actual" : "configurada",
+                                   CameraController::PALETTE_NAMES[paleta], paleta);
+            } else {
+                written = snprintf(out, size, "🎨 Paleta: Modo desconocido 0x%x", paleta);
+            }
+        }
+    } else if (classByte == CLASS_IMAGE && subClassByte == 0x1A) {
+        if (dataLength >= 1) {
+            uint8_t cursorData = resp[7];
+            if ((text = findCode(CURSOR_TEXTS, TABLE_SIZE(CURSOR_TEXTS), cursorData))) {
+                written = snprintf(out, size, "%s", text);
+            } else if ((text = findCode(CURSOR_MOVE_TEXTS, TABLE_SIZE(CURSOR_MOVE_TEXTS), cursorData & 0xF0))) {
+                written = snprintf(out, size, text, cursorData & 0x0F);
+            } else {
+                written = snprintf(out, size, "🖱️  Comando cursor: 0x%x", cursorData);
+            }
+        }
+    } else if (classByte == CLASS_MIRROR && subClassByte == 0x11) {
+        if (dataLength >= 1) {
+            uint8_t modo = resp[7];
+            if (modo <= 3 && rwFlag == 0x01) {
+                written = snprintf(out, size, "🪞 Mirroring actual: %s (valor: %d)", MIRROR_TEXTS[modo], modo);
+            } else if (modo <= 3) {
+                written = snprintf(out, size, "🪞 Mirroring configurado: %s", MIRROR_TEXTS[modo]);
+            } else {
+                written = snprintf(out, size, "🪞 Mirroring: Modo %u", modo);
+            }
+        }
+    } else if (classByte == CLASS_INFO || classByte == CLASS_CAMERA ||
+               classByte == CLASS_IMAGE || classByte == CLASS_MIRROR) {
+        written = snprintf(out, size, "❓ Comando clase 0x%X, subclase 0x%x no interpretado", classByte, subClassByte);
+    } else {
+        written = snprintf(out, size, "❓ Clase 0x%x no reconocida", classByte);
+    }
+
+    if (written < 0) {
+        out[0] = '\0';
+        return 0;
+    }
+    return ((size_t)written < size) ? (size_t)written : size - 1;
+}
+
+#else
+
+// Capa de interpretación compilada fuera: solo un resumen de la trama
+size_t cameraInterpretFrame(const uint8_t* resp, size_t len, char* out, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    int written = (len < 7) ? snprintf(out, size, "Invalid response")
+                            : snprintf(out, size, "C=0x%02X S=0x%02X R=0x%02X D=0x%02X",
+                                       resp[3], resp[4], resp[5], resp[6]);
+    if (written < 0) {
+        out[0] = '\0';
+        return 0;
+    }
+    return ((size_t)written < size) ? (size_t)written : size - 1;
+}
+
+#endif
@@ -0,0 +1,126 @@
+/*
+█▀ █▄█ █▀▀ █░█ █▀▀ █░█
+▄█ ░█░ █▄▄ █▀█ ██▄ ▀▄▀
+
+Author: <Anton Sychev> (anton at sychev dot xyz)
+CameraTrace.cpp (c) 2025
+Created:  2025-06-21 01:36:27
+Desc: Chrome trace_event spans for commands and menu actions
+*/
+
+#include "CameraTrace.h"
+
+#if CAMERA_ENABLE_TRACE
+
+std::atomic<Print*> CameraTrace::_out(nullptr);
+std::mutex CameraTrace::_lock;
+uint32_t CameraTrace::_pid = 1;
+bool CameraTrace::_first = true;
+
+void CameraTrace::begin(Print* out, uint32_t pid) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _pid = pid;
+    _first = true;
+    if (out) {
+        out->print("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    }
+    _out.store(out, std::memory_order_release);
+}
+
+void CameraTrace::end() {
+    std::lock_guard<std::mutex> guard(_lock);
+    Print* out = _out.exchange(nullptr);
+    if (out) {
+        out->print("\n]}\n");
+    }
+}
+
+void CameraTrace::event(const char* name, const char* category, char phase, const char* detail) {
+    if (!active()) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(_lock);
+    Print* out = _out.load(std::memory_order_relaxed);
+    if (!out) {
+        return; // end() desde otro hilo entre la comprobación y el mutex
+    }
+    header(name, category, phase, cameraMicros());
+    if (phase == 'i') {
+        out->print(",\"s\":\"t\"");
+    }
+    if (detail && detail[0]) {
+        out->print(",\"args\":{\"detail\":");
+        writeString(detail);
+        out->print("}");
+    }
+    out->print("}");
+}
+
+void CameraTrace::async(const char* name, const char* category, char phase, uint32_t id, uint32_t timestampUs,
+                        const char* detail) {
+    if (!active()) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(_lock);
+    Print* out = _out.load(std::memory_order_relaxed);
+    if (!out) {
+        return;
+    }
+    header(name, category, phase, timestampUs);
+    out->printf(",\"id\":\"0x%lx\"", (unsigned long)id);
+    if (detail && detail[0]) {
+        out->print(",\"args\":{\"detail\":");
+        writeString(detail);
+        out->print("}");
+    }
+    out->print("}");
+}
+
+/**
+ * Campos comunes de un evento, sin cerrar el objeto. Llamar con el mutex tomado.
+ */
+void CameraTrace::header(const char* name, const char* category, char phase, uint32_t timestampUs) {
+    Print* out = _out.load(std::memory_order_relaxed);
+    out->print(_first ? "{\"name\":" : ",\n{\"name\":");
+    writeString(name);
+    out->print(",\"cat\":");
+    writeString(category);
+    out->printf(",\"ph\":\"%c\",\"ts\":%lu,\"pid\":%lu,\"tid\":%lu", phase, (unsigned long)timestampUs,
+                (unsigned long)_pid, (unsigned long)threadId());
+    _first = false;
+}
+
+/**
+ * Cadena JSON entre comillas: escapa comillas, barras y caracteres de control
+ * (el detalle puede ser lo que el usuario tecleó en el menú).
+ */
+void CameraTrace::writeString(const char* text) {
+    Print* out = _out.load(std::memory_order_relaxed);
+    out->write('"');
+    for (const char* p = text ? text : ""; *p; p++) {
+        uint8_t c = (uint8_t)*p;
+        if (c == '"' || c == '\\') {
+            out->write('\\');
+            out->write(c);
+        } else if (c < 0x20) {
+            out->printf("\\u%04x", c);
+        } else {
+            out->write(c); // UTF-8 tal cual
+        }
+    }
+    out->write('"');
+}
+
+/**
+ * Número pequeño y estable por hilo (1 el primero que traza), para "tid".
+ */
+uint32_t CameraTrace::threadId() {
+    static std::atomic<uint32_t> next(1);
+    static thread_local uint32_t id = 0;
+    if (id == 0) {
+        id = next.fetch_add(1, std::memory_order_relaxed);
+    }
+    return id;
+}
+
+#endif
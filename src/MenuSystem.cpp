@@ -9,37 +9,38 @@ Desc: Interactive Menu System Implementation
 */
 
 #include "MenuSystem.h"
+#include "CameraText.h"
+
+#if CAMERA_ENABLE_MENU
 
 // Declarar función global para callback
-void globalCameraResponseHandler(const String& response);
+void globalCameraResponseHandler(const char* response);
 
 /**
  * Callback global para manejar respuestas de la cámara.
  * @param response Respuesta interpretada de la cámara.
  */
-void globalCameraResponseHandler(const String& response) {
-    Serial.println("📡 " + response);
+void globalCameraResponseHandler(const char* response) {
+    Serial.print("📡 ");
+    Serial.println(response);
 }
 
 MenuSystem::MenuSystem(CameraController* camera) 
-    : _camera(camera), _currentMenu(MAIN_MENU), _waitingForInput(false), _inputHandler(nullptr) {
+    : _camera(camera), _currentMenu(MAIN_MENU), _waitingForInput(false), _inputPrompt(nullptr),
+      _inputHandler(nullptr) {
 }
 
 /**
  * Inicializa el sistema de menús y muestra el menú principal.
  */
 void MenuSystem::begin() {
-    String separator = "";
-    for (int i = 0; i < 50; i++) {
-        separator += "=";
-    }
-    
-    Serial.println("\n" + separator);
+    Serial.println();
+    printRule('=', 50);
     Serial.println("🎥 JS-MINI256-9 Thermal Camera Controller");
     Serial.println("📡 ESP32 UART Interface");
-    Serial.println(separator);
+    printRule('=', 50);
     
-    CameraController::setGlobalResponseHandler(globalCameraResponseHandler);
+    CameraController::setGlobalResponseTextHandler(globalCameraResponseHandler);
     
     showMainMenu();
 }
@@ -51,6 +52,8 @@ void MenuSystem::begin() {
 void MenuSystem::processInput(String input) {
     input.trim();
     input.toUpperCase();
+    CAMERA_TRACE_SCOPE("processInput", "menu", input.c_str());
+    CAMERA_PROFILE_SCOPE(_camera->getProfiler(), PROFILE_MENU_INPUT, 0, 0);
     
     if (_waitingForInput && _inputHandler) {
         _waitingForInput = false;
@@ -89,8 +92,9 @@ void MenuSystem::showMainMenu() {
     printMenuItem(4, "Cursor Control", "Show, move, dead pixel management");
     printMenuItem(5, "Color Palettes", "Select thermal color palettes");
     printMenuItem(6, "System Settings", "Save, restore, configuration");
+    printMenuItem(7, "Statistics", "Per-command counters and latency");
     printSeparator();
-    Serial.println("Enter choice (1-6) or 'M' for menu:");
+    Serial.println("Enter choice (1-7) or 'M' for menu:");
 }
 
 void MenuSystem::showInfoMenu() {
@@ -140,14 +144,8 @@ void MenuSystem::showPaletteMenu() {
     _currentMenu = PALETTE_MENU;
     printMenuHeader("COLOR PALETTES");
     
-    const char* paletteNames[] = {
-        "White Hot", "Black Hot", "Iron", "Rainbow", "Rain",
-        "Ice Fire", "Fusion", "Sepia", "Color1", "Color2",
-        "Color3", "Color4", "Color5", "Color6", "Color7"
-    };
-    
-    for (int i = 0; i < 15; i++) {
-        printMenuItem(i + 1, paletteNames[i]);
+    for (int i = 0; i <= PALETTE_COLOR7; i++) {
+        printMenuItem(i + 1, CameraController::PALETTE_NAMES[i]);
     }
     
     printSeparator();
@@ -166,7 +164,25 @@ void MenuSystem::showSystemMenu() {
     Serial.println("Enter choice:");
 }
 
+void MenuSystem::showStatsMenu() {
+    _currentMenu = STATS_MENU;
+    printMenuHeader("STATISTICS");
+    printMenuItem(1, "Command Counters", "Sent, replied, timeouts, bytes");
+    printMenuItem(2, "Latency Histograms", "Send->first byte, first byte->complete");
+    printMenuItem(3, "Reset Statistics");
+    printMenuItem(4, "Dump Traffic Capture", "TX/RX frames with timestamps");
+    printMenuItem(5, "Start/Stop Capture", "Freezes on first error");
+    printMenuItem(6, "Loop Profile", "Call times and stalls over budget");
+    printMenuItem(0, "Back to Main Menu");
+    Serial.println("Enter choice:");
+}
+
 void MenuSystem::executeMenuChoice(int choice) {
+#if CAMERA_ENABLE_TRACE
+    char detail[24];
+    snprintf(detail, sizeof(detail), "menu=%d choice=%d", (int)_currentMenu, choice);
+    CAMERA_TRACE_SCOPE("menu action", "menu", detail);
+#endif
     switch (_currentMenu) {
         case MAIN_MENU:
             switch (choice) {
@@ -176,6 +192,7 @@ void MenuSystem::executeMenuChoice(int choice) {
                 case 4: showCursorMenu(); break;
                 case 5: showPaletteMenu(); break;
                 case 6: showSystemMenu(); break;
+                case 7: showStatsMenu(); break;
                 default: printError("Invalid choice");
             }
             break;
@@ -200,14 +217,14 @@ void MenuSystem::executeMenuChoice(int choice) {
                     if (_camera->performManualFFC()) {
                         printSuccess("Manual FFC completed");
                     } else {
-                        printError(_camera->getLastError());
+                        printCameraError();
                     }
                     break;
                 case 2:
                     if (_camera->performBackgroundCorrection()) {
                         printSuccess("Background correction completed");
                     } else {
-                        printError(_camera->getLastError());
+                        printCameraError();
                     }
                     break;
                 case 0: returnToMainMenu(); break;
@@ -235,7 +252,7 @@ void MenuSystem::executeMenuChoice(int choice) {
                 if (_camera->setPalette(palette)) {
                     printSuccess("Palette changed successfully");
                 } else {
-                    printError(_camera->getLastError());
+                    printCameraError();
                 }
             } else if (choice == 16) {
                 readCurrentPalette();
@@ -255,6 +272,24 @@ void MenuSystem::executeMenuChoice(int choice) {
                 default: printError("Invalid choice");
             }
             break;
+            
+        case STATS_MENU:
+            switch (choice) {
+                case 1: printCommandStats(); break;
+                case 2: printLatencyHistograms(); break;
+                case 3:
+#if CAMERA_ENABLE_STATS
+                    _camera->resetStats();
+#endif
+                    printSuccess("Statistics reset");
+                    break;
+                case 4: dumpCapture(); break;
+                case 5: toggleCapture(); break;
+                case 6: printLoopProfile(); break;
+                case 0: returnToMainMenu(); break;
+                default: printError("Invalid choice");
+            }
+            break;
     }
 }
 
@@ -263,13 +298,15 @@ void MenuSystem::setBrightnessInteractive() {
     requestInput("Enter brightness value (0-100):", &MenuSystem::handleBrightnessInput);
 }
 
-void MenuSystem::handleBrightnessInput(String input) {
+void MenuSystem::handleBrightnessInput(const String& input) {
     if (validateNumericInput(input, 0, 100)) {
         uint8_t value = input.toInt();
         if (_camera->setBrightness(value)) {
-            printSuccess("Brightness set to " + String(value));
+            char message[32];
+            snprintf(message, sizeof(message), "Brightness set to %u", value);
+            printSuccess(message);
         } else {
-            printError(_camera->getLastError());
+            printCameraError();
         }
     }
     showImageMenu();
@@ -279,13 +316,15 @@ void MenuSystem::setContrastInteractive() {
     requestInput("Enter contrast value (0-100):", &MenuSystem::handleContrastInput);
 }
 
-void MenuSystem::handleContrastInput(String input) {
+void MenuSystem::handleContrastInput(const String& input) {
     if (validateNumericInput(input, 0, 100)) {
         uint8_t value = input.toInt();
         if (_camera->setContrast(value)) {
-            printSuccess("Contrast set to " + String(value));
+            char message[32];
+            snprintf(message, sizeof(message), "Contrast set to %u", value);
+            printSuccess(message);
         } else {
-            printError(_camera->getLastError());
+            printCameraError();
         }
     }
     showImageMenu();
@@ -293,16 +332,18 @@ void MenuSystem::handleContrastInput(String input) {
 
 void MenuSystem::readCurrentImageSettings() {
     Serial.println("\n📊 Current Image Settings:");
-    Serial.println("Brightness: " + String(_camera->getBrightness()) + "/100");
-    Serial.println("Contrast: " + String(_camera->getContrast()) + "/100");
-    Serial.println("Current Palette: " + String(_camera->getCurrentPalette()));
+    Serial.printf("Brightness: %u/100\n", _camera->getBrightness());
+    Serial.printf("Contrast: %u/100\n", _camera->getContrast());
+    ColorPalette palette = _camera->getCurrentPalette();
+    Serial.printf("Current Palette: %d (%s)\n", palette, CameraController::PALETTE_NAMES[palette]);
     Serial.println("");
 }
 
 void MenuSystem::readDeviceModel() {
-    String model = _camera->getModel();
-    if (model.length() > 0) {
-        Serial.println("📷 Device Model: " + model);
+    char model[CAMERA_MODEL_SIZE];
+    if (_camera->getModel(model, sizeof(model))) {
+        Serial.print("📷 Device Model: ");
+        Serial.println(model);
     } else {
         printError("Failed to read device model");
     }
@@ -312,10 +353,14 @@ void MenuSystem::readAllInfo() {
     CameraInfo info;
     if (_camera->getDeviceInfo(info)) {
         Serial.println("\n📋 Complete Device Information:");
-        Serial.println("Model: " + info.model);
-        Serial.println("FPGA Version: " + info.fpgaVersion);
-        Serial.println("Software Version: " + info.softwareVersion);
-        Serial.println("Status: " + String(info.status));
+        Serial.print("Model: ");
+        Serial.println(info.model);
+        Serial.print("FPGA Version: ");
+        Serial.println(info.fpgaVersion);
+        Serial.print("Software Version: ");
+        Serial.println(info.softwareVersion);
+        Serial.print("Status: ");
+        Serial.println((int)info.status);
         Serial.println("");
     } else {
         printError("Failed to read device information");
@@ -324,14 +369,14 @@ void MenuSystem::readAllInfo() {
 
 void MenuSystem::readCurrentPalette() {
     ColorPalette palette = _camera->getCurrentPalette();
-    Serial.println("🎨 Current Palette: " + String(palette));
+    Serial.printf("🎨 Current Palette: %d (%s)\n", palette, CameraController::PALETTE_NAMES[palette]);
 }
 
 void MenuSystem::saveConfiguration() {
     if (_camera->saveConfiguration()) {
         printSuccess("Configuration saved to flash memory");
     } else {
-        printError(_camera->getLastError());
+        printCameraError();
     }
 }
 
@@ -339,71 +384,180 @@ void MenuSystem::restoreFactory() {
     if (_camera->restoreFactory()) {
         printSuccess("Factory settings restored");
     } else {
-        printError(_camera->getLastError());
+        printCameraError();
     }
 }
 
 void MenuSystem::testConnection() {
     if (_camera->isConnected()) {
         printSuccess("Camera connection OK");
-        String model = _camera->getModel();
-        Serial.println("📷 Connected to: " + model);
+        char model[CAMERA_MODEL_SIZE];
+        _camera->getModel(model, sizeof(model));
+        Serial.print("📷 Connected to: ");
+        Serial.println(model);
     } else {
         printError("Camera not responding");
     }
 }
 
+void MenuSystem::printCommandStats() {
+#if CAMERA_ENABLE_STATS
+    const CameraStats& stats = _camera->getStats();
+    Serial.println("\n📊 Command Statistics:");
+    Serial.printf("%-22s %6s %6s %6s %6s %8s %8s %8s\n",
+                  "Command", "Sent", "Reply", "T/O", "Fail", "BytesOut", "BytesIn", "Mean us");
+    for (size_t i = 0; i < stats.size(); i++) {
+        const CameraCommandStats& s = stats.at(i);
+        Serial.printf("%-22s %6lu %6lu %6lu %6lu %8lu %8lu %8lu\n",
+                      cameraCommandName(s.cls, s.subcls),
+                      (unsigned long)s.sent, (unsigned long)s.replied, (unsigned long)s.timedOut,
+                      (unsigned long)s.failed, (unsigned long)s.bytesOut, (unsigned long)s.bytesIn,
+                      (unsigned long)(s.firstByte.meanUs() + s.transfer.meanUs()));
+    }
+    if (stats.untracked() > 0) {
+        Serial.printf("(%lu events without free slot)\n", (unsigned long)stats.untracked());
+    }
+    Serial.println("");
+#else
+    printError("Statistics disabled (CAMERA_ENABLE_STATS=0)");
+#endif
+}
+
+void MenuSystem::printLatencyHistograms() {
+#if CAMERA_ENABLE_STATS
+    const CameraStats& stats = _camera->getStats();
+    Serial.println("\n⏱️ Latency Histograms (us):");
+    Serial.print("Bucket <=");
+    for (size_t b = 0; b + 1 < CAMERA_LATENCY_BUCKETS; b++) {
+        Serial.printf(" %6lu", (unsigned long)CAMERA_REPLY_BUCKET_US[b]);
+    }
+    Serial.println("   more");
+
+    for (size_t i = 0; i < stats.size(); i++) {
+        const CameraCommandStats& s = stats.at(i);
+        if (s.firstByte.count == 0) {
+            continue;
+        }
+        const CameraLatencyHistogram* hist[2] = {&s.firstByte, &s.transfer};
+        const char* label[2] = {"first", "xfer "};
+        Serial.printf("%s (0x%02X/0x%02X)\n", cameraCommandName(s.cls, s.subcls), s.cls, s.subcls);
+        for (uint8_t h = 0; h < 2; h++) {
+            Serial.printf("  %s   ", label[h]);
+            for (size_t b = 0; b < CAMERA_LATENCY_BUCKETS; b++) {
+                Serial.printf(" %6lu", (unsigned long)hist[h]->buckets[b]);
+            }
+            Serial.printf("  p50=%lu p99=%lu max=%lu\n", (unsigned long)hist[h]->percentileUs(50),
+                          (unsigned long)hist[h]->percentileUs(99), (unsigned long)hist[h]->maxUs);
+        }
+    }
+    Serial.println("");
+#else
+    printError("Statistics disabled (CAMERA_ENABLE_STATS=0)");
+#endif
+}
+
+void MenuSystem::dumpCapture() {
+#if CAMERA_ENABLE_CAPTURE
+    _camera->dumpCapture(Serial);
+#else
+    printError("Capture disabled (CAMERA_ENABLE_CAPTURE=0)");
+#endif
+}
+
+void MenuSystem::toggleCapture() {
+#if CAMERA_ENABLE_CAPTURE
+    bool enable = !_camera->getCapture().enabled();
+    _camera->resetCapture();
+    _camera->enableCapture(enable);
+    printSuccess(enable ? "Capture started" : "Capture stopped");
+#else
+    printError("Capture disabled (CAMERA_ENABLE_CAPTURE=0)");
+#endif
+}
+
+void MenuSystem::printLoopProfile() {
+#if CAMERA_ENABLE_PROFILER
+    CameraProfiler& profiler = _camera->getProfiler();
+    Serial.printf("\n⏱️ Loop Profile (budget %lu us):\n", (unsigned long)profiler.budgetUs());
+    Serial.printf("%-12s %8s %8s %8s %8s %8s\n", "Section", "Calls", "Mean", "p50", "p99", "Max");
+    for (uint8_t i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        const CameraLatencyHistogram& h = profiler.section((ProfileSection)i);
+        Serial.printf("%-12s %8lu %8lu %8lu %8lu %8lu\n", PROFILE_SECTION_NAMES[i], (unsigned long)h.count,
+                      (unsigned long)h.meanUs(), (unsigned long)h.percentileUs(50),
+                      (unsigned long)h.percentileUs(99), (unsigned long)h.maxUs);
+    }
+
+    Serial.printf("Stalls: %lu\n", (unsigned long)profiler.stallCount());
+    for (size_t i = 0; i < profiler.stalls().size(); i++) {
+        const CameraStall& stall = profiler.stalls().at(i);
+        Serial.printf("  @%lu %s %lu us <- %s (0x%02X/0x%02X)\n", (unsigned long)stall.timestamp,
+                      PROFILE_SECTION_NAMES[stall.section], (unsigned long)stall.durationUs,
+                      cameraCommandName(stall.cls, stall.subcls), stall.cls, stall.subcls);
+    }
+    Serial.println("");
+#else
+    printError("Profiler disabled (CAMERA_ENABLE_PROFILER=0)");
+#endif
+}
+
 // Utilidades
-void MenuSystem::requestInput(String prompt, void (MenuSystem::*handler)(String)) {
+void MenuSystem::requestInput(const char* prompt, void (MenuSystem::*handler)(const String&)) {
     _waitingForInput = true;
     _inputPrompt = prompt;
     _inputHandler = handler;
     Serial.println(prompt);
 }
 
-void MenuSystem::printMenuHeader(String title) {
-    String separator = "";
-    for (int i = 0; i < title.length() + 8; i++) {
-        separator += "=";
-    }
+void MenuSystem::printMenuHeader(const char* title) {
+    size_t width = strlen(title) + 8;
     
-    Serial.println("\n" + separator);
-    Serial.println("=== " + title + " ===");
-    Serial.println(separator);
+    Serial.println();
+    printRule('=', width);
+    Serial.printf("=== %s ===\n", title);
+    printRule('=', width);
 }
 
 void MenuSystem::printSeparator() {
-    String separator = "";
-    for (int i = 0; i < 30; i++) {
-        separator += "-";
+    printRule('-', 30);
+}
+
+void MenuSystem::printRule(char c, size_t width) {
+    for (size_t i = 0; i < width; i++) {
+        Serial.write((uint8_t)c);
     }
-    Serial.println(separator);
+    Serial.println();
 }
 
-void MenuSystem::printMenuItem(int number, String name, String description) {
-    Serial.print(String(number) + " - " + name);
-    if (description.length() > 0) {
-        Serial.println(" (" + description + ")");
+void MenuSystem::printMenuItem(int number, const char* name, const char* description) {
+    if (description && description[0]) {
+        Serial.printf("%d - %s (%s)\n", number, name, description);
     } else {
-        Serial.println();
+        Serial.printf("%d - %s\n", number, name);
     }
 }
 
-bool MenuSystem::validateNumericInput(String input, int min, int max) {
+bool MenuSystem::validateNumericInput(const String& input, int min, int max) {
     int value = input.toInt();
     if (value < min || value > max) {
-        printError("Value must be between " + String(min) + " and " + String(max));
+        char message[48];
+        snprintf(message, sizeof(message), "Value must be between %d and %d", min, max);
+        printError(message);
         return false;
     }
     return true;
 }
 
-void MenuSystem::printError(String error) {
-    Serial.println("❌ Error: " + error);
+void MenuSystem::printError(const char* error) {
+    Serial.printf("❌ Error: %s\n", error);
 }
 
-void MenuSystem::printSuccess(String message) {
-    Serial.println("✅ " + message);
+void MenuSystem::printCameraError() {
+    CommandStatus status = _camera->getLastCommandStatus();
+    Serial.printf("❌ Error: %s (0x%02X/0x%02X)\n", cameraErrorText(status.code), status.cls, status.subcls);
+}
+
+void MenuSystem::printSuccess(const char* message) {
+    Serial.printf("✅ %s\n", message);
 }
 
 void MenuSystem::returnToMainMenu() {
@@ -450,4 +604,6 @@ void MenuSystem::handleInfoMenuChoice(int choice) {
             printError("Invalid option.");
             break;
     }
-}
\ No newline at end of file
+}
+
+#endif // CAMERA_ENABLE_MENU
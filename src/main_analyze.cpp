@@ -0,0 +1,92 @@
+/**
+ * Analizador offline de capturas UART (host)
+ *
+ * Este archivo reemplaza a main.cpp en el entorno native_analyze. Lee una o
+ * varias capturas (binario de exportTo() o texto de dumpCapture(), p. ej.
+ * los logs de un vuelo partidos en varios archivos, en orden) mapeadas en
+ * memoria y decodifica cada trama con las tablas del firmware.
+ *
+ *   analyze <captura>... [--csv comandos.csv] [--json resumen.json]
+ *           [--decode] [--burst-window ms] [--burst-min n]
+ *       --decode  imprime cada trama RX decodificada (mucho más lento)
+ *
+ * Imprime totales, latencias y ráfagas de errores por stdout y el ritmo de
+ * procesado (MB/s y registros/s) por stderr.
+ */
+
+#include <Arduino.h>
+#include "CameraLogAnalyzer.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#error "main_analyze.cpp solo compila en el entorno native"
+#endif
+
+void usage() {
+    Serial.println("Uso: analyze <captura>... [--csv archivo] [--json archivo] [--decode]");
+    Serial.println("                          [--burst-window ms] [--burst-min n]");
+    exit(2);
+}
+
+void setup() {
+    Serial.begin(115200);
+
+    AnalyzerOptions options;
+    const char* csvPath = nullptr;
+    const char* jsonPath = nullptr;
+    std::vector<const char*> files;
+    for (int i = 1; i < hostArgc; i++) {
+        const char* arg = hostArgv[i];
+        if (strcmp(arg, "--csv") == 0 && i + 1 < hostArgc) {
+            csvPath = hostArgv[++i];
+        } else if (strcmp(arg, "--json") == 0 && i + 1 < hostArgc) {
+            jsonPath = hostArgv[++i];
+        } else if (strcmp(arg, "--decode") == 0) {
+            options.decodeOut = &Serial;
+        } else if (strcmp(arg, "--burst-window") == 0 && i + 1 < hostArgc) {
+            options.burstWindowMs = strtoul(hostArgv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--burst-min") == 0 && i + 1 < hostArgc) {
+            options.burstMinErrors = strtoul(hostArgv[++i], nullptr, 10);
+        } else if (arg[0] != '-') {
+            files.push_back(arg);
+        } else {
+            usage();
+        }
+    }
+    if (files.empty()) {
+        usage();
+    }
+
+    CameraLogAnalyzer analyzer(options);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < files.size(); i++) {
+        if (!analyzer.analyzeFile(files[i])) {
+            fprintf(stderr, "❌ No se pudo leer %s\n", files[i]);
+            exit(1);
+        }
+    }
+    analyzer.finish();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    analyzer.printSummary(Serial);
+    const AnalyzerTotals& t = analyzer.totals();
+    fprintf(stderr, "%.1f MB en %.3f s: %.0f MB/s, %.2f M registros/s, %.2f M tramas/s\n", t.inputBytes / 1e6, seconds,
+            seconds > 0 ? t.inputBytes / 1e6 / seconds : 0.0, seconds > 0 ? t.records / 1e6 / seconds : 0.0,
+            seconds > 0 ? (t.txFrames + t.rxFrames) / 1e6 / seconds : 0.0);
+
+    if (csvPath && !analyzer.writeCsv(csvPath)) {
+        fprintf(stderr, "❌ No se pudo crear %s\n", csvPath);
+        exit(1);
+    }
+    if (jsonPath && !analyzer.writeJson(jsonPath)) {
+        fprintf(stderr, "❌ No se pudo crear %s\n", jsonPath);
+        exit(1);
+    }
+    exit(0);
+}
+
+void loop() {
+}
@@ -0,0 +1,261 @@
+/**
+ * Microbenchmarks del protocolo del ThermalCameraController
+ *
+ * Este archivo reemplaza a main.cpp y mide las rutas calientes:
+ * construcción de tramas y checksum, validación y parseo de respuestas,
+ * interpretación a texto, comandos extremo a extremo y getDeviceInfo().
+ * Cada resultado sale como una línea JSON (JSON Lines) para comparar builds:
+ *
+ *   {"bench":"build_command","iterations":200000,"ns_per_op":21.4,...}
+ *
+ * En el host (pio run -e native_bench -t exec) los comandos van contra el
+ * simulador con reloj virtual: "virtual_us_per_op" es el tiempo de protocolo
+ * y "ns_per_op" el coste de CPU. En el ESP32 (pio run -e bench) van contra
+ * la cámara real conectada a GPIO16/17.
+ */
+
+#include <Arduino.h>
+#include "CameraController.h"
+#include "CameraAlloc.h"
+#include "CameraClock.h"
+#include "CameraText.h"
+
+#ifndef ARDUINO
+#include "CameraSimulator.h"
+#if !CAMERA_INJECTABLE_CLOCK
+#error "El benchmark del host necesita CAMERA_INJECTABLE_CLOCK=1 (reloj virtual)"
+#endif
+#endif
+
+// Configuración de pines
+#define RX_PIN 16
+#define TX_PIN 17
+
+// Iteraciones por benchmark
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS 200000UL
+#endif
+#ifndef BENCH_COMMANDS
+#define BENCH_COMMANDS 50UL
+#endif
+
+// Crear instancias
+HardwareSerial cameraSerial(2);
+CameraController camera(&cameraSerial, RX_PIN, TX_PIN);
+#ifndef ARDUINO
+CameraSimulator simulator;
+CameraVirtualClock virtualClock;
+#endif
+
+static volatile uint32_t sink = 0;
+
+// Respuestas de ejemplo (se completan en makeReplies)
+#define REPLY_COUNT 5
+static uint8_t replies[REPLY_COUNT][24];
+static size_t replyLengths[REPLY_COUNT];
+
+/**
+ * Construye F0 SIZE 36 CLS SUB 01 LEN DATA CHK FF.
+ */
+size_t makeReply(uint8_t* out, uint8_t cls, uint8_t subcls, const uint8_t* data, uint8_t length) {
+    size_t n = 0;
+    out[n++] = HEADER_BYTE;
+    out[n++] = (uint8_t)(5 + length);
+    out[n++] = DEVICE_ADDR;
+    out[n++] = cls;
+    out[n++] = subcls;
+    out[n++] = FLAG_READ;
+    out[n++] = length;
+    memcpy(&out[n], data, length);
+    n += length;
+    uint8_t sum = 0;
+    for (size_t i = 2; i < n; i++) {
+        sum += out[i];
+    }
+    out[n++] = sum;
+    out[n++] = FOOTER_BYTE;
+    return n;
+}
+
+void makeReplies() {
+    const uint8_t brightness[] = {75};
+    const uint8_t version[] = {2, 1, 0};
+    const uint8_t date[] = {0x01, 0x34, 0xD6, 0x7B};
+    const uint8_t model[] = {'J', 'S', '-', 'M', 'I', 'N', 'I', '2', '5', '6', '-', '9'};
+    const uint8_t status[] = {CAMERA_ACTIVE};
+    replyLengths[0] = makeReply(replies[0], CLASS_IMAGE, 0x02, brightness, sizeof(brightness));
+    replyLengths[1] = makeReply(replies[1], CLASS_INFO, 0x03, version, sizeof(version));
+    replyLengths[2] = makeReply(replies[2], CLASS_INFO, 0x04, date, sizeof(date));
+    replyLengths[3] = makeReply(replies[3], CLASS_INFO, 0x02, model, sizeof(model));
+    replyLengths[4] = makeReply(replies[4], CLASS_CAMERA, 0x14, status, sizeof(status));
+}
+
+/**
+ * Imprime un resultado como una línea JSON.
+ * @param virtualUs Tiempo de protocolo total (reloj virtual), o negativo si no aplica.
+ */
+void report(const char* name, uint32_t iterations, uint32_t elapsedUs, uint32_t allocs, double virtualUs) {
+    double nsPerOp = elapsedUs * 1000.0 / iterations;
+    Serial.printf("{\"bench\":\"%s\",\"iterations\":%lu,\"total_us\":%lu,\"ns_per_op\":%.1f,"
+                  "\"ops_per_sec\":%.0f,\"allocs_per_op\":",
+                  name, (unsigned long)iterations, (unsigned long)elapsedUs, nsPerOp,
+                  elapsedUs ? iterations * 1e6 / elapsedUs : 0.0);
+#if CAMERA_TRACK_ALLOCATIONS
+    Serial.printf("%.3f", (double)allocs / iterations);
+#else
+    (void)allocs;
+    Serial.print("null");
+#endif
+    if (virtualUs >= 0) {
+        Serial.printf(",\"virtual_us_per_op\":%.1f,\"virtual_ops_per_sec\":", virtualUs / iterations);
+        if (virtualUs > 0) {
+            Serial.printf("%.1f", iterations * 1e6 / virtualUs);
+        } else {
+            Serial.print("null"); // sin tiempo de protocolo (escrituras): no es 0 ops/s
+        }
+    }
+    Serial.println("}");
+}
+
+/**
+ * Ejecuta fn iterations veces midiendo tiempo real, reservas y, si hay un
+ * reloj instalado (host), tiempo virtual de protocolo.
+ */
+template <typename F>
+void bench(const char* name, uint32_t iterations, F fn) {
+    for (uint32_t i = 0; i < iterations / 100 + 1; i++) {
+        fn(i); // calentamiento
+    }
+    CameraAllocSnapshot before = cameraAllocSnapshot();
+    uint32_t virtualStart = cameraMicros();
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < iterations; i++) {
+        fn(i);
+    }
+    uint32_t elapsed = micros() - start;
+    uint32_t virtualElapsed = cameraMicros() - virtualStart;
+    CameraAllocSnapshot after = cameraAllocSnapshot();
+
+    double virtualUs = -1;
+#if CAMERA_INJECTABLE_CLOCK
+    if (cameraGetClock()) {
+        virtualUs = virtualElapsed;
+    }
+#else
+    (void)virtualElapsed;
+#endif
+    report(name, iterations, elapsed, after.allocs - before.allocs, virtualUs);
+}
+
+void printMeta() {
+    Serial.printf("{\"meta\":{\"platform\":\"%s\",\"static_allocation\":%d,\"interpretation\":%d,"
+                  "\"log_level\":%d,\"stats\":%d,\"capture\":%d,\"profiler\":%d,\"trace\":%d,"
+                  "\"alloc_tracking\":%d}}\n",
+#ifdef ARDUINO
+                  "esp32",
+#else
+                  "host",
+#endif
+                  CAMERA_STATIC_ALLOCATION, CAMERA_ENABLE_INTERPRETATION, CAMERA_LOG_LEVEL, CAMERA_ENABLE_STATS,
+                  CAMERA_ENABLE_CAPTURE, CAMERA_ENABLE_PROFILER, CAMERA_ENABLE_TRACE, CAMERA_TRACK_ALLOCATIONS);
+}
+
+void benchFrames() {
+    uint8_t frame[16];
+    const uint8_t data[] = {50};
+
+    bench("build_command", BENCH_ITERATIONS, [&](uint32_t i) {
+        CameraController::buildCommand(frame, DEVICE_ADDR, CLASS_IMAGE, (uint8_t)i, FLAG_WRITE, data, 1);
+        sink += frame[7];
+    });
+    bench("checksum", BENCH_ITERATIONS, [&](uint32_t i) {
+        sink += CameraController::calculateChecksum(DEVICE_ADDR, CLASS_IMAGE, (uint8_t)i, FLAG_WRITE, data, 1);
+    });
+    bench("validate_frame", BENCH_ITERATIONS, [&](uint32_t i) {
+        uint32_t r = i % REPLY_COUNT;
+        sink += CameraController::validateFrame(replies[r], replyLengths[r]);
+    });
+
+    char text[CAMERA_TEXT_SIZE];
+    bench("interpret_frame", BENCH_ITERATIONS / 10, [&](uint32_t i) {
+        uint32_t r = i % REPLY_COUNT;
+        sink += cameraInterpretFrame(replies[r], replyLengths[r], text, sizeof(text));
+    });
+}
+
+#ifndef ARDUINO
+/**
+ * Ruta RX completa del controlador (lectura, resync, validación, entrega)
+ * con bytes inyectados en el transporte en memoria.
+ */
+void benchParser() {
+    simulator.detach();
+    cameraSetClock(&virtualClock);
+    bench("parse_frame", BENCH_ITERATIONS / 10, [&](uint32_t i) {
+        uint32_t r = i % REPLY_COUNT;
+        cameraSerial.inject(replies[r], replyLengths[r]);
+        camera.update();                    // lee los bytes
+        virtualClock.delay(BYTE_TIMEOUT + 1);
+        camera.update();                    // silencio entre bytes: trama completa
+    });
+    cameraSetClock(nullptr);
+    simulator.attach(cameraSerial);
+}
+#endif
+
+void benchCommands() {
+#ifndef ARDUINO
+    cameraSetClock(&virtualClock);
+#endif
+    uint32_t failures = 0;
+    bench("command_read", BENCH_COMMANDS, [&](uint32_t) {
+        if (camera.getBrightness() == 0) {
+            failures++;
+        }
+    });
+    bench("command_write", BENCH_COMMANDS, [&](uint32_t i) {
+        if (!camera.setContrast((uint8_t)(i % 100))) {
+            failures++;
+        }
+    });
+
+    CameraInfoPacked info;
+    bench("device_info", 10, [&](uint32_t) {
+        if (!camera.getDeviceInfo(info)) {
+            failures++;
+        }
+    });
+#ifndef ARDUINO
+    cameraSetClock(nullptr);
+#endif
+
+    if (failures) {
+        Serial.printf("{\"warning\":\"%lu comandos fallidos (¿cámara conectada?)\"}\n", (unsigned long)failures);
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+#ifndef ARDUINO
+    simulator.attach(cameraSerial);
+#endif
+    camera.begin();
+    makeReplies();
+
+    printMeta();
+    benchFrames();
+#ifndef ARDUINO
+    benchParser();
+#endif
+    benchCommands();
+
+#ifndef ARDUINO
+    exit(0);
+#endif
+}
+
+void loop() {
+    delay(1000);
+}
@@ -0,0 +1,161 @@
+/**
+ * Procedimientos de varios pasos con corrutinas C++20 (CameraSequencer)
+ *
+ * Este archivo reemplaza a main.cpp y lanza tres procedimientos a la vez
+ * sobre la tarea de E/S: un barrido de versiones (como getDeviceInfo), una
+ * calibración (FFC, espera y comprobación) y un snapshot/restore del
+ * brillo y la paleta. Cada co_await cede el control, así que se intercalan
+ * en el mismo núcleo y el loop sigue girando: al final se imprime cuántas
+ * vueltas dio mientras los procedimientos esperaban a la cámara.
+ *
+ * Necesita un compilador con corrutinas (GCC >= 10 con -std=gnu++20).
+ * En el host (pio run -e native_coro -t exec) va contra el simulador y
+ * termina con código 0 si los tres procedimientos acaban con CAMERA_OK.
+ */
+
+#include <Arduino.h>
+#include "CameraController.h"
+#include "CameraCoroutine.h"
+#include "CameraText.h"
+
+#if !CAMERA_HAS_COROUTINES
+#error "Este ejemplo necesita corrutinas C++20 (-std=gnu++20, GCC >= 10)"
+#endif
+
+#ifndef ARDUINO
+#include "CameraSimulator.h"
+#endif
+
+// Configuración de pines
+#define RX_PIN 16
+#define TX_PIN 17
+
+// Crear instancias
+HardwareSerial cameraSerial(2);
+CameraController camera(&cameraSerial, RX_PIN, TX_PIN);
+CameraTask cameraIo(camera);
+CameraSequencer sequencer(cameraIo);
+#ifndef ARDUINO
+CameraSimulator simulator;
+#endif
+
+uint32_t loops = 0;
+uint8_t finished = 0;
+uint8_t failed = 0;
+
+/**
+ * Lee las versiones del módulo una a una, en segundo plano.
+ */
+CameraProcedure versionSweep(CameraSequencer& seq) {
+    static const uint8_t registers[] = {0x03, 0x05, 0x07, 0x08};
+    for (uint8_t subcls : registers) {
+        CameraEvent ev = co_await seq.read(CLASS_INFO, subcls, CAMERA_PRIORITY_BACKGROUND);
+        if (ev.code != CAMERA_OK) {
+            co_return ev.code;
+        }
+        Serial.printf("[versiones] %s: %u.%u.%u\n", cameraCommandName(CLASS_INFO, subcls), ev.data[0],
+                      ev.data[1], ev.data[2]);
+    }
+    co_return CAMERA_OK;
+}
+
+/**
+ * Lee un registro de un byte; usado por los demás procedimientos con co_await.
+ */
+CameraProcedure readByte(CameraSequencer& seq, uint8_t cls, uint8_t subcls, uint8_t& value) {
+    CameraEvent ev = co_await seq.read(cls, subcls);
+    if (ev.code == CAMERA_OK && ev.length >= 1) {
+        value = ev.data[0];
+    }
+    co_return ev.code;
+}
+
+/**
+ * FFC, espera a que el obturador termine y comprueba que la imagen responde.
+ */
+CameraProcedure calibration(CameraSequencer& seq) {
+    CameraEvent ev = co_await seq.write(CLASS_CAMERA, 0x02, nullptr, 0, CAMERA_PRIORITY_URGENT);
+    if (ev.code != CAMERA_OK) {
+        co_return ev.code;
+    }
+    Serial.println("[calibración] FFC enviado, esperando 1 s");
+    co_await seq.delay(1000);
+    uint8_t brightness = 0;
+    CameraErrorCode code = co_await readByte(seq, CLASS_IMAGE, 0x02, brightness);
+    Serial.printf("[calibración] brillo tras FFC: %u\n", brightness);
+    co_return code;
+}
+
+/**
+ * Guarda brillo y paleta, prueba otros valores un momento y los restaura.
+ */
+CameraProcedure snapshotRestore(CameraSequencer& seq) {
+    uint8_t brightness = 0;
+    uint8_t palette = 0;
+    CameraErrorCode code = co_await readByte(seq, CLASS_IMAGE, 0x02, brightness);
+    if (code == CAMERA_OK) {
+        code = co_await readByte(seq, CLASS_IMAGE, 0x20, palette);
+    }
+    if (code != CAMERA_OK) {
+        co_return code;
+    }
+    Serial.printf("[snapshot] brillo %u, paleta %u\n", brightness, palette);
+
+    uint8_t probe[] = {90, PALETTE_IRON};
+    co_await seq.write(CLASS_IMAGE, 0x02, &probe[0], 1);
+    co_await seq.write(CLASS_IMAGE, 0x20, &probe[1], 1);
+    co_await seq.delay(500);
+
+    co_await seq.write(CLASS_IMAGE, 0x02, &brightness, 1);
+    co_await seq.write(CLASS_IMAGE, 0x20, &palette, 1);
+    uint8_t restored = 0;
+    code = co_await readByte(seq, CLASS_IMAGE, 0x02, restored);
+    Serial.printf("[snapshot] restaurado brillo %u\n", restored);
+    co_return (code == CAMERA_OK && restored != brightness) ? CAMERA_ERR_OUT_OF_RANGE : code;
+}
+
+void onFinished(CameraErrorCode code) {
+    finished++;
+    if (code != CAMERA_OK) {
+        failed++;
+        Serial.printf("❌ Procedimiento terminado con error: %s\n", cameraErrorText(code));
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println("=== Thermal Camera Controller - Corrutinas ===");
+
+#ifndef ARDUINO
+    simulator.attach(cameraSerial);
+#endif
+    if (!camera.begin() || !cameraIo.begin()) {
+        Serial.println("❌ Error al inicializar la cámara");
+        return;
+    }
+
+    sequencer.setFinishedHandler(onFinished);
+    sequencer.start(versionSweep(sequencer));
+    sequencer.start(calibration(sequencer));
+    sequencer.start(snapshotRestore(sequencer));
+}
+
+void loop() {
+    loops++;
+    if (sequencer.update() > 0) {
+        delay(1);
+        return;
+    }
+    if (finished == 0) {
+        return;
+    }
+    Serial.printf("%u procedimientos terminados (%u con error), %lu vueltas del loop mientras tanto\n", finished,
+                  failed, (unsigned long)loops);
+    cameraIo.printStats(Serial);
+#ifndef ARDUINO
+    cameraIo.end();
+    exit(failed == 0 ? 0 : 1);
+#else
+    finished = 0;
+#endif
+}
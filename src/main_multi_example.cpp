@@ -0,0 +1,106 @@
+/**
+ * Ejemplo de varias cámaras, cada una en su UART (CameraGroup)
+ *
+ * Este archivo reemplaza a main.cpp: dos cámaras (p. ej. con distinta
+ * lente) en UART1 y UART2. Al arrancar se difunde el mismo preset a las
+ * dos y se imprime cuánto tardó el lote completo, que debe parecerse al
+ * de una sola cámara porque ninguna espera a la otra. Después el loop lee
+ * el brillo de ambas cada READ_MS, cambia la paleta de las dos cada
+ * WRITE_MS y lanza un FFC periódico escalonado: nunca se congelan las dos
+ * imágenes a la vez. Cada REPORT_MS imprime las estadísticas del grupo.
+ * Un ESP32-S3 tiene una UART más para una tercera cámara.
+ *
+ * Para compilar y ejecutar: pio run -e multi_example -t upload -t monitor
+ */
+
+#include <Arduino.h>
+#include "CameraController.h"
+#include "CameraGroup.h"
+#include "CameraTask.h"
+
+// Configuración de pines
+#define RX_PIN_A 16
+#define TX_PIN_A 17
+#define RX_PIN_B 25
+#define TX_PIN_B 26
+
+// Periodos de lectura, escritura, FFC e informe
+#define READ_MS 200
+#define WRITE_MS 3000
+#define FFC_MS 60000
+#define REPORT_MS 5000
+
+// Crear instancias
+HardwareSerial serialA(2);
+HardwareSerial serialB(1);
+CameraController cameraA(&serialA, RX_PIN_A, TX_PIN_A);
+CameraController cameraB(&serialB, RX_PIN_B, TX_PIN_B);
+CameraTask ioA(cameraA);
+CameraTask ioB(cameraB);
+CameraGroup cameras;
+
+// Preset común: brillo, contraste, paleta y obturador manual (el FFC lo
+// decide el grupo, escalonado)
+const CameraSetting preset[] = {
+    {CLASS_IMAGE, 0x02, 50},
+    {CLASS_IMAGE, 0x03, 50},
+    {CLASS_IMAGE, 0x20, PALETTE_WHITE_HOT},
+    {CLASS_CAMERA, 0x04, SHUTTER_MANUAL},
+};
+
+uint32_t lastRead = 0;
+uint32_t lastWrite = 0;
+uint32_t lastReport = 0;
+uint8_t palette = PALETTE_WHITE_HOT;
+uint8_t brightness[CAMERA_GROUP_MAX];
+
+void onEvent(uint8_t index, const CameraEvent& event) {
+    if (event.code != CAMERA_OK) {
+        Serial.printf("Cámara %u: %s\n", index, cameraErrorText(event.code));
+    } else if (event.rw == FLAG_READ && event.subcls == 0x02 && event.length) {
+        brightness[index] = event.data[0];
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println("=== Thermal Camera Controller - Varias cámaras ===");
+
+    if (!cameraA.begin() || !cameraB.begin()) {
+        Serial.println("❌ Error al inicializar las cámaras");
+        return;
+    }
+    cameras.add(ioA);
+    cameras.add(ioB);
+    cameras.setEventHandler(onEvent);
+    cameras.begin();
+
+    cameras.applyAll(preset, sizeof(preset) / sizeof(preset[0]));
+    cameras.broadcast(CLASS_IMAGE, 0x02, FLAG_READ);   // confirmar que se aplicó
+    CameraErrorCode code = cameras.waitBroadcast();
+    Serial.printf("Preset en %u cámaras: %s en %lu us\n", (unsigned)cameras.size(), cameraErrorText(code),
+                  (unsigned long)cameras.stats().lastBatchUs);
+    cameras.setFfcInterval(FFC_MS);
+}
+
+void loop() {
+    uint32_t now = millis();
+
+    if (now - lastRead >= READ_MS) {
+        lastRead = now;
+        cameras.broadcast(CLASS_IMAGE, 0x02, FLAG_READ, nullptr, 0, CAMERA_PRIORITY_BACKGROUND);
+    }
+    if (now - lastWrite >= WRITE_MS) {
+        lastWrite = now;
+        palette = (palette + 1) % (PALETTE_COLOR7 + 1);
+        cameras.setPaletteAll((ColorPalette)palette);
+    }
+
+    cameras.update();
+
+    if (now - lastReport >= REPORT_MS) {
+        lastReport = now;
+        Serial.printf("\nBrillo A %u, B %u, paleta %u\n", brightness[0], brightness[1], palette);
+        cameras.printStats(Serial);
+    }
+}
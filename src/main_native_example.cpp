@@ -0,0 +1,685 @@
+/**
+ * Ejemplo nativo (Linux) del ThermalCameraController
+ *
+ * Este archivo reemplaza a main.cpp en el entorno native: el controlador
+ * habla con el simulador de cámara (host/CameraSimulator.h) a través de un
+ * transporte en memoria. Comprueba lecturas, escrituras y los fallos
+ * simulados (checksum corrupto, bytes perdidos, límite de comandos, fase de
+ * inicialización); termina con código 0 si todo pasa.
+ *
+ * Con el reloj virtual recorre una matriz de timeouts y pérdidas sin
+ * esperar en tiempo real. Al final repite una lectura a través de un pty,
+ * como lo haría un programa externo que abre /dev/pts/N.
+ *
+ * La tarea de E/S (CameraTask) se prueba con su hilo del host: la
+ * aplicación solo envía y recoge a través de las colas. El grupo de
+ * cámaras (CameraGroup) se prueba con tres simuladores, uno por UART.
+ *
+ * Para compilar y ejecutar: pio run -e native -t exec
+ */
+
+#include <Arduino.h>
+#include "CameraController.h"
+#include "CameraClock.h"
+#include "CameraGroup.h"
+#include "CameraSimulator.h"
+#include "CameraTask.h"
+#include <atomic>
+#include <thread>
+
+#ifdef ARDUINO
+#error "main_native_example.cpp solo compila en el entorno native"
+#endif
+
+// Crear instancias
+HardwareSerial cameraSerial(2);
+CameraController camera(&cameraSerial, 16, 17);
+CameraSimulator simulator;
+
+static int failures = 0;
+
+// Destino que solo cuenta bytes
+class NullPrint : public Print {
+public:
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t*, size_t size) override { return size; }
+};
+
+void check(const char* name, bool ok) {
+    Serial.printf("%s %s\n", ok ? "✅" : "❌", name);
+    if (!ok) {
+        failures++;
+    }
+}
+
+void testRegisters() {
+    Serial.println("\n=== Registros ===");
+    char model[CAMERA_MODEL_SIZE];
+    check("getModel() == JS-MINI256-9", camera.getModel(model, sizeof(model)) && strcmp(model, "JS-MINI256-9") == 0);
+
+    CameraInfoPacked info;
+    check("getDeviceInfo()", camera.getDeviceInfo(info) && info.fpgaBuildDate == 20240315UL &&
+                             info.softwareVersion[2] == 7 && info.status == CAMERA_ACTIVE);
+
+    // Un modelo de 24 bytes sin '\0' vuelve entero de la versión compacta
+    CameraInfoPacked packed;
+    memset(&packed, 0, sizeof(packed));
+    memcpy(packed.model, "ABCDEFGHIJKLMNOPQRSTUVWX", sizeof(packed.model));
+    CameraInfo unpacked;
+    cameraUnpackInfo(packed, unpacked);
+    check("cameraUnpackInfo() conserva un modelo de 24 bytes", String(unpacked.model) == "ABCDEFGHIJKLMNOPQRSTUVWX");
+    check("getDeviceInfo(CameraInfo)", camera.getDeviceInfo(unpacked) && String(unpacked.fpgaBuildDate) == "2024-3-15");
+
+    check("setBrightness(75)", camera.setBrightness(75));
+    check("getBrightness() == 75", camera.getBrightness() == 75);
+    check("setPalette(PALETTE_IRON)", camera.setPalette(PALETTE_IRON));
+    check("getCurrentPalette() == PALETTE_IRON", camera.getCurrentPalette() == PALETTE_IRON);
+    check("setShutterInterval(300)", camera.setShutterInterval(300));
+    check("getShutterInterval() == 300", camera.getShutterInterval() == 300);
+    check("setMirror(MIRROR_VERTICAL)", camera.setMirror(MIRROR_VERTICAL));
+    check("getCurrentMirror() == MIRROR_VERTICAL", camera.getCurrentMirror() == MIRROR_VERTICAL);
+
+    // Sin guardar, un reinicio vuelve a la configuración guardada
+    simulator.powerOn();
+    check("powerOn() sin guardar -> brillo 50", camera.getBrightness() == 50);
+    camera.setBrightness(80);
+    camera.saveConfiguration();
+    simulator.powerOn();
+    check("saveConfiguration() + powerOn() -> brillo 80", camera.getBrightness() == 80);
+    camera.restoreFactory();
+    check("restoreFactory() -> brillo 50", camera.getBrightness() == 50);
+
+#if CAMERA_ENABLE_STATS
+    // Los instantes de la UART son de consulta (1 ms): sin buckets por debajo
+    const CameraCommandStats* s = camera.getStats().find(CLASS_IMAGE, 0x02);
+    check("histogramas de respuesta desde 1 ms",
+          s && s->firstByte.count > 0 && s->firstByte.limitUs(0) == 1000 && s->transfer.limitUs(0) == 1000);
+#endif
+}
+
+/**
+ * Gira update() como el loop durante ms milisegundos (respuestas asíncronas).
+ */
+void pump(uint32_t ms) {
+    uint32_t start = millis();
+    while (millis() - start < ms) {
+        camera.update();
+        delay(1);
+    }
+}
+
+void testFaults() {
+    Serial.println("\n=== Fallos simulados ===");
+    CameraSimConfig config;
+
+    config.corruptChecksumRate = 1.0f;
+    simulator.setConfig(config);
+    check("checksum corrupto -> CAMERA_ERR_BAD_CHECKSUM",
+          camera.getContrast() == 0 && camera.getLastErrorCode() == CAMERA_ERR_BAD_CHECKSUM);
+
+    config = CameraSimConfig();
+    config.dropByteRate = 1.0f;
+    simulator.setConfig(config);
+    check("todos los bytes perdidos -> CAMERA_ERR_TIMEOUT",
+          camera.getContrast() == 0 && camera.getLastErrorCode() == CAMERA_ERR_TIMEOUT);
+
+    config = CameraSimConfig();
+    config.maxCommandsPerSec = 2;
+    simulator.setConfig(config);
+    simulator.powerOn();
+    camera.getContrast();
+    check("segundo comando dentro de 500 ms ignorado", !camera.getContrast());
+
+    config = CameraSimConfig();
+    config.initTimeMs = 200;
+    simulator.setConfig(config);
+    simulator.powerOn();
+    check("estado durante init == CAMERA_INITIALIZING", camera.getStatus() == CAMERA_INITIALIZING);
+    check("lectura durante init sin respuesta", camera.getBrightness() == 0);
+    delay(200);
+    check("estado tras init == CAMERA_ACTIVE", camera.getStatus() == CAMERA_ACTIVE);
+
+    config = CameraSimConfig();
+    config.latencyUs = 10000;
+    config.jitterUs = 5000;
+    simulator.setConfig(config);
+    uint32_t start = micros();
+    bool ok = camera.getBrightness() == 50;
+    uint32_t elapsed = micros() - start;
+    check("latencia >= 10 ms", ok && elapsed >= 10000);
+
+    // La captura se congela con errores del enlace, también asíncronos, y no con argumentos inválidos
+    camera.resetCapture();
+    camera.enableCapture(true, true);
+    check("argumento fuera de rango no congela la captura",
+          !camera.setBrightness(200) && !camera.getCapture().frozen());
+    config = CameraSimConfig();
+    config.ackWrites = true;
+    config.corruptChecksumRate = 1.0f;
+    simulator.setConfig(config);
+    camera.resetErrorCounts();
+    camera.setContrast(50);
+    pump(2 * BYTE_TIMEOUT);
+    check("confirmación asíncrona corrupta congela la captura",
+          camera.getErrorCount(CAMERA_ERR_BAD_CHECKSUM) == 1 && camera.getCapture().frozen());
+    camera.enableCapture(false);
+    camera.resetCapture();
+
+    // La confirmación de la escritura llega pegada a la respuesta de la lectura
+    config = CameraSimConfig();
+    config.ackWrites = true;
+    simulator.setConfig(config);
+    camera.resetErrorCounts();
+    camera.setContrast(60);
+    ok = camera.getContrast() == 60;
+    check("confirmación y respuesta seguidas se separan por SIZE",
+          ok && camera.getErrorCount(CAMERA_ERR_BAD_CHECKSUM) == 0);
+    camera.setContrast(50);
+    pump(2 * BYTE_TIMEOUT);
+
+    simulator.setConfig(CameraSimConfig());
+}
+
+/**
+ * Barrido timeout x pérdida de bytes con el reloj virtual: cada combinación
+ * ejecuta 100 lecturas; las que agotan el timeout no esperan de verdad.
+ */
+void testVirtualClock() {
+    Serial.println("\n=== Reloj virtual ===");
+    static const uint16_t timeouts[] = {20, 50, 150, 500};
+    static const float dropRates[] = {0.0f, 0.05f, 0.5f, 1.0f};
+    CameraVirtualClock clock;
+    cameraSetClock(&clock);
+    simulator.powerOn();
+
+    unsigned long wallStart = millis();
+    uint32_t timeoutCount = 0;
+    for (size_t t = 0; t < sizeof(timeouts) / sizeof(timeouts[0]); t++) {
+        for (size_t d = 0; d < sizeof(dropRates) / sizeof(dropRates[0]); d++) {
+            CameraSimConfig config;
+            config.dropByteRate = dropRates[d];
+            config.jitterUs = 3000;
+            simulator.setConfig(config);
+            camera.setTimeouts(timeouts[t], 5);
+            camera.resetErrorCounts();
+            for (int i = 0; i < 100; i++) {
+                camera.getBrightness();
+                camera.update();
+            }
+            uint32_t count = camera.getErrorCount(CAMERA_ERR_TIMEOUT);
+            uint32_t invalid = camera.getErrorCount(CAMERA_ERR_BAD_CHECKSUM) +
+                               camera.getErrorCount(CAMERA_ERR_SHORT_FRAME);
+            Serial.printf("timeout=%3u ms drop=%.2f -> %3lu timeouts, %3lu tramas inválidas\n", timeouts[t],
+                          dropRates[d], (unsigned long)count, (unsigned long)invalid);
+            timeoutCount += count;
+        }
+    }
+    unsigned long wallMs = millis() - wallStart;
+    uint64_t virtualMs = clock.nowUs() / 1000;
+    Serial.printf("%lu ms virtuales en %lu ms reales\n", (unsigned long)virtualMs, wallMs);
+    check("timeouts con pérdida total", timeoutCount >= 400);
+    check("más rápido que el tiempo real", virtualMs > 10 * wallMs);
+
+    cameraSetClock(nullptr);
+    simulator.setConfig(CameraSimConfig());
+    camera.setTimeouts(50, 2);
+}
+
+void testPty() {
+    Serial.println("\n=== Pty ===");
+    CameraSimulator ptySimulator;
+    char name[64];
+    if (!ptySimulator.openPty(name, sizeof(name))) {
+        check("openPty()", false);
+        return;
+    }
+
+    std::atomic<bool> running(true);
+    std::thread device([&]() {
+        while (running) {
+            ptySimulator.poll();
+            delayMicroseconds(100);
+        }
+    });
+
+    HardwareSerial ptySerial(1);
+    CameraController ptyCamera(&ptySerial, 16, 17);
+    ptyCamera.setTimeouts(100, 5);
+    char model[CAMERA_MODEL_SIZE];
+    check("openDevice(pty)", ptySerial.openDevice(name));
+    check("begin() por pty", ptyCamera.begin());
+    check("getModel() por pty", ptyCamera.getModel(model, sizeof(model)) && strcmp(model, "JS-MINI256-9") == 0);
+
+    running = false;
+    device.join();
+}
+
+/**
+ * Espera eventos de la tarea de E/S hasta recoger `count` o agotar el plazo.
+ * @return Eventos recogidos (los guarda en events).
+ */
+size_t collect(CameraTask& io, CameraEvent* events, size_t count, uint32_t timeoutMs) {
+    size_t received = 0;
+    uint32_t start = millis();
+    while (received < count && millis() - start < timeoutMs) {
+        if (!io.poll(events[received])) {
+            delay(1);
+            continue;
+        }
+        received++;
+    }
+    return received;
+}
+
+void testTask() {
+    Serial.println("\n=== Tarea de E/S ===");
+    simulator.setConfig(CameraSimConfig());
+    simulator.powerOn();
+
+    CameraTask io(camera);
+    check("begin() de la tarea", io.begin());
+    check("segundo begin() rechazado", !io.begin());
+
+    uint8_t brightness = 42;
+    uint32_t writeId = io.postWrite(CLASS_IMAGE, 0x02, &brightness, 1);
+    uint32_t readId = io.postRead(CLASS_IMAGE, 0x02);
+    CameraEvent events[CAMERA_QUEUE_DEPTH];
+    check("escritura y lectura completadas", collect(io, events, 2, 1000) == 2);
+    check("eventos en orden", events[0].id == writeId && events[1].id == readId);
+    check("lectura de brillo == 42", events[1].code == CAMERA_OK && events[1].length == 1 && events[1].data[0] == 42);
+    check("marcas de tiempo ordenadas",
+          events[1].startUs - events[1].postedUs <= events[1].doneUs - events[1].postedUs);
+
+    // Ráfaga que llena la cola: lo que no cabe se rechaza sin bloquear
+    uint32_t accepted = 0;
+    uint32_t start = micros();
+    for (int i = 0; i < CAMERA_QUEUE_DEPTH * 2; i++) {
+        if (io.postRead(CLASS_IMAGE, 0x03)) {
+            accepted++;
+        }
+    }
+    uint32_t postUs = micros() - start;
+    check("post() no bloquea (< 1 ms la ráfaga)", postUs < 1000);
+    check("ráfaga completada", collect(io, events, accepted, 2000) == accepted);
+    const CameraTaskStats& stats = io.stats();
+    check("máximo de cola <= CAMERA_QUEUE_DEPTH", stats.commandHighWater <= CAMERA_QUEUE_DEPTH);
+    check("enviados == completados", stats.posted == stats.completed);
+
+    // Petición preparada enviada como desde una interrupción (otro hilo)
+    CameraRequest ffc = CameraTask::prepare(CLASS_CAMERA, 0x02, FLAG_WRITE);
+    ffc.id = 0xFFC;
+    bool isrOk = false;
+    std::thread isr([&]() { isrOk = io.postFromISR(ffc); });
+    isr.join();
+    check("postFromISR()", isrOk);
+    check("evento de la ISR", collect(io, events, 1, 1000) == 1 && events[0].fromIsr && events[0].id == 0xFFC &&
+                              events[0].code == CAMERA_OK);
+    check("ISR -> TX < 1 ms", events[0].startUs - events[0].postedUs < 1000);
+
+    // Tres "tareas" a la vez, cada una con su ranura de resultado
+    uint8_t contrast = 33;
+    uint8_t palette = PALETTE_IRON;
+    check("write() contraste", io.write(CLASS_IMAGE, 0x03, &contrast, 1) == CAMERA_OK);
+    check("write() paleta", io.write(CLASS_IMAGE, 0x20, &palette, 1) == CAMERA_OK);
+    std::atomic<int> wrong(0);
+    struct Reader {
+        uint8_t subcls;
+        uint8_t expected;
+    };
+    const Reader readers[] = {{0x02, 42}, {0x03, 33}, {0x20, PALETTE_IRON}};
+    std::thread threads[3];
+    for (int t = 0; t < 3; t++) {
+        const Reader reader = readers[t];
+        threads[t] = std::thread([&io, &wrong, reader]() {
+            for (int i = 0; i < 50; i++) {
+                CameraEvent result;
+                if (io.read(CLASS_IMAGE, reader.subcls, result) != CAMERA_OK || result.subcls != reader.subcls ||
+                    result.length != 1 || result.data[0] != reader.expected) {
+                    wrong++;
+                }
+            }
+        });
+    }
+    for (int t = 0; t < 3; t++) {
+        threads[t].join();
+    }
+    check("150 lecturas concurrentes, cada una con su resultado", wrong == 0);
+    check("llamadas contadas", io.stats().calls == 152);
+
+    io.end();
+    check("end() detiene la tarea", !io.running());
+
+    // El log lo llena la tarea de E/S y se vacía desde aquí (otra tarea)
+    NullPrint sink;
+    camera.flushLog(sink); // desde ahora update() no lo vacía
+    camera.enableDebug(true);
+    io.begin();
+    for (int i = 0; i < 8; i++) {
+        io.postRead(CLASS_IMAGE, 0x02);
+    }
+    size_t done = 0;
+    size_t flushed = 0;
+    start = millis();
+    while (done < 8 && millis() - start < 1000) {
+        flushed += camera.flushLog(sink, 2);
+        done += collect(io, events, 1, 1);
+    }
+    io.end();
+    camera.enableDebug(false);
+    flushed += camera.flushLog(sink);
+    check("log vaciado desde otra tarea mientras se llena", done == 8 && flushed >= 16);
+    CameraEvent result;
+    check("call() sin tarea -> CAMERA_ERR_NOT_INITIALIZED",
+          io.read(CLASS_IMAGE, 0x02, result) == CAMERA_ERR_NOT_INITIALIZED);
+    io.printStats(Serial);
+}
+
+void testScheduler() {
+    Serial.println("\n=== Prioridades ===");
+    simulator.setConfig(CameraSimConfig());
+    CameraTask io(camera);
+    CameraEvent events[4];
+
+    // Sin tarea y con el reloj virtual: orden por clase y envejecimiento
+    CameraVirtualClock clock;
+    cameraSetClock(&clock);
+    simulator.powerOn();
+    uint8_t palette = PALETTE_IRON;
+    io.postRead(CLASS_IMAGE, 0x03, CAMERA_PRIORITY_BACKGROUND);
+    io.postRead(CLASS_IMAGE, 0x02, CAMERA_PRIORITY_INTERACTIVE);
+    io.postWrite(CLASS_IMAGE, 0x20, &palette, 1, CAMERA_PRIORITY_URGENT);
+    io.service();
+    bool ordered = collect(io, events, 3, 100) == 3 && events[0].priority == CAMERA_PRIORITY_URGENT &&
+                   events[1].priority == CAMERA_PRIORITY_INTERACTIVE &&
+                   events[2].priority == CAMERA_PRIORITY_BACKGROUND && events[1].code == CAMERA_OK &&
+                   events[2].code == CAMERA_OK;
+    check("urgente -> interactiva -> fondo", ordered);
+
+    io.postRead(CLASS_IMAGE, 0x03, CAMERA_PRIORITY_BACKGROUND);
+    clock.advance(2 * CAMERA_AGING_MS * 1000UL + 1000);
+    io.postRead(CLASS_IMAGE, 0x02, CAMERA_PRIORITY_INTERACTIVE);
+    io.service();
+    check("fondo envejecido pasa delante",
+          collect(io, events, 2, 100) == 2 && events[0].priority == CAMERA_PRIORITY_BACKGROUND &&
+              events[0].code == CAMERA_OK);
+
+    // Tarea en su hilo con el reloj virtual mientras la aplicación lo avanza
+    check("begin() con reloj virtual", io.begin());
+    io.postRead(CLASS_IMAGE, 0x02);
+    clock.advance(1000);
+    bool virtualOk = collect(io, events, 1, 1000) == 1 && events[0].code == CAMERA_OK;
+    io.end();
+    check("lectura en la tarea con reloj virtual", virtualOk);
+    cameraSetClock(nullptr);
+    simulator.powerOn();
+
+    // Con tarea: una petición urgente abandona la espera de una lectura de fondo
+    CameraSimConfig config;
+    config.latencyUs = 30000;
+    simulator.setConfig(config);
+    io.resetStats();
+    check("begin() de la tarea", io.begin());
+    io.postRead(CLASS_IMAGE, 0x03, CAMERA_PRIORITY_BACKGROUND);
+    delay(5);
+    CameraRequest ffc = CameraTask::prepare(CLASS_CAMERA, 0x02, FLAG_WRITE);
+    io.postFromISR(ffc);
+    check("dos eventos", collect(io, events, 2, 1000) == 2);
+    check("lectura de fondo abandonada",
+          events[0].priority == CAMERA_PRIORITY_BACKGROUND && events[0].code == CAMERA_ERR_ABORTED);
+    check("urgente sin esperar a la lectura (< 5 ms)",
+          events[1].fromIsr && events[1].code == CAMERA_OK && events[1].startUs - events[1].postedUs < 5000);
+
+    // La respuesta tardía no se confunde con la siguiente lectura
+    io.postRead(CLASS_IMAGE, 0x02, CAMERA_PRIORITY_BACKGROUND);
+    check("lectura siguiente correcta", collect(io, events, 1, 1000) == 1 && events[0].code == CAMERA_OK &&
+                                        events[0].subcls == 0x02 && events[0].data[0] == 50);
+    io.end();
+    check("abandonos contados", io.stats().classes[CAMERA_PRIORITY_BACKGROUND].abandoned == 1);
+    io.printStats(Serial);
+    simulator.setConfig(CameraSimConfig());
+}
+
+/**
+ * Modo cooperativo: como en el loop de un ESP32-C3, sin tarea ni esperas.
+ */
+size_t pump(CameraTask& io, CameraEvent* events, size_t expected, uint32_t timeoutMs, uint32_t& slowestUs) {
+    size_t received = 0;
+    uint32_t start = millis();
+    while (received < expected && millis() - start < timeoutMs) {
+        uint32_t t0 = micros();
+        io.pollIo(500);
+        uint32_t us = micros() - t0;
+        if (us > slowestUs) {
+            slowestUs = us;
+        }
+        while (received < expected && io.poll(events[received])) {
+            received++;
+        }
+        delay(1);
+    }
+    return received;
+}
+
+void testCooperative() {
+    Serial.println("\n=== Modo cooperativo ===");
+    simulator.setConfig(CameraSimConfig());
+    simulator.powerOn();
+
+    CameraTask io(camera);
+    check("beginCooperative()", io.beginCooperative());
+    check("begin() rechazado en modo cooperativo", !io.begin());
+
+    uint32_t slowestUs = 0;
+    uint8_t brightness = 42;
+    CameraEvent events[CAMERA_QUEUE_DEPTH];
+    io.postWrite(CLASS_IMAGE, 0x02, &brightness, 1);
+    for (int i = 0; i < 4; i++) {
+        io.postRead(CLASS_IMAGE, 0x02);
+    }
+    bool all = pump(io, events, 5, 2000, slowestUs) == 5;
+    for (int i = 1; i < 5 && all; i++) {
+        all = events[i].code == CAMERA_OK && events[i].length == 1 && events[i].data[0] == 42;
+    }
+    check("escritura y 4 lecturas completadas", all);
+    check("pollIo() nunca espera a la cámara (< 5 ms)", slowestUs < 5000);
+
+    // call() desde otra tarea: la atiende pollIo() en el loop
+    CameraEvent result;
+    CameraErrorCode callCode = CAMERA_ERR_TIMEOUT;
+    std::atomic<bool> callDone(false);
+    std::thread caller([&]() {
+        callCode = io.read(CLASS_IMAGE, 0x02, result);
+        callDone = true;
+    });
+    uint32_t start = millis();
+    while (!callDone && millis() - start < 1000) {
+        io.pollIo();
+        delay(1);
+    }
+    caller.join();
+    check("call() atendida por pollIo()", callCode == CAMERA_OK && result.data[0] == 42);
+
+    // Una urgente abandona la lectura de fondo en vuelo sin bloquear el loop
+    CameraSimConfig config;
+    config.latencyUs = 30000;
+    simulator.setConfig(config);
+    camera.resetErrorCounts();
+    camera.resetCapture();
+    camera.enableCapture(true, true);
+    io.postRead(CLASS_IMAGE, 0x03, CAMERA_PRIORITY_BACKGROUND);
+    io.pollIo();
+    check("lectura de fondo en vuelo", io.poll(events[0]) == false && camera.responsePending());
+    uint8_t palette = PALETTE_IRON;
+    io.postWrite(CLASS_IMAGE, 0x20, &palette, 1, CAMERA_PRIORITY_URGENT);
+    check("dos eventos", pump(io, events, 2, 1000, slowestUs) == 2);
+    check("fondo abandonado, urgente enviada",
+          events[0].code == CAMERA_ERR_ABORTED && events[1].priority == CAMERA_PRIORITY_URGENT &&
+              events[1].code == CAMERA_OK);
+    check("ceder el turno no es un error ni congela la captura",
+          camera.getErrorCount(CAMERA_ERR_ABORTED) == 0 && !camera.getCapture().frozen());
+    camera.enableCapture(false);
+    io.postRead(CLASS_IMAGE, 0x20);
+    check("lectura siguiente correcta", pump(io, events, 1, 1000, slowestUs) == 1 && events[0].code == CAMERA_OK &&
+                                        events[0].data[0] == PALETTE_IRON);
+    simulator.setConfig(CameraSimConfig());
+
+    io.postRead(CLASS_IMAGE, 0x02);
+    io.pollIo();
+    io.end();
+    check("end() sale del modo cooperativo", !io.cooperative() && !camera.responsePending());
+    check("lectura en vuelo entregada como abandonada", io.poll(events[0]) && events[0].code == CAMERA_ERR_ABORTED);
+
+    // Lo urgente que quedó en cola al parar no cuenta en la sesión siguiente.
+    // Tras la espera vence la respuesta abandonada y la primera lectura sale.
+    delay(60);
+    io.beginCooperative();
+    uint32_t urgent[2] = {io.postRead(CLASS_IMAGE, 0x02, CAMERA_PRIORITY_URGENT),
+                          io.postRead(CLASS_IMAGE, 0x03, CAMERA_PRIORITY_URGENT)};
+    io.pollIo();
+    io.end();
+    size_t leftovers = 0;
+    while (leftovers < 2 && io.poll(events[leftovers])) {
+        leftovers++;
+    }
+    check("end() devuelve un evento por cada post() pendiente",
+          leftovers == 2 && !io.poll(events[2]) && events[0].id == urgent[0] &&
+              events[0].code == CAMERA_ERR_ABORTED && events[1].id == urgent[1] &&
+              events[1].code == CAMERA_ERR_NOT_INITIALIZED);
+    check("beginCooperative() de nuevo", io.beginCooperative());
+    uint32_t ids[2] = {io.postRead(CLASS_IMAGE, 0x02), io.postRead(CLASS_IMAGE, 0x03)};
+    bool clean = pump(io, events, 2, 1000, slowestUs) == 2;
+    for (int i = 0; i < 2 && clean; i++) {
+        clean = events[i].id == ids[i] && events[i].code == CAMERA_OK;
+    }
+    check("sesión nueva sin restos de la anterior ni abandonos", clean);
+    io.end();
+    io.printStats(Serial);
+    simulator.powerOn();
+}
+
+uint8_t groupBrightness[CAMERA_GROUP_MAX];
+
+void onGroupEvent(uint8_t index, const CameraEvent& event) {
+    if (event.code == CAMERA_OK && event.rw == FLAG_READ && event.cls == CLASS_IMAGE && event.subcls == 0x02) {
+        groupBrightness[index] = event.data[0];
+    }
+}
+
+void testGroup() {
+    Serial.println("\n=== Grupo de cámaras ===");
+    CameraSimConfig config;
+    config.latencyUs = 10000;
+    simulator.setConfig(config);
+    simulator.powerOn();
+
+    // Otras dos cámaras, cada una en su UART con su simulador
+    HardwareSerial serialB(3);
+    HardwareSerial serialC(4);
+    CameraController cameraB(&serialB, 18, 19);
+    CameraController cameraC(&serialC, 20, 21);
+    CameraSimulator simulatorB;
+    CameraSimulator simulatorC;
+    simulatorB.attach(serialB);
+    simulatorC.attach(serialC);
+    simulatorB.setConfig(config);
+    simulatorC.setConfig(config);
+    cameraB.setTimeouts(50, 2);
+    cameraC.setTimeouts(50, 2);
+    check("begin() de las cámaras B y C", cameraB.begin() && cameraC.begin());
+
+    CameraTask ioA(camera);
+    CameraTask ioB(cameraB);
+    CameraTask ioC(cameraC);
+
+    // Referencia: la misma lectura con una sola cámara
+    CameraGroup single;
+    single.add(ioB);
+    check("grupo de una cámara", single.begin());
+    single.broadcast(CLASS_IMAGE, 0x03, FLAG_READ);
+    check("lectura con una cámara", single.waitBroadcast() == CAMERA_OK);
+    uint32_t oneUs = single.stats().lastBatchUs;
+    single.end();
+
+    CameraGroup group;
+    group.add(ioA);
+    group.add(ioB);
+    group.add(ioC);
+    check("cuarta cámara rechazada solo si no cabe", CAMERA_GROUP_MAX > 3 || group.add(ioA) == -1);
+    group.setEventHandler(onGroupEvent);
+    check("begin() del grupo", group.begin());
+
+    group.broadcast(CLASS_IMAGE, 0x03, FLAG_READ);
+    check("lectura difundida a tres cámaras", group.waitBroadcast() == CAMERA_OK);
+    uint32_t threeUs = group.stats().lastBatchUs;
+    Serial.printf("  una cámara %lu us, tres cámaras %lu us\n", (unsigned long)oneUs, (unsigned long)threeUs);
+    check("tres cámaras en menos del doble que una", threeUs < 2 * oneUs);
+
+    // Preset y paleta a todas, y lectura de comprobación en el mismo lote
+    const CameraSetting preset[] = {{CLASS_IMAGE, 0x02, 60}, {CLASS_IMAGE, 0x03, 40}};
+    check("preset en el lote", group.applyAll(preset, 2) && group.setPaletteAll(PALETTE_IRON));
+    check("paleta fuera de rango rechazada", !group.setPaletteAll((ColorPalette)(PALETTE_COLOR7 + 1)));
+    group.broadcast(CLASS_IMAGE, 0x02, FLAG_READ);
+    check("preset aplicado", group.waitBroadcast() == CAMERA_OK);
+    check("brillo 60 en las tres", groupBrightness[0] == 60 && groupBrightness[1] == 60 && groupBrightness[2] == 60);
+
+    // Lote mayor que la cola de cada tarea: se reparte en varias vueltas
+    for (int i = 0; i < CAMERA_GROUP_BATCH; i++) {
+        group.broadcast(CLASS_IMAGE, 0x20, FLAG_READ);
+    }
+    check("lote lleno rechazado", !group.broadcast(CLASS_IMAGE, 0x20, FLAG_READ));
+    check("lote de 16 lecturas por cámara", group.waitBroadcast(2000) == CAMERA_OK);
+
+    // Un FFC urgente que interrumpe una lectura del lote: la lectura se repite
+    group.setFfcStagger(5);
+    group.ffcAll();
+    group.broadcast(CLASS_IMAGE, 0x02, FLAG_READ);
+    group.broadcast(CLASS_IMAGE, 0x03, FLAG_READ);
+    check("lote con FFC intercalados", group.waitBroadcast() == CAMERA_OK);
+    group.resetStats();
+
+    // FFC escalonado: nunca dos cámaras a la vez
+    group.setFfcStagger(30);
+    group.ffcAll();
+    uint32_t start = millis();
+    while (group.stats().ffcs < 3 && millis() - start < 1000) {
+        group.update();
+        delay(1);
+    }
+    check("tres FFC", group.stats().ffcs == 3);
+    check("FFC separados >= 30 ms", group.stats().minFfcGapUs >= 30000);
+    check("sin errores", group.stats().errors == 0);
+    group.printStats(Serial);
+    group.end();
+    check("end() detiene las tareas", !ioA.cooperative() && !ioB.cooperative() && !ioC.cooperative());
+    simulator.setConfig(CameraSimConfig());
+    simulator.powerOn();
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println("=== Thermal Camera Controller - Native ===");
+
+    simulator.attach(cameraSerial);
+    camera.setTimeouts(50, 2);
+    check("begin()", camera.begin());
+
+    testRegisters();
+    testFaults();
+    testVirtualClock();
+    testPty();
+    testTask();
+    testScheduler();
+    testCooperative();
+    testGroup();
+
+    const CameraSimCounters& c = simulator.counters();
+    Serial.printf("\nSimulador: %lu tramas, %lu lecturas, %lu escrituras, %lu respuestas, %lu ignoradas\n",
+                  (unsigned long)c.frames, (unsigned long)c.reads, (unsigned long)c.writes,
+                  (unsigned long)c.replies, (unsigned long)(c.rateLimited + c.initIgnored));
+    Serial.printf("%d comprobaciones fallidas\n", failures);
+    exit(failures == 0 ? 0 : 1);
+}
+
+void loop() {
+    camera.update();
+}
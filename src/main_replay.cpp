@@ -0,0 +1,228 @@
+/**
+ * Reproducción de sesiones UART grabadas (host)
+ *
+ * Este archivo reemplaza a main.cpp en el entorno native_replay. Carga una
+ * sesión capturada en campo (dumpCapture() guardado desde el monitor serie,
+ * o el binario de exportTo()), reenvía cada TX grabada con sendRawCommand()
+ * y contesta con los bytes RX grabados, comprobando que la TX que sale del
+ * controlador coincide con la grabada.
+ *
+ *   replay <sesión> [--fast] [--loops N] [--csv resultados.csv]
+ *       --fast   todo de golpe con reloj virtual (rendimiento del parser);
+ *                sin él, con los tiempos originales en tiempo real
+ *       --csv    un resultado por intercambio, para comparar dos builds
+ *   replay --record <sesión.bin|.txt> [ops]
+ *       graba una sesión contra el simulador (con fallos inyectados)
+ *
+ * Al final imprime una línea JSON con el resumen; termina con código 1 si
+ * alguna TX no coincide.
+ */
+
+#include <Arduino.h>
+#include "CameraController.h"
+#include "CameraClock.h"
+#include "CameraReplay.h"
+#include "CameraSimulator.h"
+#include "CameraSoak.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#error "main_replay.cpp solo compila en el entorno native"
+#endif
+
+#if !CAMERA_ENABLE_CAPTURE
+#error "La grabación necesita CAMERA_ENABLE_CAPTURE=1"
+#endif
+
+// Crear instancias
+HardwareSerial cameraSerial(2);
+CameraController camera(&cameraSerial, 16, 17);
+
+void usage() {
+    Serial.println("Uso: replay <sesión> [--fast] [--loops N] [--csv archivo]");
+    Serial.println("     replay --record <sesión.bin|.txt> [ops]");
+    exit(2);
+}
+
+/**
+ * Graba ops operaciones del soak contra el simulador con reloj virtual.
+ * @return Código de salida.
+ */
+int record(const char* path, uint32_t ops) {
+    CameraSimulator simulator;
+    CameraSimConfig simConfig;
+    simConfig.jitterUs = 3000;
+    simConfig.dropByteRate = 0.002f;
+    simConfig.corruptChecksumRate = 0.01f;
+    simConfig.ackWrites = true;
+    simulator.setConfig(simConfig);
+    simulator.attach(cameraSerial);
+
+    CameraVirtualClock clock;
+    cameraSetClock(&clock);
+    camera.begin();
+    camera.enableCapture(true, false);
+
+    CameraSoakConfig config;
+    config.ratePerSec = 20;
+    config.summaryIntervalMs = 0;
+    config.durationMs = ops * 50;
+    CameraSoak soak(camera, config);
+    for (;;) {
+        camera.update();
+        if (!soak.update(Serial)) {
+            break;
+        }
+        uint32_t idle = soak.msUntilNext();
+        cameraDelay(idle ? idle : 1);
+    }
+    cameraSetClock(nullptr);
+
+    const CameraCapture& capture = camera.getCapture();
+    if (capture.dropped()) {
+        Serial.printf("⚠️ %lu registros perdidos: aumentar CAMERA_CAPTURE_SIZE\n", (unsigned long)capture.dropped());
+    }
+    std::vector<uint8_t> buffer(capture.used());
+    size_t size = capture.exportTo(buffer.data(), buffer.size());
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        Serial.printf("❌ No se pudo crear %s\n", path);
+        return 1;
+    }
+    size_t len = strlen(path);
+    if (len > 4 && strcmp(path + len - 4, ".txt") == 0) {
+        // Mismo formato que dumpCapture()
+        CaptureRecord rec;
+        size_t offset = 0;
+        size_t used;
+        while ((used = captureDecodeRecord(buffer.data() + offset, size - offset, rec)) > 0) {
+            fprintf(file, "@%lu %s", (unsigned long)rec.timestamp, rec.direction == CAPTURE_RX ? "RX" : "TX");
+            for (size_t i = 0; i < rec.length; i++) {
+                fprintf(file, " %02X", rec.data[i]);
+            }
+            fprintf(file, "\n");
+            offset += used;
+        }
+    } else {
+        fwrite(buffer.data(), 1, size, file);
+    }
+    fclose(file);
+    Serial.printf("%lu registros (%u bytes) grabados en %s\n", (unsigned long)capture.records(), (unsigned)size, path);
+    return 0;
+}
+
+void writeCsv(const char* path, const std::vector<ReplayResult>& results) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        Serial.printf("❌ No se pudo crear %s\n", path);
+        return;
+    }
+    fprintf(file, "index,cls,subcls,rw,tx_match,result,latency_us\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const ReplayResult& r = results[i];
+        fprintf(file, "%u,0x%02X,0x%02X,%u,%d,%s,%lu\n", (unsigned)i, r.cls, r.subcls, r.rw, r.txMatched ? 1 : 0,
+                cameraErrorText(r.code), (unsigned long)r.latencyUs);
+    }
+    fclose(file);
+}
+
+int replay(const char* path, ReplayTiming timing, uint32_t loops, const char* csvPath) {
+    CameraReplay session;
+    if (!session.load(path)) {
+        Serial.printf("❌ No se pudo cargar %s (¿vacío o sin TX?)\n", path);
+        return 1;
+    }
+    Serial.printf("%s: %u bloques, %u intercambios, %.3f s grabados\n", path, (unsigned)session.chunkCount(),
+                  (unsigned)session.exchangeCount(), session.exchangeOffsetUs(session.exchangeCount() - 1) / 1e6);
+
+    session.attach(cameraSerial);
+    camera.begin();
+    camera.resetErrorCounts();
+
+    std::vector<ReplayResult> results;
+    uint32_t mismatched = 0;
+    unsigned long wallStart = micros();
+    size_t played = 0;
+    for (uint32_t loop = 0; loop < loops; loop++) {
+        results.clear();
+        played += session.run(camera, timing, &results);
+        mismatched += session.counters().txMismatched + session.counters().txUnexpected;
+        if (loop == 0) {
+            session.printFirstMismatch(Serial);
+        }
+    }
+    unsigned long wallUs = micros() - wallStart;
+
+    uint32_t byCode[CAMERA_ERR_COUNT] = {0};
+    CameraLatencyHistogram latency;
+    latency.reset();
+    for (size_t i = 0; i < results.size(); i++) {
+        byCode[results[i].code]++;
+        if (results[i].rw == FLAG_READ) {
+            latency.add(results[i].latencyUs);
+        }
+    }
+    if (csvPath) {
+        writeCsv(csvPath, results);
+    }
+
+    Serial.printf("{\"replay\":\"%s\",\"timing\":\"%s\",\"loops\":%lu,\"exchanges\":%lu,\"tx_mismatched\":%lu,"
+                  "\"wall_us\":%lu,\"exchanges_per_sec\":%.0f,\"read_p50_us\":%lu,\"read_p99_us\":%lu,\"results\":{",
+                  path, timing == REPLAY_FAST ? "fast" : "original", (unsigned long)loops, (unsigned long)played,
+                  (unsigned long)mismatched, wallUs, wallUs ? played * 1e6 / wallUs : 0.0,
+                  (unsigned long)latency.percentileUs(50), (unsigned long)latency.percentileUs(99));
+    bool first = true;
+    for (uint8_t code = 0; code < CAMERA_ERR_COUNT; code++) {
+        if (byCode[code]) {
+            Serial.printf("%s\"%s\":%lu", first ? "" : ",", cameraErrorText((CameraErrorCode)code),
+                          (unsigned long)byCode[code]);
+            first = false;
+        }
+    }
+    Serial.println("}}");
+    return mismatched ? 1 : 0;
+}
+
+void setup() {
+    Serial.begin(115200);
+
+    const char* session = nullptr;
+    const char* recordPath = nullptr;
+    const char* csvPath = nullptr;
+    uint32_t ops = 1000;
+    uint32_t loops = 1;
+    ReplayTiming timing = REPLAY_ORIGINAL;
+    for (int i = 1; i < hostArgc; i++) {
+        const char* arg = hostArgv[i];
+        if (strcmp(arg, "--fast") == 0) {
+            timing = REPLAY_FAST;
+        } else if (strcmp(arg, "--loops") == 0 && i + 1 < hostArgc) {
+            loops = strtoul(hostArgv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--csv") == 0 && i + 1 < hostArgc) {
+            csvPath = hostArgv[++i];
+        } else if (strcmp(arg, "--record") == 0 && i + 1 < hostArgc) {
+            recordPath = hostArgv[++i];
+            if (i + 1 < hostArgc && hostArgv[i + 1][0] != '-') {
+                ops = strtoul(hostArgv[++i], nullptr, 10);
+            }
+        } else if (arg[0] != '-' && !session) {
+            session = arg;
+        } else {
+            usage();
+        }
+    }
+
+    if (recordPath) {
+        exit(record(recordPath, ops));
+    }
+    if (!session || loops == 0) {
+        usage();
+    }
+    exit(replay(session, timing, loops, csvPath));
+}
+
+void loop() {
+}
@@ -0,0 +1,117 @@
+/**
+ * Prueba de resistencia (soak) del ThermalCameraController
+ *
+ * Este archivo reemplaza a main.cpp y lanza una mezcla aleatoria ponderada
+ * de lecturas, escrituras, movimientos de cursor y FFC a ritmo constante
+ * durante horas. Cada SOAK_SUMMARY_MS imprime latencias (p50/p95/p99/max)
+ * por tipo de operación, tasas de error y estado del heap.
+ *
+ * En el ESP32 (pio run -e soak -t upload -t monitor) va contra la cámara
+ * real conectada a GPIO16/17 y no termina salvo que se fije SOAK_DURATION_MS.
+ * En el host (pio run -e native_soak -t exec) va contra el simulador con
+ * reloj virtual y fallos inyectados: 24 h de protocolo en pocos segundos.
+ */
+
+#include <Arduino.h>
+#include "CameraController.h"
+#include "CameraClock.h"
+#include "CameraSoak.h"
+
+#ifndef ARDUINO
+#include "CameraSimulator.h"
+#if !CAMERA_INJECTABLE_CLOCK
+#error "El soak del host necesita CAMERA_INJECTABLE_CLOCK=1 (reloj virtual)"
+#endif
+#endif
+
+// Configuración de pines
+#define RX_PIN 16
+#define TX_PIN 17
+
+// Ritmo, duración e intervalo de resumen
+#ifndef SOAK_RATE
+#define SOAK_RATE 5.0f
+#endif
+#ifndef SOAK_DURATION_MS
+#ifdef ARDUINO
+#define SOAK_DURATION_MS 0UL
+#else
+#define SOAK_DURATION_MS (24UL * 3600UL * 1000UL)
+#endif
+#endif
+#ifndef SOAK_SUMMARY_MS
+#ifdef ARDUINO
+#define SOAK_SUMMARY_MS 60000UL
+#else
+#define SOAK_SUMMARY_MS (3600UL * 1000UL)
+#endif
+#endif
+#ifndef SOAK_SEED
+#define SOAK_SEED 1
+#endif
+
+// Crear instancias
+HardwareSerial cameraSerial(2);
+CameraController camera(&cameraSerial, RX_PIN, TX_PIN);
+CameraSoak* soak = nullptr;
+#ifndef ARDUINO
+CameraSimulator simulator;
+CameraVirtualClock virtualClock;
+#endif
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    Serial.println("=== Thermal Camera Controller - Soak ===");
+
+#ifndef ARDUINO
+    // Cámara algo ruidosa: latencia variable y pérdidas/corrupción ocasionales
+    CameraSimConfig simConfig;
+    simConfig.jitterUs = 3000;
+    simConfig.dropByteRate = 0.0005f;
+    simConfig.corruptChecksumRate = 0.001f;
+    simConfig.seed = SOAK_SEED;
+    simulator.setConfig(simConfig);
+    simulator.attach(cameraSerial);
+    cameraSetClock(&virtualClock);
+#endif
+
+    if (!camera.begin()) {
+        Serial.println("❌ Error al inicializar la cámara");
+    }
+
+    CameraSoakConfig config;
+    config.ratePerSec = SOAK_RATE;
+    config.summaryIntervalMs = SOAK_SUMMARY_MS;
+    config.durationMs = SOAK_DURATION_MS;
+    config.seed = SOAK_SEED;
+    static CameraSoak instance(camera, config);
+    soak = &instance;
+
+    Serial.printf("Mezcla read/write/cursor/ffc = %u/%u/%u/%u, %.1f ops/s, resumen cada %lu s\n",
+                  config.weights[SOAK_READ], config.weights[SOAK_WRITE], config.weights[SOAK_CURSOR],
+                  config.weights[SOAK_FFC], config.ratePerSec, (unsigned long)(config.summaryIntervalMs / 1000));
+    soak->begin();
+}
+
+void loop() {
+    camera.update();
+    if (!soak->update(Serial)) {
+#ifndef ARDUINO
+        const CameraSimCounters& c = simulator.counters();
+        Serial.printf("Simulador: %lu tramas, %lu respuestas, %lu bytes perdidos, %lu corruptas\n",
+                      (unsigned long)c.frames, (unsigned long)c.replies, (unsigned long)c.droppedBytes,
+                      (unsigned long)c.corrupted);
+        exit(0);
+#else
+        Serial.println("Soak terminado");
+        while (true) {
+            delay(1000);
+        }
+#endif
+    }
+    // Dormir hasta la siguiente operación (con reloj virtual no espera de verdad)
+    uint32_t idle = soak->msUntilNext();
+    cameraDelay(idle ? idle : 1);
+}
@@ -0,0 +1,133 @@
+/**
+ * Traza Chrome de una sesión contra el simulador (host)
+ *
+ * Este archivo reemplaza a main.cpp en el entorno native_trace
+ * (CAMERA_ENABLE_TRACE=1). Ejecuta comandos bloqueantes, peticiones a una
+ * CameraTask en su propio hilo (con un urgente que hace ceder a una lectura
+ * de fondo), las mismas en modo cooperativo y una entrada del menú, y
+ * escribe la traza en un fichero para abrirlo en chrome://tracing o
+ * ui.perfetto.dev:
+ *
+ *   trace [traza.json]        (por defecto camera_trace.json)
+ *
+ * Termina con código 1 si no se pudo escribir el fichero o algún comando falló.
+ */
+
+#include <Arduino.h>
+#include "CameraController.h"
+#include "CameraTask.h"
+#include "CameraText.h"
+#include "CameraTrace.h"
+#include "CameraSimulator.h"
+#include "MenuSystem.h"
+#include <stdio.h>
+
+#ifdef ARDUINO
+#error "main_trace.cpp solo compila en el entorno native"
+#endif
+
+#if !CAMERA_ENABLE_TRACE
+#error "Este entorno necesita CAMERA_ENABLE_TRACE=1"
+#endif
+
+// Crear instancias
+HardwareSerial cameraSerial(2);
+CameraController camera(&cameraSerial, 16, 17);
+CameraTask cameraIo(camera);
+MenuSystem menu(&camera);
+CameraSimulator simulator;
+
+/**
+ * Print sobre un fichero del host.
+ */
+class FilePrint : public Print {
+public:
+    explicit FilePrint(FILE* file) : _file(file) {}
+    size_t write(uint8_t c) override { return fputc(c, _file) == EOF ? 0 : 1; }
+    size_t write(const uint8_t* buffer, size_t size) override { return fwrite(buffer, 1, size, _file); }
+
+private:
+    FILE* _file;
+};
+
+uint8_t failures = 0;
+
+/**
+ * Recoge eventos de la tarea hasta tener count (o 1 s).
+ */
+void collect(size_t count, bool cooperative) {
+    CameraEvent event;
+    unsigned long start = millis();
+    while (count > 0 && millis() - start < 1000) {
+        if (cooperative) {
+            cameraIo.pollIo();
+        }
+        while (count > 0 && cameraIo.poll(event)) {
+            count--;
+            if (event.code != CAMERA_OK && event.code != CAMERA_ERR_ABORTED) {
+                Serial.printf("❌ %s: %s\n", cameraCommandName(event.cls, event.subcls), cameraErrorText(event.code));
+                failures++;
+            }
+        }
+        delay(1);
+    }
+    if (count > 0) {
+        Serial.printf("❌ faltan %u eventos\n", (unsigned)count);
+        failures++;
+    }
+}
+
+/**
+ * Lectura de fondo, escritura y un FFC urgente que la hace ceder.
+ */
+void postSession() {
+    uint8_t brightness = 60;
+    cameraIo.postRead(CLASS_IMAGE, 0x03, CAMERA_PRIORITY_BACKGROUND);
+    cameraIo.postWrite(CLASS_IMAGE, 0x02, &brightness, 1);
+    cameraIo.postWrite(CLASS_CAMERA, 0x02, nullptr, 0, CAMERA_PRIORITY_URGENT);
+    cameraIo.postRead(CLASS_IMAGE, 0x02);
+}
+
+void setup() {
+    Serial.begin(115200);
+    const char* path = hostArgc > 1 ? hostArgv[1] : "camera_trace.json";
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        Serial.printf("❌ No se pudo crear %s\n", path);
+        exit(1);
+    }
+    FilePrint out(file);
+
+    simulator.attach(cameraSerial);
+    camera.begin();
+    CameraTrace::begin(&out);
+
+    // Bloqueante, en este hilo
+    CameraInfo info;
+    if (!camera.setPalette(PALETTE_IRON) || !camera.getDeviceInfo(info)) {
+        failures++;
+    }
+
+    // Tarea en su propio hilo: los spans b/e llevan el id de cada post()
+    cameraIo.begin();
+    postSession();
+    collect(4, false);
+    cameraIo.end();
+
+    // Cooperativo: la espera termina en otra llamada a pollIo()
+    cameraIo.beginCooperative();
+    postSession();
+    collect(4, true);
+    cameraIo.end();
+
+    // El detalle del menú es lo que se tecleó: comillas y barras se escapan
+    menu.processInput("\"9\\x\"");
+
+    CameraTrace::end();
+    fclose(file);
+    Serial.printf("Traza en %s (%s)\n", path, failures ? "con errores" : "sin errores");
+    exit(failures == 0 ? 0 : 1);
+}
+
+void loop() {
+}